@@ -3,6 +3,8 @@
 #include "CoffeeEngine/Core/SystemInfo.h"
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Timer.h"
+#include "CoffeeEngine/Physics/PhysicsEngine.h"
+#include "CoffeeEngine/Physics/PhysicsTelemetry.h"
 #include <cstdint>
 #include <imgui.h>
 #include <string>
@@ -19,6 +21,11 @@ namespace Coffee {
         FrameTime = Application::Get().GetFrameTime();
         MemoryUsage = SystemInfo::GetProcessMemoryUsage();
 
+        static PhysicsTickStats PhysicsTicks[PhysicsTelemetry::TickCapacity];
+        static size_t PhysicsTickCount = 0;
+        PhysicsTickCount = PhysicsTelemetry::ReadTicks(PhysicsTicks);
+        const PhysicsTickStats LastTick = PhysicsTickCount > 0 ? PhysicsTicks[PhysicsTickCount - 1] : PhysicsTickStats{};
+
 
         ImGui::Begin("Monitor");
 
@@ -72,6 +79,64 @@ namespace Coffee {
             ImGui::EndTable();
             ImGui::TreePop();
         }
+        // Physics, the body counters are only gathered while they are shown
+        const bool physicsOpen = ImGui::TreeNode("Physics");
+        PhysicsTelemetry::SetBodyCounting(physicsOpen);
+        if(physicsOpen) {
+            ImGui::BeginTable("PhysicsTable", 2, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersOuterV | ImGuiTableFlags_RowBg);
+            ImGui::TableSetupColumn("PhysicsColumn1", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("PhysicsColumn2", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Checkbox("Step Time", &m_ShowPhysicsStep);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", LastTick.StepTimeMs);
+
+            auto counterRow = [](const char* name, uint32_t value) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", value);
+            };
+            counterRow("Active Bodies", LastTick.ActiveBodies);
+            counterRow("Sleeping Bodies", LastTick.SleepingBodies);
+            counterRow("Manifolds", LastTick.Manifolds);
+            counterRow("Contacts", LastTick.Contacts);
+            counterRow("Solver Iterations", LastTick.SolverIterations);
+
+            // Phase wall times of the last update, to tell a solver spike from a broadphase one
+            const PhysicsStats& physicsStats = PhysicsEngine::GetStats();
+            for (size_t i = 0; i < PhysicsPhaseCount; ++i)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", GetPhysicsPhaseName(static_cast<PhysicsPhase>(i)));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f us (wall)", physicsStats.PhaseMicroseconds[i]);
+            }
+            counterRow("Ticks", physicsStats.Ticks);
+            counterRow("Islands", physicsStats.Islands);
+            counterRow("Largest Island", physicsStats.IslandBodyCounts.empty() ? 0 : physicsStats.IslandBodyCounts.front());
+            ImGui::EndTable();
+
+            // Per-body trace, sampled by the physics step only while an entity is set
+            ImGui::InputInt("Trace Entity", &m_TracedEntity);
+            if (ImGui::Button(PhysicsTelemetry::GetTracedEntity() == entt::null ? "Start Trace" : "Stop Trace"))
+            {
+                const bool tracing = PhysicsTelemetry::GetTracedEntity() != entt::null;
+                PhysicsTelemetry::TraceBody(tracing || m_TracedEntity < 0 ? entt::null : static_cast<entt::entity>(m_TracedEntity));
+            }
+
+            PhysicsBodySample sample;
+            if (PhysicsTelemetry::GetTracedEntity() != entt::null && PhysicsTelemetry::ReadBodySamples({&sample, 1}) > 0)
+            {
+                ImGui::Text("Tick %llu%s", static_cast<unsigned long long>(sample.Tick), sample.Active ? "" : " (sleeping)");
+                ImGui::Text("Position (%.2f, %.2f, %.2f)", sample.Position.x, sample.Position.y, sample.Position.z);
+                ImGui::Text("Velocity (%.2f, %.2f, %.2f)", sample.LinearVelocity.x, sample.LinearVelocity.y, sample.LinearVelocity.z);
+            }
+            ImGui::TreePop();
+        }
         ImGui::EndChild();
 
         ImGui::NextColumn();
@@ -123,6 +188,15 @@ namespace Coffee {
                 return mu;
             }, &memoryUsage, memoryUsage.size(), 0, MemoryUsageOverlay.c_str(), yMin, yMax, ImVec2(0, 80)); // Minimum height of 80
         }
+
+        if (m_ShowPhysicsStep)
+        {
+            ImGui::Text("Physics Step");
+            std::string PhysicsStepOverlay = "Physics Step: " + std::to_string(LastTick.StepTimeMs) + " ms";
+            ImGui::PlotLines("##PhysicsStep", [](void* data, int idx) -> float {
+                return ((PhysicsTickStats*)data)[idx].StepTimeMs;
+            }, PhysicsTicks, (int)PhysicsTickCount, 0, PhysicsStepOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80)); // Minimum height of 80
+        }
         ImGui::EndChild();
 
         ImGui::End();
@@ -12,5 +12,7 @@ namespace Coffee {
         bool m_ShowFPS = true;
         bool m_ShowFrameTime = true;
         bool m_MemoryUsage = true;
+        bool m_ShowPhysicsStep = true;
+        int m_TracedEntity = -1;
     };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Log.h"
 #include <cstdlib>
+#include <deque>
 #include <imgui.h>
 #include <spdlog/spdlog.h>
 #include <string>
@@ -14,7 +15,7 @@ namespace Coffee {
         if (!m_Visible) return;
 
         ImGui::Begin("Output", nullptr, ImGuiWindowFlags_HorizontalScrollbar);
-        const std::vector<std::string>& logBuffer = Coffee::Log::GetLogBuffer();
+        const std::deque<std::string>& logBuffer = Coffee::Log::GetLogBuffer();
         /* for (const auto& log : logBuffer)
         {
             auto [before_level, level_str, after_level] = ParseLogMessage(log);
@@ -20,6 +20,7 @@
 #include <IconsLucide.h>
 
 #include <CoffeeEngine/Scripting/Script.h>
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
@@ -31,6 +32,41 @@
 namespace Coffee
 {
 
+    /**
+     * @brief Draws a combo picking one of the collision layers named in the project's physics settings.
+     * @param layer Layer to edit, shown clamped to the valid layers.
+     * @return Whether a layer was picked.
+     */
+    static bool DrawCollisionLayerCombo(int& layer)
+    {
+        if (!Project::GetActive())
+            return false;
+
+        const PhysicsSettings& physicsSettings = Project::GetPhysicsSettings();
+        const int current = std::clamp(layer, 0, PhysicsSettings::MaxCollisionLayers - 1);
+        const std::string& layerName = physicsSettings.CollisionLayerNames[current];
+        std::string preview = layerName.empty() ? "Layer " + std::to_string(current) : layerName;
+
+        bool changed = false;
+        if (ImGui::BeginCombo("Collision Layer", preview.c_str()))
+        {
+            for (int i = 0; i < PhysicsSettings::MaxCollisionLayers; ++i)
+            {
+                const std::string& name = physicsSettings.CollisionLayerNames[i];
+                if (name.empty())
+                    continue;
+
+                if (ImGui::Selectable(name.c_str(), i == current))
+                {
+                    layer = i;
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        return changed;
+    }
+
     SceneTreePanel::SceneTreePanel(const Ref<Scene>& scene)
     {
         m_Context = scene;
@@ -445,6 +481,8 @@ namespace Coffee
                     {
                     case ImageFormat::R8:
                         return "R8";
+                    case ImageFormat::R16:
+                        return "R16";
                     case ImageFormat::RGB8:
                         return "RGB8";
                     case ImageFormat::RGBA8:
@@ -698,6 +736,11 @@ namespace Coffee
                     }
                 }
 
+                // Collision layer, named in the project's physics settings
+                int layer = rigidbodyComponent.cfg.shapeConfig.layer;
+                if (DrawCollisionLayerCombo(layer))
+                    rigidbodyComponent.SetCollisionLayer(layer);
+
                 // Use Gravity checkbox (only for Dynamic)
                 if (rigidbodyComponent.cfg.type == RigidBodyType::Dynamic && !rigidbodyComponent.cfg.FreezeY)
                 {
@@ -904,13 +947,21 @@ namespace Coffee
             ImGui::PushID("Collider"); // Unique ID
              if (ImGui::CollapsingHeader("Collider", &isCollapsingHeaderOpen, ImGuiTreeNodeFlags_DefaultOpen))
             {
-                const char* colliderTypes[] = {"Box", "Sphere", "Capsule", "Cylinder"};
+                const char* colliderTypes[] = {"Box", "Sphere", "Capsule", "Cylinder", "Convex Hull"};
                 int currentShape = static_cast<int>(collider.Shape);
 
                 // Selección del tipo de collider
                 if (ImGui::Combo("Shape", &currentShape, colliderTypes, IM_ARRAYSIZE(colliderTypes)))
                 {
                     collider.Shape = static_cast<ColliderShape>(currentShape);
+
+                    // Hulls are cooked from the entity mesh, the collider is rebuilt to pick them up
+                    if (collider.Shape == ColliderShape::ConvexHull)
+                    {
+                        if (entity.HasComponent<MeshComponent>())
+                            collider.HullMesh = entity.GetComponent<MeshComponent>().GetMesh();
+                        collider.UpdateCollider(entity.GetComponent<TransformComponent>());
+                    }
                 }
 
                 glm::vec3 offset = collider.Offset;
@@ -939,6 +990,14 @@ namespace Coffee
                     ImGui::Text("Height");
                     ImGui::DragFloat("##CapsuleCylinderHeight", &collider.Height, 0.1f, 0.0f, 100.0f);
                     break;
+
+                case ColliderShape::ConvexHull:
+                    ImGui::Text("Mesh");
+                    if (collider.HullMesh)
+                        ImGui::Text("%s", collider.HullMesh->GetName().c_str());
+                    else
+                        ImGui::TextDisabled("Add a Mesh Component and pick Convex Hull again");
+                    break;
                 }
             
                 ImGui::Text("Position");
@@ -946,6 +1005,11 @@ namespace Coffee
 
                 ImGui::Checkbox("Is Trigger", &collider.IsTrigger);
 
+                // Collision layer, named in the project's physics settings
+                int layer = collider.CollisionLayer;
+                if (DrawCollisionLayerCombo(layer))
+                    collider.SetCollisionLayer(layer);
+
                 
                 
                 
@@ -1096,16 +1160,18 @@ namespace Coffee
             ImGui::PushID("MeshCollider"); // Unic ID
             if (ImGui::CollapsingHeader("Mesh Collider", &isCollapsingHeaderOpen, ImGuiTreeNodeFlags_DefaultOpen))
             {
+                bool changed = false;
+
                 // size
                 ImGui::Text("Size");
-                ImGui::DragFloat3("##MeshSize", glm::value_ptr(meshCollider.Size), 0.1f, 0.0f, 100.0f);
+                changed |= ImGui::DragFloat3("##MeshSize", glm::value_ptr(meshCollider.Size), 0.1f, 0.0f, 100.0f);
 
                 // offset
                 ImGui::Text("Offset");
-                ImGui::DragFloat3("##MeshOffset", glm::value_ptr(meshCollider.Offset), 0.1f);
+                changed |= ImGui::DragFloat3("##MeshOffset", glm::value_ptr(meshCollider.Offset), 0.1f);
 
                 // is trigger
-                ImGui::Checkbox("Is Trigger", &meshCollider.IsTrigger);
+                changed |= ImGui::Checkbox("Is Trigger", &meshCollider.IsTrigger);
 
                 // provides contacts
                 ImGui::Checkbox("Provides Contacts", &meshCollider.ProvidesContacts);
@@ -1118,9 +1184,16 @@ namespace Coffee
                 ImGui::Text("Material");
                 ImGui::Combo("Material", &meshCollider.MaterialIndex, "None\0Physic Material\0\0");
 
-                // mesh
+                // mesh, taken from the Mesh Component of the entity
                 ImGui::Text("Mesh");
-                ImGui::Combo("Mesh", &meshCollider.MeshIndex, "None\0Mesh1\0Mesh2\0\0");
+                if (entity.HasComponent<MeshComponent>() && entity.GetComponent<MeshComponent>().GetMesh())
+                    ImGui::Text("%s", entity.GetComponent<MeshComponent>().GetMesh()->GetName().c_str());
+                else
+                    ImGui::TextDisabled("Add a Mesh Component to collide against its triangles");
+
+                // Rebuilding is cheap, the triangle BVH stays cached for the mesh
+                if (changed)
+                    meshCollider.m_Collider = nullptr;
 
                 // Layer Overrides
                 if (ImGui::TreeNode("Layer Overrides"))
@@ -1137,6 +1210,201 @@ namespace Coffee
             ImGui::PopID(); // end Unic ID
         }
 
+        if (entity.HasComponent<VehicleComponent>())
+        {
+            auto& vehicleComponent = entity.GetComponent<VehicleComponent>();
+            VehicleConfig& cfg = vehicleComponent.cfg;
+            bool isCollapsingHeaderOpen = true;
+
+            ImGui::PushID("Vehicle"); // Unic ID
+            if (ImGui::CollapsingHeader("Vehicle", &isCollapsingHeaderOpen, ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                bool changed = false;
+
+                if (!entity.HasComponent<RigidbodyComponent>())
+                    ImGui::TextDisabled("Add a dynamic Rigidbody Component to use as the chassis");
+
+                // Suspension
+                ImGui::Text("Suspension");
+                changed |= ImGui::DragFloat("Rest Length", &cfg.SuspensionRestLength, 0.01f, 0.0f, 10.0f);
+                changed |= ImGui::DragFloat("Stiffness", &cfg.SuspensionStiffness, 0.1f, 0.0f, 1000.0f);
+                changed |= ImGui::DragFloat("Compression", &cfg.SuspensionCompression, 0.01f, 0.0f, 100.0f);
+                changed |= ImGui::DragFloat("Relaxation", &cfg.SuspensionRelaxation, 0.01f, 0.0f, 100.0f);
+                changed |= ImGui::DragFloat("Max Travel", &cfg.MaxSuspensionTravel, 0.01f, 0.0f, 10.0f);
+                changed |= ImGui::DragFloat("Max Force", &cfg.MaxSuspensionForce, 10.0f, 0.0f, 1000000.0f);
+
+                // Tyres
+                ImGui::Text("Tyres");
+                changed |= ImGui::DragFloat("Friction Slip", &cfg.FrictionSlip, 0.1f, 0.0f, 100.0f);
+                changed |= ImGui::DragFloat("Roll Influence", &cfg.RollInfluence, 0.01f, 0.0f, 1.0f);
+
+                // Drive
+                ImGui::Text("Drive");
+                changed |= ImGui::DragFloat("Max Engine Force", &cfg.MaxEngineForce, 10.0f, 0.0f, 1000000.0f);
+                changed |= ImGui::DragFloat("Max Brake Force", &cfg.MaxBrakeForce, 1.0f, 0.0f, 100000.0f);
+                changed |= ImGui::DragFloat("Max Steering Angle", &cfg.MaxSteeringAngle, 0.5f, 0.0f, 89.0f);
+
+                // Wheels
+                if (ImGui::TreeNode("Wheels"))
+                {
+                    for (size_t i = 0; i < cfg.Wheels.size(); ++i)
+                    {
+                        WheelConfig& wheel = cfg.Wheels[i];
+                        ImGui::PushID(static_cast<int>(i));
+                        ImGui::Text("Wheel %zu", i);
+                        changed |= ImGui::DragFloat3("Connection Point", glm::value_ptr(wheel.ConnectionPoint), 0.01f);
+                        changed |= ImGui::DragFloat("Radius", &wheel.Radius, 0.01f, 0.01f, 10.0f);
+                        changed |= ImGui::Checkbox("Steered", &wheel.Steered);
+                        ImGui::SameLine();
+                        changed |= ImGui::Checkbox("Driven", &wheel.Driven);
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton("Remove"))
+                        {
+                            cfg.Wheels.erase(cfg.Wheels.begin() + i);
+                            changed = true;
+                            ImGui::PopID();
+                            break;
+                        }
+                        ImGui::PopID();
+                    }
+                    if (ImGui::Button("Add Wheel"))
+                    {
+                        cfg.Wheels.emplace_back();
+                        changed = true;
+                    }
+                    ImGui::TreePop();
+                }
+
+                // The scene rebuilds the vehicle from the new settings on its next update
+                if (changed)
+                    vehicleComponent.m_Vehicle = nullptr;
+            }
+
+            if (!isCollapsingHeaderOpen)
+            {
+                entity.RemoveComponent<VehicleComponent>();
+            }
+            ImGui::PopID(); // end Unic ID
+        }
+
+        if (entity.HasComponent<CharacterControllerComponent>())
+        {
+            auto& characterComponent = entity.GetComponent<CharacterControllerComponent>();
+            CharacterControllerConfig& cfg = characterComponent.cfg;
+            bool isCollapsingHeaderOpen = true;
+
+            ImGui::PushID("CharacterController"); // Unic ID
+            if (ImGui::CollapsingHeader("Character Controller", &isCollapsingHeaderOpen,
+                                        ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                bool changed = false;
+
+                // Capsule
+                changed |= ImGui::DragFloat("Radius", &cfg.Radius, 0.01f, 0.01f, 10.0f);
+                changed |= ImGui::DragFloat("Height", &cfg.Height, 0.01f, 0.02f, 20.0f);
+
+                // Movement limits
+                changed |= ImGui::DragFloat("Step Height", &cfg.StepHeight, 0.01f, 0.0f, 5.0f);
+                changed |= ImGui::DragFloat("Max Slope Angle", &cfg.MaxSlopeAngle, 0.5f, 0.0f, 90.0f);
+                changed |= ImGui::DragFloat("Snap Distance", &cfg.SnapDistance, 0.01f, 0.0f, 5.0f);
+                changed |= ImGui::DragFloat("Max Speed", &cfg.MaxSpeed, 0.1f, 0.0f, 100.0f);
+                changed |= ImGui::DragFloat("Max Fall Speed", &cfg.MaxFallSpeed, 0.1f, 0.0f, 200.0f);
+                ImGui::DragFloat("Jump Speed", &characterComponent.JumpSpeed, 0.1f, 0.0f, 100.0f);
+
+                // Collision layer, named in the project's physics settings
+                changed |= DrawCollisionLayerCombo(cfg.CollisionLayer);
+
+                // Queries of the last step, only while playing
+                if (characterComponent.m_Controller)
+                {
+                    const CharacterQueryStats& stats = characterComponent.m_Controller->GetQueryStats();
+                    ImGui::Text("Grounded: %s", characterComponent.m_Controller->IsGrounded() ? "yes" : "no");
+                    ImGui::Text("Candidates: %u  Sweeps: %u  Contact Tests: %u", stats.Candidates, stats.Sweeps,
+                                stats.ContactTests);
+                }
+
+                // The scene rebuilds the character from the new settings on its next update
+                if (changed)
+                    characterComponent.m_Controller = nullptr;
+            }
+
+            if (!isCollapsingHeaderOpen)
+            {
+                entity.RemoveComponent<CharacterControllerComponent>();
+            }
+            ImGui::PopID(); // end Unic ID
+        }
+
+        if (entity.HasComponent<TerrainComponent>())
+        {
+            auto& terrainComponent = entity.GetComponent<TerrainComponent>();
+            TerrainConfig& cfg = terrainComponent.cfg;
+            bool isCollapsingHeaderOpen = true;
+
+            ImGui::PushID("Terrain"); // Unic ID
+            if (ImGui::CollapsingHeader("Terrain", &isCollapsingHeaderOpen, ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                // Heightmap, dropped from the content browser
+                const Ref<Texture2D>& heightmap = terrainComponent.Heightmap;
+                ImGui::ImageButton("##Heightmap", (ImTextureID)(heightmap ? heightmap->GetID() : 0), {64, 64});
+                if (ImGui::BeginDragDropTarget())
+                {
+                    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("RESOURCE"))
+                    {
+                        const Ref<Resource>& resource = *(Ref<Resource>*)payload->Data;
+                        if (resource->GetType() == ResourceType::Texture2D)
+                            terrainComponent.Heightmap = std::static_pointer_cast<Texture2D>(resource);
+                    }
+                    ImGui::EndDragDropTarget();
+                }
+                ImGui::SameLine();
+                ImGui::Text("%s", heightmap ? heightmap->GetName().c_str() : "Drop a heightmap");
+
+                // Size and streaming, the scene rebuilds the chunks when these change
+                ImGui::DragFloat("Spacing", &cfg.Spacing, 0.01f, 0.01f, 100.0f);
+                ImGui::DragFloat("Height Scale", &cfg.HeightScale, 0.1f, 0.0f, 10000.0f);
+                ImGui::DragInt("Chunk Quads", &cfg.ChunkQuads, 1.0f, 8, 512);
+                ImGui::DragFloat("Stream Radius", &cfg.StreamRadius, 1.0f, 1.0f, 10000.0f);
+                ImGui::DragInt("Chunk Loads Per Update", &cfg.ChunkLoadsPerUpdate, 1.0f, 1, 256);
+                ImGui::DragFloat("Friction", &cfg.Friction, 0.01f, 0.0f, 2.0f);
+
+                // Collision layer, named in the project's physics settings
+                DrawCollisionLayerCombo(cfg.CollisionLayer);
+
+                if (terrainComponent.m_Terrain)
+                {
+                    const TerrainStats& stats = terrainComponent.m_Terrain->GetStats();
+                    ImGui::Text("Chunks: %d / %d  Memory: %.1f MB", stats.LoadedChunks, stats.TotalChunks,
+                                stats.ChunkBytes / (1024.0f * 1024.0f));
+                }
+            }
+
+            if (!isCollapsingHeaderOpen)
+            {
+                entity.RemoveComponent<TerrainComponent>();
+            }
+            ImGui::PopID(); // end Unic ID
+        }
+
+        if (entity.HasComponent<PhysicsLodAnchorComponent>())
+        {
+            auto& anchorComponent = entity.GetComponent<PhysicsLodAnchorComponent>();
+            bool isCollapsingHeaderOpen = true;
+
+            ImGui::PushID("PhysicsLodAnchor"); // Unic ID
+            if (ImGui::CollapsingHeader("Physics LOD Anchor", &isCollapsingHeaderOpen, ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                // Scales the LOD rings of the physics settings around this entity
+                ImGui::DragFloat("Radius Scale", &anchorComponent.RadiusScale, 0.01f, 0.0f, 100.0f);
+            }
+
+            if (!isCollapsingHeaderOpen)
+            {
+                entity.RemoveComponent<PhysicsLodAnchorComponent>();
+            }
+            ImGui::PopID(); // end Unic ID
+        }
+
         // Joint
         if (entity.HasComponent<FixedJointComponent>())
         {
@@ -1506,6 +1774,11 @@ namespace Coffee
                 "Lua Script Component",
                 "Rigidbody Component",
                 "Collider Component",
+                "Mesh Collider Component",
+                "Vehicle Component",
+                "Character Controller Component",
+                "Terrain Component",
+                "Physics LOD Anchor Component",
                 "Distance2DJoint Component",
                 "FixedJoint Component",
                 "SpringJoint Component",
@@ -1603,6 +1876,40 @@ namespace Coffee
                     }
                     ImGui::CloseCurrentPopup();
                 }
+                else if (items[item_current] == "Mesh Collider Component")
+                {
+                    // The scene builds the collider from the entity mesh on its next update
+                    if (!entity.HasComponent<MeshColliderComponent>())
+                        entity.AddComponent<MeshColliderComponent>();
+                    ImGui::CloseCurrentPopup();
+                }
+                else if (items[item_current] == "Vehicle Component")
+                {
+                    // The scene puts the vehicle on the entity rigidbody on its next update
+                    if (!entity.HasComponent<VehicleComponent>())
+                        entity.AddComponent<VehicleComponent>();
+                    ImGui::CloseCurrentPopup();
+                }
+                else if (items[item_current] == "Character Controller Component")
+                {
+                    // The scene creates the capsule at the entity position on its next update
+                    if (!entity.HasComponent<CharacterControllerComponent>())
+                        entity.AddComponent<CharacterControllerComponent>();
+                    ImGui::CloseCurrentPopup();
+                }
+                else if (items[item_current] == "Terrain Component")
+                {
+                    // The scene builds the chunks around the camera once a heightmap is set
+                    if (!entity.HasComponent<TerrainComponent>())
+                        entity.AddComponent<TerrainComponent>();
+                    ImGui::CloseCurrentPopup();
+                }
+                else if (items[item_current] == "Physics LOD Anchor Component")
+                {
+                    if (!entity.HasComponent<PhysicsLodAnchorComponent>())
+                        entity.AddComponent<PhysicsLodAnchorComponent>();
+                    ImGui::CloseCurrentPopup();
+                }
                 else if (items[item_current] == "Distance2DJoint Component")
                 {
                     if (!entity.HasComponent<DistanceJoint2DComponent>())
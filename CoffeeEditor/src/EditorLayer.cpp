@@ -33,6 +33,8 @@
 #include <imgui.h>
 #include <string>
 #include <sys/types.h>
+#include <cstring>
+#include <thread>
 #include <tracy/Tracy.hpp>
 
 #include <IconsLucide.h>
@@ -267,6 +269,151 @@ namespace Coffee {
                     PhysicsEngine::SetGravity(PhysicsEngine::GlobalGravity);
                 }
 
+                if (Project::GetActive())
+                {
+                    PhysicsSettings& physicsSettings = Project::GetPhysicsSettings();
+
+                    ImGui::Separator();
+
+                    const char* physicsTypes[] = {"Basic", "Discrete", "Parallel", "Continuous"};
+                    int currentType = static_cast<int>(physicsSettings.Type);
+                    if (ImGui::Combo("Physics Type", &currentType, physicsTypes, IM_ARRAYSIZE(physicsTypes)))
+                    {
+                        physicsSettings.Type = static_cast<PhysicsType>(currentType);
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (ImGui::SliderInt("Tick Rate", &physicsSettings.TickRate, 10, 240, "%d Hz"))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (ImGui::SliderInt("Max Substeps", &physicsSettings.MaxSubSteps, 1, 16))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (ImGui::Checkbox("Async Step", &physicsSettings.AsyncStep))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (physicsSettings.Type == PhysicsType::PARALLEL)
+                    {
+                        if (ImGui::SliderInt("Worker Threads", &physicsSettings.WorkerThreads, 0,
+                                             static_cast<int>(std::thread::hardware_concurrency()), physicsSettings.WorkerThreads == 0 ? "Auto" : "%d"))
+                        {
+                            PhysicsEngine::ApplySettings(physicsSettings);
+                        }
+                    }
+
+                    if (ImGui::Checkbox("Simulation LOD", &physicsSettings.LodEnabled))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (physicsSettings.LodEnabled)
+                    {
+                        bool radiiChanged = false;
+                        radiiChanged |= ImGui::DragFloat("Full Rate Radius", &physicsSettings.LodFullRateRadius, 1.0f, 1.0f, physicsSettings.LodHalfRateRadius, "%.0f m");
+                        radiiChanged |= ImGui::DragFloat("Half Rate Radius", &physicsSettings.LodHalfRateRadius, 1.0f, physicsSettings.LodFullRateRadius, physicsSettings.LodQuarterRateRadius, "%.0f m");
+                        radiiChanged |= ImGui::DragFloat("Quarter Rate Radius", &physicsSettings.LodQuarterRateRadius, 1.0f, physicsSettings.LodHalfRateRadius, 10000.0f, "%.0f m");
+                        if (radiiChanged)
+                        {
+                            PhysicsEngine::ApplySettings(physicsSettings);
+                        }
+                    }
+
+                    // Takes effect the next time the scene is played
+                    if (ImGui::Checkbox("Bake Static Colliders", &physicsSettings.StaticBakeEnabled))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (physicsSettings.StaticBakeEnabled)
+                    {
+                        if (ImGui::DragFloat("Bake Cell Size", &physicsSettings.StaticBakeCellSize, 1.0f, 1.0f, 1000.0f, "%.0f m"))
+                        {
+                            PhysicsEngine::ApplySettings(physicsSettings);
+                        }
+                    }
+
+                    if (ImGui::Checkbox("Debug Draw", &physicsSettings.DebugDrawEnabled))
+                    {
+                        PhysicsEngine::ApplySettings(physicsSettings);
+                    }
+
+                    if (physicsSettings.DebugDrawEnabled)
+                    {
+                        bool categoriesChanged = false;
+                        categoriesChanged |= ImGui::Checkbox("Draw Shapes", &physicsSettings.DebugDrawShapes);
+                        categoriesChanged |= ImGui::Checkbox("Draw AABBs", &physicsSettings.DebugDrawAabbs);
+                        categoriesChanged |= ImGui::Checkbox("Draw Contacts", &physicsSettings.DebugDrawContacts);
+                        categoriesChanged |= ImGui::Checkbox("Draw Constraints", &physicsSettings.DebugDrawConstraints);
+                        if (categoriesChanged)
+                        {
+                            PhysicsEngine::ApplySettings(physicsSettings);
+                        }
+                    }
+
+                    if (ImGui::BeginMenu("Collision Layers"))
+                    {
+                        // Named layers, unnamed ones are hidden from the matrix and the inspector
+                        for (int i = 0; i < PhysicsSettings::MaxCollisionLayers; ++i)
+                        {
+                            char name[64];
+                            std::strncpy(name, physicsSettings.CollisionLayerNames[i].c_str(), sizeof(name) - 1);
+                            name[sizeof(name) - 1] = '\0';
+
+                            ImGui::PushID(i);
+                            if (ImGui::InputText(("Layer " + std::to_string(i)).c_str(), name, sizeof(name)))
+                                physicsSettings.CollisionLayerNames[i] = name;
+                            ImGui::PopID();
+                        }
+
+                        ImGui::Separator();
+
+                        std::vector<int> namedLayers;
+                        for (int i = 0; i < PhysicsSettings::MaxCollisionLayers; ++i)
+                        {
+                            if (!physicsSettings.CollisionLayerNames[i].empty())
+                                namedLayers.push_back(i);
+                        }
+
+                        // Lower triangle of the symmetric matrix
+                        if (!namedLayers.empty() && ImGui::BeginTable("CollisionMatrix", static_cast<int>(namedLayers.size()) + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+                        {
+                            ImGui::TableSetupColumn("");
+                            for (int layer : namedLayers)
+                                ImGui::TableSetupColumn(physicsSettings.CollisionLayerNames[layer].c_str());
+                            ImGui::TableHeadersRow();
+
+                            for (size_t row = 0; row < namedLayers.size(); ++row)
+                            {
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                ImGui::TextUnformatted(physicsSettings.CollisionLayerNames[namedLayers[row]].c_str());
+
+                                for (size_t column = 0; column <= row; ++column)
+                                {
+                                    ImGui::TableNextColumn();
+                                    bool collide = physicsSettings.DoLayersCollide(namedLayers[row], namedLayers[column]);
+                                    ImGui::PushID(static_cast<int>(row * PhysicsSettings::MaxCollisionLayers + column));
+                                    if (ImGui::Checkbox("##Collide", &collide))
+                                    {
+                                        physicsSettings.SetLayersCollide(namedLayers[row], namedLayers[column], collide);
+                                        PhysicsEngine::ApplySettings(physicsSettings);
+                                    }
+                                    ImGui::PopID();
+                                }
+                            }
+                            ImGui::EndTable();
+                        }
+
+                        ImGui::EndMenu();
+                    }
+                }
+
                 ImGui::EndMenu();
             
             }
@@ -12,7 +12,7 @@ namespace Coffee
 {
     std::shared_ptr<spdlog::logger> Log::s_CoreLogger;
     std::shared_ptr<spdlog::logger> Log::s_ClientLogger;
-    std::vector<std::string> Log::s_LogBuffer;
+    std::deque<std::string> Log::s_LogBuffer;
 
     void Log::Init()
     {
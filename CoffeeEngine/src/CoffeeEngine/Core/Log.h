@@ -3,8 +3,8 @@
 #include <memory>
 #include <spdlog/logger.h>
 #include <spdlog/sinks/base_sink.h>
+#include <deque>
 #include <mutex>
-#include <vector>
 #include <string>
 
 namespace Coffee
@@ -38,13 +38,13 @@ namespace Coffee
          */
         inline static std::shared_ptr<spdlog::logger>& GetClientLogger() { return s_ClientLogger; }
 
-        static const std::vector<std::string>& GetLogBuffer() { return s_LogBuffer; }
+        static const std::deque<std::string>& GetLogBuffer() { return s_LogBuffer; }
         static void ClearLogBuffer() { s_LogBuffer.clear(); }
 
       private:
         static std::shared_ptr<spdlog::logger> s_CoreLogger; ///< The core logger.
         static std::shared_ptr<spdlog::logger> s_ClientLogger; ///< The client logger.
-        static std::vector<std::string> s_LogBuffer; ///< The log buffer.
+        static std::deque<std::string> s_LogBuffer; ///< The log buffer, oldest messages are dropped past 1024.
 
         template <typename Mutex>
         class LogSink : public spdlog::sinks::base_sink<Mutex>
@@ -54,7 +54,7 @@ namespace Coffee
             {
                 if(s_LogBuffer.size() > 1024)
                 {
-                    s_LogBuffer.erase(s_LogBuffer.begin());
+                    s_LogBuffer.pop_front();
                 }
 
                 spdlog::memory_buf_t formatted;
@@ -6,6 +6,7 @@
 #include "CoffeeEngine/Renderer/Model.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Material.h"
+#include "CoffeeEngine/Physics/ConvexHullCache.h"
 
 #include <cstdint>
 #include <filesystem>
@@ -135,6 +136,9 @@ namespace Coffee {
             mesh->SetMaterial(material);
             mesh->SetAABB(aabb);
             ResourceSaver::SaveToCache(uuidString, mesh);
+
+            // Cook the hulls now so dynamic colliders only read them from the cache
+            ConvexHullCache::Cook(mesh);
             return mesh;
         }
     }
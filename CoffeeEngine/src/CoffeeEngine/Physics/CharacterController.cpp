@@ -0,0 +1,328 @@
+#include "CharacterController.h"
+#include "CharacterSystem.h"
+#include "PhysUtils.h"
+#include "PhysicsEngine.h"
+
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <LinearMath/btAabbUtil2.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr btScalar kSkinWidth = 0.02f;     ///< Gap kept between the capsule and what it sweeps into.
+        constexpr int kMaxSlideIterations = 4;     ///< Surfaces slid along per move before giving up.
+        constexpr int kMaxRecoveryIterations = 4;  ///< Penetration passes per tick.
+        constexpr btScalar kRecoveryRate = 0.2f;   ///< Part of the penetration depth removed per pass.
+
+        /**
+         * @brief Closest sweep hit among the obstacles of a character.
+         *
+         * The ghost already applied the broadphase filter when it collected its objects, this
+         * drops the triggers, the ghosts and the character capsules, its own included, on top of it.
+         */
+        struct CharacterSweepCallback : public btCollisionWorld::ClosestConvexResultCallback
+        {
+            CharacterSweepCallback(const btVector3& from, const btVector3& to)
+                : btCollisionWorld::ClosestConvexResultCallback(from, to)
+            {
+            }
+
+            bool needsCollision(btBroadphaseProxy* proxy) const override
+            {
+                if (!btCollisionWorld::ClosestConvexResultCallback::needsCollision(proxy))
+                    return false;
+
+                const auto* object = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+                return object->hasContactResponse() &&
+                       object->getInternalType() != btCollisionObject::CO_GHOST_OBJECT &&
+                       !CharacterSystem::IsCharacterBody(object);
+            }
+        };
+
+        /** @brief Sums the depenetration of every contact where the capsule sinks into an object. */
+        struct PenetrationCallback : public btCollisionWorld::ContactResultCallback
+        {
+            explicit PenetrationCallback(const btCollisionObject* body) : m_Body(body) {}
+
+            btScalar addSingleResult(btManifoldPoint& point, const btCollisionObjectWrapper* wrap0, int partId0,
+                                     int index0, const btCollisionObjectWrapper* wrap1, int partId1,
+                                     int index1) override
+            {
+                if (point.getDistance() >= 0.0f)
+                    return 0.0f;
+
+                // The normal points from the second object towards the first
+                const btScalar sign = wrap0->getCollisionObject() == m_Body ? 1.0f : -1.0f;
+                m_Push += point.m_normalWorldOnB * (sign * -point.getDistance());
+                return 0.0f;
+            }
+
+            const btCollisionObject* m_Body;
+            btVector3 m_Push{0.0f, 0.0f, 0.0f};
+        };
+    } // namespace
+
+    CharacterController::CharacterController(const CharacterControllerConfig& config, const glm::vec3& position)
+        : m_Config(config)
+    {
+        m_Config.Radius = std::max(m_Config.Radius, 0.01f);
+        m_Config.Height = std::max(m_Config.Height, m_Config.Radius * 2.0f);
+        m_CosMaxSlope = std::cos(glm::radians(std::clamp(m_Config.MaxSlopeAngle, 0.0f, 90.0f)));
+
+        m_Shape = CreateScope<btCapsuleShape>(m_Config.Radius, m_Config.Height - m_Config.Radius * 2.0f);
+
+        // The ghost only has to reach whatever the capsule can touch before the next broadphase pass
+        const btScalar tick = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        const btScalar horizontalReach = m_Config.Radius + m_Config.MaxSpeed * tick + kSkinWidth;
+        const btScalar verticalReach = m_Config.Height * 0.5f + m_Config.StepHeight + m_Config.SnapDistance +
+                                       m_Config.MaxFallSpeed * tick + kSkinWidth;
+        m_QueryShape = CreateScope<btBoxShape>(btVector3(horizontalReach, verticalReach, horizontalReach));
+
+        const btTransform transform(btQuaternion::getIdentity(), PhysUtils::GlmToBullet(position));
+
+        m_Ghost = CreateScope<btGhostObject>();
+        m_Ghost->setCollisionShape(m_QueryShape.get());
+        m_Ghost->setWorldTransform(transform);
+        m_Ghost->setCollisionFlags(m_Ghost->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE |
+                                   btCollisionObject::CF_DISABLE_VISUALIZE_OBJECT);
+        m_Ghost->setActivationState(DISABLE_DEACTIVATION);
+
+        // Moved by the sweeps every tick, kept active so its broadphase bounds follow
+        m_Body = CreateScope<btCollisionObject>();
+        m_Body->setCollisionShape(m_Shape.get());
+        m_Body->setWorldTransform(transform);
+        m_Body->setCollisionFlags(m_Body->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+        m_Body->setActivationState(DISABLE_DEACTIVATION);
+        m_Body->setUserIndex(CharacterSystem::kCharacterBodyTag);
+
+        m_Callbacks.character = this;
+        m_Body->setUserPointer(&m_Callbacks);
+
+        CharacterSystem::AddCharacter(this);
+    }
+
+    CharacterController::~CharacterController()
+    {
+        CharacterSystem::RemoveCharacter(this);
+    }
+
+    void CharacterController::SetWalkVelocity(const glm::vec3& velocity)
+    {
+        btVector3 walk(velocity.x, 0.0f, velocity.z);
+        const btScalar speed = walk.length();
+        if (speed > m_Config.MaxSpeed)
+            walk *= m_Config.MaxSpeed / speed;
+        m_WalkVelocity = walk;
+    }
+
+    void CharacterController::Jump(float speed)
+    {
+        m_VerticalVelocity = std::min(speed, m_Config.MaxFallSpeed);
+        m_Grounded = false;
+    }
+
+    void CharacterController::SetPosition(const glm::vec3& position)
+    {
+        PhysicsEngine::WaitForStep();
+
+        btTransform transform = m_Ghost->getWorldTransform();
+        transform.setOrigin(PhysUtils::GlmToBullet(position));
+        m_Ghost->setWorldTransform(transform);
+        m_Body->setWorldTransform(transform);
+        m_VerticalVelocity = 0.0f;
+        m_Grounded = false;
+    }
+
+    glm::vec3 CharacterController::GetPosition() const
+    {
+        return PhysUtils::BulletToGlm(m_Ghost->getWorldTransform().getOrigin());
+    }
+
+    glm::vec3 CharacterController::GetGroundNormal() const
+    {
+        return PhysUtils::BulletToGlm(m_GroundNormal);
+    }
+
+    void CharacterController::Step(btCollisionWorld* world, btScalar dt)
+    {
+        m_Stats = {};
+        m_Stats.Candidates = static_cast<uint32_t>(m_Ghost->getNumOverlappingObjects());
+
+        const btVector3 up(0.0f, 1.0f, 0.0f);
+        btVector3 position = RecoverFromPenetration(world, m_Ghost->getWorldTransform().getOrigin());
+
+        // Standing still on the ground is not falling, the snap below keeps the character there
+        if (!m_Grounded || m_VerticalVelocity > 0.0f)
+        {
+            const btScalar gravity = static_cast<btDynamicsWorld*>(world)->getGravity().y();
+            m_VerticalVelocity =
+                btClamp(m_VerticalVelocity + gravity * dt, btScalar(-m_Config.MaxFallSpeed), btScalar(m_Config.MaxFallSpeed));
+        }
+
+        const btVector3 move = m_WalkVelocity * dt;
+
+        // Rise first, by the jump and by a step height when walking, so low ledges are walked over
+        const btScalar rise = m_VerticalVelocity > 0.0f ? m_VerticalVelocity * dt : 0.0f;
+        const btScalar climb = m_Grounded && !move.fuzzyZero() ? btScalar(m_Config.StepHeight) : 0.0f;
+        btScalar stepUp = 0.0f;
+        if (rise + climb > 0.0f)
+        {
+            btScalar lift = rise + climb;
+            SweepHit hit;
+            if (Sweep(world, position, position + up * lift, hit))
+            {
+                lift *= hit.Fraction;
+                if (rise > 0.0f && hit.Normal.y() < 0.0f)
+                    m_VerticalVelocity = 0.0f; // Head hit a ceiling
+            }
+            position += up * lift;
+            stepUp = std::min(lift, climb);
+        }
+
+        position = SlideMove(world, position, move, true);
+
+        // Drop back by the step, by the fall, and by the snap distance to stay on slopes and stairs
+        const btScalar fall = m_VerticalVelocity < 0.0f ? -m_VerticalVelocity * dt : 0.0f;
+        const btScalar snap = m_Grounded && m_VerticalVelocity <= 0.0f ? btScalar(m_Config.SnapDistance) : 0.0f;
+        const btScalar drop = stepUp + fall + snap;
+
+        bool grounded = false;
+        btVector3 groundNormal = up;
+        if (drop > 0.0f)
+        {
+            SweepHit hit;
+            if (!Sweep(world, position, position - up * drop, hit))
+            {
+                // Nothing to snap onto, the character walked off a ledge
+                position -= up * (drop - snap);
+            }
+            else if (hit.Normal.y() >= m_CosMaxSlope)
+            {
+                position -= up * (drop * hit.Fraction);
+                grounded = true;
+                groundNormal = hit.Normal;
+            }
+            else
+            {
+                // Too steep to stand on, slide down along it
+                position -= up * (drop * hit.Fraction);
+                position = SlideMove(world, position, -up * (drop * (1.0f - hit.Fraction)), false);
+            }
+        }
+
+        if (grounded && m_VerticalVelocity < 0.0f)
+            m_VerticalVelocity = 0.0f;
+        m_Grounded = grounded;
+        m_GroundNormal = groundNormal;
+
+        btTransform transform = m_Ghost->getWorldTransform();
+        transform.setOrigin(position);
+        m_Ghost->setWorldTransform(transform);
+        m_Body->setWorldTransform(transform);
+    }
+
+    bool CharacterController::Sweep(btCollisionWorld* world, const btVector3& from, const btVector3& to,
+                                    SweepHit& hit)
+    {
+        const btScalar length = (to - from).length();
+        if (length < SIMD_EPSILON)
+            return false;
+
+        ++m_Stats.Sweeps;
+
+        CharacterSweepCallback result(from, to);
+        const btBroadphaseProxy* proxy = m_Ghost->getBroadphaseHandle();
+        result.m_collisionFilterGroup = proxy->m_collisionFilterGroup;
+        result.m_collisionFilterMask = proxy->m_collisionFilterMask;
+
+        // Only the objects the broadphase found around the ghost are tested
+        m_Ghost->convexSweepTest(m_Shape.get(), btTransform(btQuaternion::getIdentity(), from),
+                                 btTransform(btQuaternion::getIdentity(), to), result,
+                                 world->getDispatchInfo().m_allowedCcdPenetration);
+        if (!result.hasHit())
+            return false;
+
+        hit.Fraction = std::max(btScalar(0.0f), result.m_closestHitFraction - kSkinWidth / length);
+        hit.Normal = result.m_hitNormalWorld;
+        return true;
+    }
+
+    btVector3 CharacterController::SlideMove(btCollisionWorld* world, btVector3 position, btVector3 motion,
+                                             bool blockSteepSlopes)
+    {
+        for (int i = 0; i < kMaxSlideIterations && !motion.fuzzyZero(); ++i)
+        {
+            SweepHit hit;
+            if (!Sweep(world, position, position + motion, hit))
+                return position + motion;
+
+            position += motion * hit.Fraction;
+            motion *= 1.0f - hit.Fraction;
+
+            // Steep slopes are slid along like walls, climbing them would walk the character up
+            btVector3 normal = hit.Normal;
+            if (blockSteepSlopes && normal.y() < m_CosMaxSlope)
+            {
+                normal.setY(0.0f);
+                if (normal.fuzzyZero())
+                    break;
+                normal.normalize();
+            }
+
+            motion -= normal * motion.dot(normal);
+        }
+
+        return position;
+    }
+
+    btVector3 CharacterController::RecoverFromPenetration(btCollisionWorld* world, btVector3 position)
+    {
+        for (int iteration = 0; iteration < kMaxRecoveryIterations; ++iteration)
+        {
+            m_Body->getWorldTransform().setOrigin(position);
+
+            btVector3 bodyMin, bodyMax;
+            m_Shape->getAabb(m_Body->getWorldTransform(), bodyMin, bodyMax);
+
+            PenetrationCallback callback(m_Body.get());
+            for (int i = 0; i < m_Ghost->getNumOverlappingObjects(); ++i)
+            {
+                btCollisionObject* object = m_Ghost->getOverlappingObject(i);
+                if (!IsObstacle(object))
+                    continue;
+
+                const btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+                if (!TestAabbAgainstAabb2(bodyMin, bodyMax, proxy->m_aabbMin, proxy->m_aabbMax))
+                    continue;
+
+                ++m_Stats.ContactTests;
+                world->contactPairTest(m_Body.get(), object, callback);
+            }
+
+            if (callback.m_Push.fuzzyZero())
+                break;
+
+            position += callback.m_Push * kRecoveryRate;
+        }
+
+        return position;
+    }
+
+    bool CharacterController::IsObstacle(const btCollisionObject* object) const
+    {
+        if (!object->hasContactResponse() || object->getInternalType() == btCollisionObject::CO_GHOST_OBJECT ||
+            CharacterSystem::IsCharacterBody(object))
+            return false;
+
+        const btBroadphaseProxy* self = m_Ghost->getBroadphaseHandle();
+        const btBroadphaseProxy* other = object->getBroadphaseHandle();
+        return other && (self->m_collisionFilterGroup & other->m_collisionFilterMask) &&
+               (other->m_collisionFilterGroup & self->m_collisionFilterMask);
+    }
+
+} // namespace Coffee
@@ -0,0 +1,163 @@
+/**
+ * @file CharacterController.h
+ * @brief Declares the CharacterController class, a kinematic capsule that slides, climbs steps and sticks to the ground.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CollisionCallbacks.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <cereal/cereal.hpp>
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+class btGhostObject;
+
+namespace Coffee
+{
+
+    /**
+     * @struct CharacterControllerConfig
+     * @brief Capsule size and movement limits of a character.
+     */
+    struct CharacterControllerConfig
+    {
+        float Radius = 0.4f;          ///< Capsule radius.
+        float Height = 1.8f;          ///< Capsule height, caps included.
+        float StepHeight = 0.35f;     ///< Tallest ledge walked over without jumping.
+        float MaxSlopeAngle = 45.0f;  ///< Steepest walkable slope in degrees, steeper ones act as walls.
+        float SnapDistance = 0.3f;    ///< Drop followed while walking down slopes and stairs.
+        float MaxSpeed = 10.0f;       ///< Fastest walk speed.
+        float MaxFallSpeed = 55.0f;   ///< Fastest vertical speed.
+        int CollisionLayer = 0;       ///< Layer whose collision matrix row picks the obstacles.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Radius", Radius), cereal::make_nvp("Height", Height),
+                    cereal::make_nvp("StepHeight", StepHeight), cereal::make_nvp("MaxSlopeAngle", MaxSlopeAngle),
+                    cereal::make_nvp("SnapDistance", SnapDistance), cereal::make_nvp("MaxSpeed", MaxSpeed),
+                    cereal::make_nvp("MaxFallSpeed", MaxFallSpeed), cereal::make_nvp("CollisionLayer", CollisionLayer));
+        }
+    };
+
+    /**
+     * @struct CharacterQueryStats
+     * @brief Collision queries a character ran in its last tick.
+     */
+    struct CharacterQueryStats
+    {
+        uint32_t Candidates = 0;   ///< Objects overlapping the ghost, the only ones the queries look at.
+        uint32_t Sweeps = 0;       ///< Capsule sweeps.
+        uint32_t ContactTests = 0; ///< Narrowphase tests run to push the capsule out of penetration.
+    };
+
+    /**
+     * @class CharacterController
+     * @brief A capsule moved by sweeps against the world, updated by the CharacterSystem.
+     *
+     * The character is not a rigid body and nothing pushes it. Its capsule is in the world as a
+     * kinematic object, so rigid bodies, vehicles and projectiles collide with it and dynamic
+     * bodies are pushed away. Every tick it steps up, slides along what it hits, then steps
+     * back down to snap onto the ground. Slopes steeper than MaxSlopeAngle block it like walls.
+     * Characters pass through each other.
+     *
+     * Inputs are set and the pose is read between steps.
+     */
+    class CharacterController
+    {
+      public:
+        /**
+         * @brief Creates the character and adds it to the world.
+         * @param config Capsule size and movement limits.
+         * @param position World position of the capsule centre.
+         */
+        CharacterController(const CharacterControllerConfig& config, const glm::vec3& position);
+        ~CharacterController();
+
+        CharacterController(const CharacterController&) = delete;
+        CharacterController& operator=(const CharacterController&) = delete;
+
+        /**
+         * @brief Sets the walk velocity, kept until changed.
+         * @param velocity Horizontal velocity, the vertical part is ignored and the length is clamped to MaxSpeed.
+         */
+        void SetWalkVelocity(const glm::vec3& velocity);
+
+        /**
+         * @brief Leaves the ground with an upward speed.
+         * @param speed Vertical speed in m/s.
+         */
+        void Jump(float speed);
+
+        /** @brief Moves the character without sweeping, its vertical speed is dropped. */
+        void SetPosition(const glm::vec3& position);
+
+        /** @brief Gets the world position of the capsule centre after the last step. */
+        glm::vec3 GetPosition() const;
+        /** @brief Checks if the character stood on walkable ground after the last step. */
+        bool IsGrounded() const { return m_Grounded; }
+        /** @brief Gets the normal of the ground below the character, up when airborne. */
+        glm::vec3 GetGroundNormal() const;
+        /** @brief Gets the queries the character ran in the last step. */
+        const CharacterQueryStats& GetQueryStats() const { return m_Stats; }
+        /** @brief Gets the settings the character was created with. */
+        const CharacterControllerConfig& GetConfig() const { return m_Config; }
+
+        /** @brief Sets the entity reported by queries and projectile hits against the capsule. */
+        void SetEntity(entt::entity entity) { m_Entity = entity; }
+        /** @brief Gets the entity of the character, null if none was set. */
+        entt::entity GetEntity() const { return m_Entity; }
+        /** @brief Gets the callbacks run on contacts and projectile hits against the capsule. */
+        CollisionCallbacks& GetCallbacks() { return m_Callbacks; }
+
+      private:
+        /** @brief Closest hit of a sweep, backed off from the surface by the skin width. */
+        struct SweepHit
+        {
+            btScalar Fraction = 1.0f; ///< Part of the motion that is free.
+            btVector3 Normal;         ///< World-space normal of the surface hit.
+        };
+
+        /** @brief Moves the character for one tick. */
+        void Step(btCollisionWorld* world, btScalar dt);
+
+        /** @brief Sweeps the capsule against the objects overlapping the ghost. */
+        bool Sweep(btCollisionWorld* world, const btVector3& from, const btVector3& to, SweepHit& hit);
+
+        /**
+         * @brief Moves along a motion, sliding along every surface hit on the way.
+         * @param blockSteepSlopes Whether slopes steeper than MaxSlopeAngle are slid along horizontally.
+         * @return The position reached.
+         */
+        btVector3 SlideMove(btCollisionWorld* world, btVector3 position, btVector3 motion, bool blockSteepSlopes);
+
+        /** @brief Pushes the capsule out of the objects it sinks into, returns the new position. */
+        btVector3 RecoverFromPenetration(btCollisionWorld* world, btVector3 position);
+
+        /** @brief Checks if the character collides with an object overlapping its ghost. */
+        bool IsObstacle(const btCollisionObject* object) const;
+
+        CharacterControllerConfig m_Config;
+        Scope<btCapsuleShape> m_Shape;      ///< The character capsule.
+        Scope<btBoxShape> m_QueryShape;     ///< Capsule bounds padded by a tick of motion, only used for the ghost AABB.
+        Scope<btGhostObject> m_Ghost;       ///< In the world, collects the objects near the character.
+        Scope<btCollisionObject> m_Body;    ///< Kinematic capsule in the world, what other objects collide with.
+        btScalar m_CosMaxSlope = 0.0f;
+
+        btVector3 m_WalkVelocity{0.0f, 0.0f, 0.0f};
+        btScalar m_VerticalVelocity = 0.0f;
+        btVector3 m_GroundNormal{0.0f, 1.0f, 0.0f};
+        bool m_Grounded = false;
+        CharacterQueryStats m_Stats;
+
+        CollisionCallbacks m_Callbacks; ///< User pointer of the capsule.
+        entt::entity m_Entity = entt::null;
+
+        friend class CharacterSystem;
+    };
+
+} // namespace Coffee
@@ -0,0 +1,100 @@
+#include "CharacterSystem.h"
+#include "PhysicsEngine.h"
+
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    CharacterSystem::CharacterAction CharacterSystem::s_Action;
+    btGhostPairCallback CharacterSystem::s_GhostPairCallback;
+    std::vector<CharacterController*> CharacterSystem::s_Characters;
+    CharacterQueryStats CharacterSystem::s_TotalStats;
+
+    void CharacterSystem::Install(btDynamicsWorld* world)
+    {
+        world->getPairCache()->setInternalGhostPairCallback(&s_GhostPairCallback);
+        static_cast<btCollisionDispatcher*>(world->getDispatcher())->setNearCallback(&NearCallback);
+        world->addAction(&s_Action);
+    }
+
+    void CharacterSystem::AddCharacter(CharacterController* character)
+    {
+        // The character list is walked by the step
+        PhysicsEngine::WaitForStep();
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+        if (!world)
+            return;
+
+        const int layer = std::clamp(character->m_Config.CollisionLayer, 0, PhysicsSettings::MaxCollisionLayers - 1);
+        world->addCollisionObject(character->m_Ghost.get(), PhysicsEngine::GetCollisionGroup(layer),
+                                  PhysicsEngine::GetCollisionMask(layer));
+        world->addCollisionObject(character->m_Body.get(), PhysicsEngine::GetCollisionGroup(layer),
+                                  PhysicsEngine::GetCollisionMask(layer));
+        s_Characters.push_back(character);
+    }
+
+    void CharacterSystem::RemoveCharacter(CharacterController* character)
+    {
+        PhysicsEngine::WaitForStep();
+
+        auto it = std::find(s_Characters.begin(), s_Characters.end(), character);
+        if (it == s_Characters.end())
+            return;
+
+        *it = s_Characters.back();
+        s_Characters.pop_back();
+
+        if (btDynamicsWorld* world = PhysicsEngine::GetWorld())
+        {
+            PhysicsEngine::ForgetCollisionObject(character->m_Body.get());
+            world->removeCollisionObject(character->m_Body.get());
+            world->removeCollisionObject(character->m_Ghost.get());
+        }
+    }
+
+    void CharacterSystem::CharacterAction::updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep)
+    {
+        s_TotalStats = {};
+        if (s_Characters.empty())
+            return;
+
+        ZoneScopedN("Characters");
+
+        for (CharacterController* character : s_Characters)
+        {
+            character->Step(collisionWorld, deltaTimeStep);
+
+            const CharacterQueryStats& stats = character->GetQueryStats();
+            s_TotalStats.Candidates += stats.Candidates;
+            s_TotalStats.Sweeps += stats.Sweeps;
+            s_TotalStats.ContactTests += stats.ContactTests;
+        }
+
+        TracyPlot("Character Sweeps", static_cast<int64_t>(s_TotalStats.Sweeps));
+        TracyPlot("Character Contact Tests", static_cast<int64_t>(s_TotalStats.ContactTests));
+    }
+
+    void CharacterSystem::NearCallback(btBroadphasePair& pair, btCollisionDispatcher& dispatcher,
+                                       const btDispatcherInfo& info)
+    {
+        // Ghosts only gather the objects around them, contacts with them would never be used
+        const auto* object0 = static_cast<const btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+        const auto* object1 = static_cast<const btCollisionObject*>(pair.m_pProxy1->m_clientObject);
+        if (object0->getInternalType() == btCollisionObject::CO_GHOST_OBJECT ||
+            object1->getInternalType() == btCollisionObject::CO_GHOST_OBJECT)
+            return;
+
+        // A capsule is moved by its sweeps, against static and kinematic geometry there is nothing to solve
+        auto isSolid = [](const btCollisionObject* object) {
+            return object->isStaticOrKinematicObject() && object->hasContactResponse();
+        };
+        if ((IsCharacterBody(object0) && isSolid(object1)) || (IsCharacterBody(object1) && isSolid(object0)))
+            return;
+
+        btCollisionDispatcher::defaultNearCallback(pair, dispatcher, info);
+    }
+
+} // namespace Coffee
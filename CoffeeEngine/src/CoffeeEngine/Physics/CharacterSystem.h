@@ -0,0 +1,80 @@
+/**
+ * @file CharacterSystem.h
+ * @brief Declares the CharacterSystem that moves every character controller in one pass per tick.
+ */
+
+#pragma once
+
+#include "CharacterController.h"
+
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @class CharacterSystem
+     * @brief Registers the characters with the world and steps them from a single world action.
+     *
+     * Each character owns a ghost object sized to its capsule plus one tick of motion. The
+     * broadphase keeps the objects overlapping every ghost up to date through Bullet's ghost
+     * pair callback, so the sweeps and penetration tests of a character only look at the
+     * geometry around it instead of walking the broadphase again. The world's own narrowphase
+     * skips ghost pairs, the characters run the tests they need themselves.
+     *
+     * The capsule of every character is in the world as a kinematic object tagged with
+     * kCharacterBodyTag. The narrowphase only pairs it with dynamic bodies and triggers, and
+     * the sweeps of the characters ignore the capsules.
+     */
+    class CharacterSystem
+    {
+      public:
+        /** @brief User index of the character capsules. */
+        static constexpr int kCharacterBodyTag = 0x43686172;
+
+        /** @brief Checks if an object is the capsule of a character. */
+        static bool IsCharacterBody(const btCollisionObject* object)
+        {
+            return object->getUserIndex() == kCharacterBodyTag;
+        }
+
+        /**
+         * @brief Hooks the ghost pair callback, the near callback and the character action into a newly created world.
+         * @param world The world.
+         */
+        static void Install(btDynamicsWorld* world);
+
+        /** @brief Adds the ghost and the capsule of a character to the world and starts stepping it. */
+        static void AddCharacter(CharacterController* character);
+
+        /** @brief Stops stepping a character and removes its ghost and capsule from the world. */
+        static void RemoveCharacter(CharacterController* character);
+
+        /** @brief Gets the number of characters being stepped. */
+        static size_t GetCharacterCount() { return s_Characters.size(); }
+
+        /** @brief Gets the queries of every character summed over the last tick. */
+        static const CharacterQueryStats& GetTotalStats() { return s_TotalStats; }
+
+      private:
+        /** @brief The world action every character is stepped from. */
+        class CharacterAction : public btActionInterface
+        {
+          public:
+            void updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep) override;
+            void debugDraw(btIDebugDraw* debugDrawer) override {}
+        };
+
+        /** @brief Runs the world narrowphase on every pair except ghost pairs and capsules against static geometry. */
+        static void NearCallback(btBroadphasePair& pair, btCollisionDispatcher& dispatcher, const btDispatcherInfo& info);
+
+        static CharacterAction s_Action;
+        static btGhostPairCallback s_GhostPairCallback;
+        static std::vector<CharacterController*> s_Characters;
+        static CharacterQueryStats s_TotalStats;
+    };
+
+} // namespace Coffee
@@ -1,4 +1,5 @@
 #include "Collider.h"
+#include "CollisionShapeCache.h"
 #include "PhysUtils.h"
 #include "PhysicsEngine.h"
 
@@ -7,11 +8,14 @@ namespace Coffee
 
     Collider::Collider(const CollisionShapeConfig& config, const glm::vec3& position, const glm::quat& rotation,
                        const glm::vec3& scale)
-        : m_isTrigger(config.isTrigger), m_mass(config.mass), m_position(position), m_scale(scale)
+        : m_shapeConfig(config), m_isTrigger(config.isTrigger), m_mass(config.mass), m_position(position), m_scale(scale)
     {
         // Usar la función CreateCollisionObject para crear el btCollisionObject
         m_collisionObject = PhysicsEngine::CreateCollisionObject(config, position, scale, rotation);
 
+        m_callbacks.collider = this;
+        m_collisionObject->setUserPointer(&m_callbacks);
+
         // PhysicsEngine::AddDebugDrawCommand(CollisionShapeType::BOX, position, rotation,
         //                                    scale, // fullsize
         //                                    glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
@@ -21,47 +25,18 @@ namespace Coffee
 
     Collider::~Collider()
     {
-        PhysicsEngine::GetWorld()->removeCollisionObject(m_collisionObject);
-        delete m_collisionObject;
+        PhysicsEngine::DestroyCollisionObject(m_collisionObject);
     }
 
-    //void Collider::SetPosition(const glm::vec3& position, const glm::vec3& positionOffset)
-    //{
-    //    if (this != nullptr && m_collisionObject)
-    //    {
-    //        // Actualizar la posición interna
-    //        m_offset = positionOffset;
-    //        m_position = position + m_offset;
-
-    //        // Obtener la transformación actual del objeto de colisión
-    //        btTransform transform = m_collisionObject->getWorldTransform();
-    //        transform.setOrigin(PhysUtils::GlmToBullet(m_position));
-
-    //        // Si el objeto es un btRigidBody, actualizar su estado de interpolación
-    //        btRigidBody* rigidBody = btRigidBody::upcast(m_collisionObject);
-    //        if (rigidBody)
-    //        {
-    //            rigidBody->setWorldTransform(transform);
-    //            rigidBody->getMotionState()->setWorldTransform(transform);
-    //        }
-    //        else
-    //        {
-    //            m_collisionObject->setWorldTransform(transform);
-    //        }
-
-    //        // Redibujar la caja en la nueva posición para depuración
-    //        Coffee::DebugRenderer::DrawBox(m_position, glm::vec3(0, 0, 0), m_scale, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f),
-    //                                       true, 2.0f);
-    //    }
-    //}
-
-
     void Collider::ColliderUpdate(const glm::vec3 position, const glm::vec3 offset, const glm::quat rotation,
                                   const glm::vec3 size)
     {
         if (!m_collisionObject)
             return;
 
+        // The editor moves colliders at any point of the frame, the step may be running
+        PhysicsEngine::WaitForStep();
+
         // Actualizar las propiedades internas
         m_offset = offset;
         m_position = position + m_offset;
@@ -89,14 +64,20 @@ namespace Coffee
         if (size != m_scale)
         {
             m_scale = size;
-            if (m_collisionObject->getCollisionShape())
+
+            // Shapes are shared, so switch to the one with the new scale instead of rescaling in place
+            btCollisionShape* shape = CollisionShapeCache::Acquire(m_shapeConfig, m_scale);
+            CollisionShapeCache::Release(m_collisionObject->getCollisionShape());
+            m_collisionObject->setCollisionShape(shape);
+
+            // Contacts cached against the old shape are no longer valid
+            btDynamicsWorld* world = PhysicsEngine::GetWorld();
+            if (btBroadphaseProxy* proxy = m_collisionObject->getBroadphaseHandle())
             {
-                m_collisionObject->getCollisionShape()->setLocalScaling(PhysUtils::GlmToBullet(m_scale));
+                world->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(proxy,
+                                                                                       world->getDispatcher());
             }
         }
-
-        Coffee::DebugRenderer::DrawBox(m_position, m_rotation, m_scale, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f), true, 2.0f);
-
     }
 
 
@@ -153,6 +134,8 @@ namespace Coffee
 
     void Collider::SetEnabled(bool enabled)
     {
+        PhysicsEngine::WaitForStep();
+
         if (enabled)
         {
             m_collisionObject->setCollisionFlags(m_collisionObject->getCollisionFlags() &
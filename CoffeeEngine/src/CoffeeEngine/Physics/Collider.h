@@ -1,5 +1,8 @@
 #pragma once
 
+#include "CoffeeEngine/Core/Base.h"
+#include "CollisionCallbacks.h"
+
 #include <bullet/btBulletDynamicsCommon.h>
 #include <functional>
 #include <glm/glm.hpp>
@@ -9,6 +12,8 @@
 namespace Coffee
 {
 
+    class Mesh;
+
     /**
      * @enum CollisionShapeType
      * @brief Defines the types of collision shapes.
@@ -19,7 +24,8 @@ namespace Coffee
         SPHERE,   /**< Sphere shape */
         CAPSULE,  /**< Capsule shape */
         CYLINDER, /**< Cylinder shape */
-        MESH      /**< Mesh shape */
+        MESH,       /**< Static triangle mesh shape */
+        CONVEX_HULL /**< Convex hulls generated from a mesh */
     };
 
     /**
@@ -34,6 +40,8 @@ namespace Coffee
         float mass = 1.0f;                                 /**< Mass of the object */
         float radius = 0.5f;                               // Para Sphere, Capsule y Cylinder
         float height = 1.0f;  
+        int layer = 0;                                     /**< Collision layer, see PhysicsSettings::CollisionMatrix */
+        Ref<Mesh> mesh = nullptr;                          /**< Source of MESH and CONVEX_HULL shapes */
     };
 
     /**
@@ -99,6 +107,16 @@ namespace Coffee
          */
         void AddCollisionListener(const CollisionCallback& callback);
 
+        /**
+         * @brief Checks if anything listens to the collisions of this collider.
+         * @return True if a collision listener or contact callback is set, false otherwise.
+         */
+        bool HasCollisionListeners() const
+        {
+            return !m_collisionListeners.empty() || m_callbacks.m_OnContactStarted || m_callbacks.m_OnContactStay ||
+                   m_callbacks.m_OnContactEnded;
+        }
+
         /**
          * @brief Handles collision events.
          * @param other The other collider involved.
@@ -115,6 +133,8 @@ namespace Coffee
         void UpdateCollisionShape(); /**< Implemented by derived classes */
 
         btCollisionObject* m_collisionObject; /**< Bullet collision object */
+        CollisionShapeConfig m_shapeConfig;   /**< Configuration the shape was created from */
+        CollisionCallbacks m_callbacks;       /**< Contact callbacks, set as the user pointer of the object */
         glm::vec3 m_position;                 /**< Collider position */
         glm::quat m_rotation;                 /**< Collider rotation */
         glm::vec3 m_scale;                    /**< Collider scale */
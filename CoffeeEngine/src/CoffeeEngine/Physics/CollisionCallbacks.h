@@ -8,8 +8,10 @@
 
 namespace Coffee
 {
+    class CharacterController;
     class Collider;
     class RigidBody;
+    struct ProjectileHit;
 
     /**
      * @struct CollisionCallbacks
@@ -17,12 +19,16 @@ namespace Coffee
      */
     struct CollisionCallbacks {
         using OnCollisionCallback = std::function<void(CollisionCallbacks* other)>;
+        using OnProjectileHitCallback = std::function<void(const ProjectileHit& hit)>;
     public:
-        RigidBody* rigidBody; ///< Pointer to the associated RigidBody.
-        Collider* collider; ///< Pointer to the associated Collider.
+        RigidBody* rigidBody = nullptr; ///< Pointer to the associated RigidBody.
+        Collider* collider = nullptr; ///< Pointer to the associated Collider.
+        CharacterController* character = nullptr; ///< Pointer to the associated CharacterController.
   
         OnCollisionCallback m_OnContactStarted; ///< Callback triggered when contact starts.
+        OnCollisionCallback m_OnContactStay; ///< Callback triggered every tick while the contact lasts, set it while the world is idle since the step checks it.
         OnCollisionCallback m_OnContactEnded; ///< Callback triggered when contact ends.
+        OnProjectileHitCallback m_OnProjectileHit; ///< Callback triggered when a projectile hits the object.
     };
 
 } // Coffee
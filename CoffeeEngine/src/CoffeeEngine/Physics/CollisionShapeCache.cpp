@@ -0,0 +1,154 @@
+#include "CollisionShapeCache.h"
+#include "PhysUtils.h"
+#include "TriangleMeshCache.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+
+#include <functional>
+
+namespace Coffee
+{
+
+    std::unordered_map<CollisionShapeCache::ShapeKey, CollisionShapeCache::Entry, CollisionShapeCache::ShapeKeyHash>
+        CollisionShapeCache::s_Shapes;
+    std::unordered_map<btCollisionShape*, CollisionShapeCache::ShapeKey> CollisionShapeCache::s_Keys;
+
+    size_t CollisionShapeCache::ShapeKeyHash::operator()(const ShapeKey& key) const
+    {
+        size_t seed = std::hash<int>()(static_cast<int>(key.Type));
+
+        auto combine = [&seed](float value) {
+            seed ^= std::hash<float>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+
+        combine(key.Size.x);
+        combine(key.Size.y);
+        combine(key.Size.z);
+        combine(key.Radius);
+        combine(key.Height);
+        combine(key.Scale.x);
+        combine(key.Scale.y);
+        combine(key.Scale.z);
+        seed ^= std::hash<uint64_t>()(key.Mesh) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+        return seed;
+    }
+
+    btCollisionShape* CollisionShapeCache::Acquire(const CollisionShapeConfig& config, const glm::vec3& scale)
+    {
+        // Mesh shapes without triangles fall back to the box below
+        const bool isMesh =
+            (config.type == CollisionShapeType::MESH || config.type == CollisionShapeType::CONVEX_HULL) && config.mesh;
+        const ShapeKey key{config.type, config.size, config.radius, config.height, scale,
+                           isMesh ? static_cast<uint64_t>(config.mesh->GetUUID()) : 0};
+
+        Entry& entry = s_Shapes[key];
+        if (!entry.Shape)
+        {
+            entry.Shape = CreateShape(config);
+            entry.Shape->setLocalScaling(PhysUtils::GlmToBullet(scale));
+            s_Keys.emplace(entry.Shape, key);
+        }
+
+        entry.References++;
+        return entry.Shape;
+    }
+
+    void CollisionShapeCache::Retain(btCollisionShape* shape)
+    {
+        auto it = s_Keys.find(shape);
+        if (it == s_Keys.end())
+            return;
+
+        s_Shapes[it->second].References++;
+    }
+
+    void CollisionShapeCache::Release(btCollisionShape* shape)
+    {
+        auto keyIt = s_Keys.find(shape);
+        if (keyIt == s_Keys.end())
+            return;
+
+        auto entryIt = s_Shapes.find(keyIt->second);
+        if (--entryIt->second.References > 0)
+            return;
+
+        DestroyShape(entryIt->second.Shape);
+        s_Shapes.erase(entryIt);
+        s_Keys.erase(keyIt);
+    }
+
+    void CollisionShapeCache::Clear()
+    {
+        for (auto& [key, entry] : s_Shapes)
+            DestroyShape(entry.Shape);
+
+        s_Shapes.clear();
+        s_Keys.clear();
+    }
+
+    btCollisionShape* CollisionShapeCache::CreateShape(const CollisionShapeConfig& config)
+    {
+        switch (config.type)
+        {
+        case CollisionShapeType::SPHERE:
+            return new btSphereShape(config.radius);
+        case CollisionShapeType::CAPSULE:
+            return new btCapsuleShape(config.radius, config.height);
+        case CollisionShapeType::CYLINDER:
+            return new btCylinderShape(btVector3(config.radius, config.height * 0.5f, config.radius));
+        case CollisionShapeType::MESH:
+            if (btBvhTriangleMeshShape* meshShape = TriangleMeshCache::Acquire(config.mesh))
+                return new btScaledBvhTriangleMeshShape(meshShape, btVector3(1, 1, 1));
+            [[fallthrough]];
+        case CollisionShapeType::CONVEX_HULL:
+            if (config.type == CollisionShapeType::CONVEX_HULL)
+            {
+                if (const ConvexHullSet* hulls = ConvexHullCache::Get(config.mesh))
+                    return CreateHullShape(*hulls);
+            }
+            [[fallthrough]];
+        case CollisionShapeType::BOX:
+        default:
+            return new btBoxShape(PhysUtils::GlmToBullet(config.size * 0.5f));
+        }
+    }
+
+    btCollisionShape* CollisionShapeCache::CreateHullShape(const ConvexHullSet& hulls)
+    {
+        auto createHull = [](const std::vector<glm::vec3>& points) {
+            auto* hull = new btConvexHullShape(&points[0].x, static_cast<int>(points.size()), sizeof(glm::vec3));
+            hull->optimizeConvexHull();
+            return hull;
+        };
+
+        if (hulls.Hulls.size() == 1)
+            return createHull(hulls.Hulls[0]);
+
+        // Pieces are in mesh space, so every child sits at the origin of the compound
+        auto* compound = new btCompoundShape(true, static_cast<int>(hulls.Hulls.size()));
+        for (const std::vector<glm::vec3>& points : hulls.Hulls)
+            compound->addChildShape(btTransform::getIdentity(), createHull(points));
+        return compound;
+    }
+
+    void CollisionShapeCache::DestroyShape(btCollisionShape* shape)
+    {
+        if (shape->getShapeType() == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE)
+        {
+            auto* scaledShape = static_cast<btScaledBvhTriangleMeshShape*>(shape);
+            TriangleMeshCache::Release(scaledShape->getChildShape());
+        }
+        else if (shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE)
+        {
+            // Only hull compounds are cached and they own their children
+            auto* compound = static_cast<btCompoundShape*>(shape);
+            for (int i = compound->getNumChildShapes() - 1; i >= 0; --i)
+                delete compound->getChildShape(i);
+        }
+
+        delete shape;
+    }
+
+} // namespace Coffee
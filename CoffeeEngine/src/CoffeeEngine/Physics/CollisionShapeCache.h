@@ -0,0 +1,97 @@
+/**
+ * @file CollisionShapeCache.h
+ * @brief Declares the CollisionShapeCache class that shares collision shapes between bodies.
+ */
+
+#pragma once
+
+#include "Collider.h"
+#include "ConvexHullCache.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+#include <unordered_map>
+
+namespace Coffee
+{
+
+    /**
+     * @class CollisionShapeCache
+     * @brief Reference-counted cache of collision shapes keyed by their configuration.
+     *
+     * Bodies with the same shape type, dimensions and scale share a single btCollisionShape,
+     * which is deleted when the last body using it releases it. Mesh shapes are keyed by mesh
+     * UUID and wrap the unscaled BVH shape of TriangleMeshCache, so every scale shares one tree.
+     * Convex hull shapes are built from the hulls ConvexHullCache cooked for the mesh.
+     */
+    class CollisionShapeCache
+    {
+      public:
+        /**
+         * @brief Gets a shape matching the configuration, creating it if needed, and adds a reference to it.
+         * @param config The collision shape configuration.
+         * @param scale The local scaling of the shape.
+         * @return Pointer to the shared collision shape.
+         */
+        static btCollisionShape* Acquire(const CollisionShapeConfig& config, const glm::vec3& scale = glm::vec3(1.0f));
+
+        /**
+         * @brief Adds a reference to a shape returned by Acquire, shapes not owned by the cache are ignored.
+         * @param shape The shape to retain.
+         */
+        static void Retain(btCollisionShape* shape);
+
+        /**
+         * @brief Removes a reference from a shape and deletes it when unused, shapes not owned by the cache are ignored.
+         * @param shape The shape to release.
+         */
+        static void Release(btCollisionShape* shape);
+
+        /** @brief Deletes every cached shape regardless of its references. */
+        static void Clear();
+
+        /** @brief Gets the number of distinct shapes alive in the cache. */
+        static size_t GetShapeCount() { return s_Shapes.size(); }
+
+      private:
+        /**
+         * @struct ShapeKey
+         * @brief The part of a shape configuration that defines its geometry.
+         */
+        struct ShapeKey
+        {
+            CollisionShapeType Type;
+            glm::vec3 Size;
+            float Radius;
+            float Height;
+            glm::vec3 Scale;
+            uint64_t Mesh; ///< UUID of the mesh of MESH and CONVEX_HULL shapes, 0 otherwise.
+
+            bool operator==(const ShapeKey& other) const = default;
+        };
+
+        /** @brief Hashes a ShapeKey. */
+        struct ShapeKeyHash
+        {
+            size_t operator()(const ShapeKey& key) const;
+        };
+
+        /** @brief A cached shape and the number of users holding it. */
+        struct Entry
+        {
+            btCollisionShape* Shape = nullptr;
+            uint32_t References = 0;
+        };
+
+        /** @brief Creates the Bullet shape described by the configuration. */
+        static btCollisionShape* CreateShape(const CollisionShapeConfig& config);
+        /** @brief Creates a hull, or a compound of hulls, from the cooked hulls of a mesh. */
+        static btCollisionShape* CreateHullShape(const ConvexHullSet& hulls);
+        /** @brief Deletes a shape created by CreateShape. */
+        static void DestroyShape(btCollisionShape* shape);
+
+        static std::unordered_map<ShapeKey, Entry, ShapeKeyHash> s_Shapes; ///< Cached shapes by geometry.
+        static std::unordered_map<btCollisionShape*, ShapeKey> s_Keys;      ///< Reverse lookup used on release.
+    };
+
+} // namespace Coffee
@@ -0,0 +1,112 @@
+#include "ContactTracker.h"
+
+#include "CollisionCallbacks.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    size_t ContactTracker::ContactPairHash::operator()(const ContactPair& pair) const
+    {
+        const size_t a = std::hash<const void*>()(pair.ObjectA);
+        const size_t b = std::hash<const void*>()(pair.ObjectB);
+        return a ^ (b + 0x9e3779b9 + (a << 6) + (a >> 2));
+    }
+
+    /** @brief Checks if either object of the pair has a stay callback, other pairs get no Stay events. */
+    static bool WantsStay(const btCollisionObject* objA, const btCollisionObject* objB)
+    {
+        const auto* callbacksA = static_cast<const CollisionCallbacks*>(objA->getUserPointer());
+        const auto* callbacksB = static_cast<const CollisionCallbacks*>(objB->getUserPointer());
+        return (callbacksA && callbacksA->m_OnContactStay) || (callbacksB && callbacksB->m_OnContactStay);
+    }
+
+    void ContactTracker::Update(btDispatcher* dispatcher, std::vector<ContactEvent>& events)
+    {
+        ZoneScoped;
+
+        m_Current.clear();
+
+        const int numManifolds = dispatcher->getNumManifolds();
+        for (int i = 0; i < numManifolds; ++i)
+        {
+            const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+            if (manifold->getNumContacts() == 0)
+                continue;
+
+            const btCollisionObject* objA = manifold->getBody0();
+            const btCollisionObject* objB = manifold->getBody1();
+            if (objB < objA)
+                std::swap(objA, objB);
+
+            // Compound shapes can produce several manifolds for the same pair
+            if (!m_Current.insert({objA, objB}).second)
+                continue;
+
+            const bool wasTouching = m_Previous.erase({objA, objB}) > 0;
+            if (!wasTouching)
+                events.push_back({objA, objB, ContactEvent::Type::Enter});
+            else if (WantsStay(objA, objB))
+                events.push_back({objA, objB, ContactEvent::Type::Stay});
+        }
+
+        // Whatever is left from the previous tick is no longer touching. The set iterates in hash order,
+        // the pairs are sorted by their position in the world so exits come out in the same order every run.
+        m_Exits.assign(m_Previous.begin(), m_Previous.end());
+        std::sort(m_Exits.begin(), m_Exits.end(), [](const ContactPair& lhs, const ContactPair& rhs) {
+            const int a0 = lhs.ObjectA->getWorldArrayIndex(), a1 = lhs.ObjectB->getWorldArrayIndex();
+            const int b0 = rhs.ObjectA->getWorldArrayIndex(), b1 = rhs.ObjectB->getWorldArrayIndex();
+            return std::minmax(a0, a1) < std::minmax(b0, b1);
+        });
+        for (const ContactPair& pair : m_Exits)
+            events.push_back({pair.ObjectA, pair.ObjectB, ContactEvent::Type::Exit});
+
+        std::swap(m_Previous, m_Current);
+    }
+
+    void ContactTracker::RemoveObject(const btCollisionObject* object)
+    {
+        std::erase_if(m_Previous, [object](const ContactPair& pair) {
+            return pair.ObjectA == object || pair.ObjectB == object;
+        });
+    }
+
+    void ContactTracker::RemoveObjects(const std::unordered_set<const btCollisionObject*>& objects)
+    {
+        std::erase_if(m_Previous, [&objects](const ContactPair& pair) {
+            return objects.contains(pair.ObjectA) || objects.contains(pair.ObjectB);
+        });
+    }
+
+    void ContactTracker::Clear()
+    {
+        m_Previous.clear();
+        m_Current.clear();
+        m_Exits.clear();
+    }
+
+    void ContactTracker::Rebuild(btDispatcher* dispatcher)
+    {
+        Clear();
+
+        const int numManifolds = dispatcher->getNumManifolds();
+        for (int i = 0; i < numManifolds; ++i)
+        {
+            const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+            if (manifold->getNumContacts() == 0)
+                continue;
+
+            const btCollisionObject* objA = manifold->getBody0();
+            const btCollisionObject* objB = manifold->getBody1();
+            if (objB < objA)
+                std::swap(objA, objB);
+
+            m_Previous.insert({objA, objB});
+        }
+    }
+
+} // namespace Coffee
@@ -0,0 +1,91 @@
+/**
+ * @file ContactTracker.h
+ * @brief Declares the ContactTracker class that turns Bullet manifolds into contact events.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @struct ContactEvent
+     * @brief A change in the contact state of two collision objects.
+     */
+    struct ContactEvent
+    {
+        /**
+         * @enum Type
+         * @brief Kind of contact change.
+         */
+        enum class Type : uint8_t
+        {
+            Enter,        ///< The objects started touching this tick.
+            Stay,         ///< The objects were already touching and still are, only for objects with a stay callback.
+            Exit,         ///< The objects stopped touching this tick.
+            ProjectileHit ///< A projectile hit ObjectA this tick, ObjectB is null.
+        };
+
+        const btCollisionObject* ObjectA; ///< First object of the pair.
+        const btCollisionObject* ObjectB; ///< Second object of the pair.
+        Type type;                        ///< Kind of change.
+        uint32_t Hit = 0;                 ///< Index of the ProjectileHit of the same tick buffer, for ProjectileHit events.
+    };
+
+    /**
+     * @class ContactTracker
+     * @brief Keeps the set of touching pairs between ticks and diffs it against the current manifolds.
+     */
+    class ContactTracker
+    {
+      public:
+        /**
+         * @brief Reads the manifolds of the last tick and appends one event per touching or separated pair.
+         * @param dispatcher The dispatcher holding the manifolds.
+         * @param events Buffer the events are appended to.
+         */
+        void Update(btDispatcher* dispatcher, std::vector<ContactEvent>& events);
+
+        /** @brief Forgets every pair involving the object, no exit event is generated. */
+        void RemoveObject(const btCollisionObject* object);
+
+        /** @brief Forgets every pair involving any of the objects in a single pass. */
+        void RemoveObjects(const std::unordered_set<const btCollisionObject*>& objects);
+
+        /** @brief Forgets every pair. */
+        void Clear();
+
+        /**
+         * @brief Replaces the tracked pairs with the touching pairs of the current manifolds, no event is generated.
+         * @param dispatcher The dispatcher holding the manifolds.
+         */
+        void Rebuild(btDispatcher* dispatcher);
+
+      private:
+        /** @brief Unordered pair of objects, stored with the lower address first. */
+        struct ContactPair
+        {
+            const btCollisionObject* ObjectA;
+            const btCollisionObject* ObjectB;
+
+            bool operator==(const ContactPair& other) const = default;
+        };
+
+        /** @brief Hashes a ContactPair. */
+        struct ContactPairHash
+        {
+            size_t operator()(const ContactPair& pair) const;
+        };
+
+        std::unordered_set<ContactPair, ContactPairHash> m_Previous; ///< Pairs touching in the previous tick.
+        std::unordered_set<ContactPair, ContactPairHash> m_Current;  ///< Pairs touching in the current tick.
+        std::vector<ContactPair> m_Exits;                            ///< Scratch list sorting the separated pairs.
+    };
+
+} // namespace Coffee
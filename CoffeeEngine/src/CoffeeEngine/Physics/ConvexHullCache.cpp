@@ -0,0 +1,279 @@
+#include "ConvexHullCache.h"
+#include "PhysUtils.h"
+#include "PhysicsEngine.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <LinearMath/btConvexHullComputer.h>
+#include <cereal/archives/binary.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr float kSplitVolumeRatio = 0.85f; ///< A split is kept when the halves fill less than this much of the hull.
+        constexpr size_t kMinPieceTriangles = 8;   ///< Pieces with fewer triangles are never split.
+
+        /**
+         * @struct HullPiece
+         * @brief A group of mesh triangles and the convex hull around them.
+         */
+        struct HullPiece
+        {
+            std::vector<uint32_t> Triangles;
+            std::vector<glm::vec3> Vertices; ///< Vertices of the exact hull.
+            float Volume = 0.0f;
+        };
+
+        float GetHullVolume(const btConvexHullComputer& hull)
+        {
+            // Fan every face from its first vertex and sum the signed tetrahedra against the origin
+            btScalar volume = 0;
+            for (int f = 0; f < hull.faces.size(); ++f)
+            {
+                const btConvexHullComputer::Edge* first = &hull.edges[hull.faces[f]];
+                const btVector3& a = hull.vertices[first->getSourceVertex()];
+
+                const btConvexHullComputer::Edge* edge = first->getNextEdgeOfFace();
+                while (edge->getTargetVertex() != first->getSourceVertex())
+                {
+                    const btVector3& b = hull.vertices[edge->getSourceVertex()];
+                    const btVector3& c = hull.vertices[edge->getTargetVertex()];
+                    volume += a.dot(b.cross(c));
+                    edge = edge->getNextEdgeOfFace();
+                }
+            }
+            return static_cast<float>(btFabs(volume) / btScalar(6));
+        }
+
+        void ComputeHull(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, HullPiece& piece)
+        {
+            std::vector<float> points;
+            points.reserve(piece.Triangles.size() * 9);
+            for (uint32_t triangle : piece.Triangles)
+            {
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const glm::vec3& position = vertices[indices[triangle * 3 + corner]].Position;
+                    points.insert(points.end(), {position.x, position.y, position.z});
+                }
+            }
+
+            btConvexHullComputer hull;
+            hull.compute(points.data(), 3 * sizeof(float), static_cast<int>(points.size() / 3), 0.0f, 0.0f);
+
+            piece.Vertices.clear();
+            piece.Vertices.reserve(hull.vertices.size());
+            for (int i = 0; i < hull.vertices.size(); ++i)
+                piece.Vertices.push_back(PhysUtils::BulletToGlm(hull.vertices[i]));
+            piece.Volume = GetHullVolume(hull);
+        }
+
+        /** @brief Splits the triangles of a piece at the median of their centroids along the longest axis. */
+        void SplitPiece(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                        const HullPiece& piece, HullPiece& left, HullPiece& right)
+        {
+            glm::vec3 min(FLT_MAX);
+            glm::vec3 max(-FLT_MAX);
+            for (const glm::vec3& vertex : piece.Vertices)
+            {
+                min = glm::min(min, vertex);
+                max = glm::max(max, vertex);
+            }
+
+            const glm::vec3 extent = max - min;
+            const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+            auto centroid = [&](uint32_t triangle) {
+                return vertices[indices[triangle * 3]].Position[axis] + vertices[indices[triangle * 3 + 1]].Position[axis] +
+                       vertices[indices[triangle * 3 + 2]].Position[axis];
+            };
+
+            std::vector<uint32_t> triangles = piece.Triangles;
+            auto middle = triangles.begin() + triangles.size() / 2;
+            std::nth_element(triangles.begin(), middle, triangles.end(),
+                             [&](uint32_t a, uint32_t b) { return centroid(a) < centroid(b); });
+
+            left.Triangles.assign(triangles.begin(), middle);
+            right.Triangles.assign(middle, triangles.end());
+            ComputeHull(vertices, indices, left);
+            ComputeHull(vertices, indices, right);
+        }
+
+        /** @brief Keeps the extreme points of a hull along evenly spread directions. */
+        std::vector<glm::vec3> SimplifyHull(const std::vector<glm::vec3>& hull, int maxVertices)
+        {
+            if (static_cast<int>(hull.size()) <= maxVertices)
+                return hull;
+
+            std::vector<bool> kept(hull.size(), false);
+            std::vector<glm::vec3> points;
+            points.reserve(maxVertices);
+
+            // Fibonacci sphere, directions spaced evenly without clustering at the poles
+            const float goldenAngle = 2.39996323f;
+            for (int i = 0; i < maxVertices; ++i)
+            {
+                const float y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(maxVertices);
+                const float radius = std::sqrt(std::max(0.0f, 1.0f - y * y));
+                const glm::vec3 direction(std::cos(goldenAngle * i) * radius, y, std::sin(goldenAngle * i) * radius);
+
+                size_t best = 0;
+                float bestDistance = -FLT_MAX;
+                for (size_t v = 0; v < hull.size(); ++v)
+                {
+                    const float distance = glm::dot(hull[v], direction);
+                    if (distance > bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = v;
+                    }
+                }
+
+                if (!kept[best])
+                {
+                    kept[best] = true;
+                    points.push_back(hull[best]);
+                }
+            }
+            return points;
+        }
+    }
+
+    std::unordered_map<uint64_t, ConvexHullCache::Entry> ConvexHullCache::s_Hulls;
+
+    const ConvexHullSet* ConvexHullCache::Get(const Ref<Mesh>& mesh)
+    {
+        if (!mesh || mesh->GetIndices().size() < 3 || mesh->GetVertices().empty())
+            return nullptr;
+
+        const PhysicsSettings& settings = PhysicsEngine::GetSettings();
+        const int maxVertices = std::clamp(settings.HullMaxVertices, 4, 255);
+        const int maxPieces = std::clamp(settings.HullMaxPieces, 1, 64);
+        const uint64_t uuid = mesh->GetUUID();
+
+        // The geometry of a mesh object never changes, hulls checked against it only depend on the limits
+        auto it = s_Hulls.find(uuid);
+        if (it != s_Hulls.end() && it->second.Source.lock() == mesh && it->second.Hulls.MaxVertices == maxVertices &&
+            it->second.Hulls.MaxPieces == maxPieces)
+            return it->second.Hulls.Hulls.empty() ? nullptr : &it->second.Hulls;
+
+        ZoneScoped;
+
+        // A reimported mesh keeps its UUID, so the geometry hash is what tells the hulls are stale
+        const uint64_t hash = PhysUtils::HashMeshGeometry(*mesh);
+
+        const std::filesystem::path path = GetHullPath(uuid);
+
+        ConvexHullSet hulls;
+        if (std::filesystem::exists(path))
+        {
+            try
+            {
+                std::ifstream file(path, std::ios::binary);
+                cereal::BinaryInputArchive archive(file);
+                archive(hulls);
+            }
+            catch (const cereal::Exception&)
+            {
+                hulls = ConvexHullSet();
+            }
+        }
+
+        if (hulls.Hulls.empty() || hulls.MeshHash != hash || hulls.MaxVertices != maxVertices ||
+            hulls.MaxPieces != maxPieces)
+        {
+            hulls = Build(*mesh, maxVertices, maxPieces);
+            hulls.MeshHash = hash;
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            cereal::BinaryOutputArchive archive(file);
+            archive(hulls);
+
+            COFFEE_CORE_INFO("ConvexHullCache: Built {0} hull(s) for mesh {1}", hulls.Hulls.size(), mesh->GetName());
+        }
+
+        // Flat or degenerate meshes keep an empty set so they are not rebuilt on every call
+        Entry& stored = s_Hulls[uuid];
+        stored.Hulls = std::move(hulls);
+        stored.Source = mesh;
+        return stored.Hulls.Hulls.empty() ? nullptr : &stored.Hulls;
+    }
+
+    ConvexHullSet ConvexHullCache::Build(const Mesh& mesh, int maxVertices, int maxPieces)
+    {
+        ZoneScoped;
+
+        const std::vector<Vertex>& vertices = mesh.GetVertices();
+        const std::vector<uint32_t>& indices = mesh.GetIndices();
+
+        ConvexHullSet result;
+        result.MaxVertices = maxVertices;
+        result.MaxPieces = maxPieces;
+
+        HullPiece whole;
+        whole.Triangles.resize(indices.size() / 3);
+        for (uint32_t i = 0; i < whole.Triangles.size(); ++i)
+            whole.Triangles[i] = i;
+        ComputeHull(vertices, indices, whole);
+
+        std::vector<HullPiece> open;
+        std::vector<HullPiece> done;
+        open.push_back(std::move(whole));
+
+        while (!open.empty())
+        {
+            // Largest pieces first so the piece budget goes where the fit improves most
+            auto largest = std::max_element(open.begin(), open.end(),
+                                            [](const HullPiece& a, const HullPiece& b) { return a.Volume < b.Volume; });
+            HullPiece piece = std::move(*largest);
+            open.erase(largest);
+
+            const bool canSplit = done.size() + open.size() + 2 <= static_cast<size_t>(maxPieces) &&
+                                  piece.Triangles.size() >= kMinPieceTriangles && piece.Volume > 0.0f;
+            if (!canSplit)
+            {
+                done.push_back(std::move(piece));
+                continue;
+            }
+
+            HullPiece left;
+            HullPiece right;
+            SplitPiece(vertices, indices, piece, left, right);
+
+            // Halves that still fill the hull mean the piece is close to convex already
+            if (left.Volume + right.Volume < piece.Volume * kSplitVolumeRatio)
+            {
+                open.push_back(std::move(left));
+                open.push_back(std::move(right));
+            }
+            else
+            {
+                done.push_back(std::move(piece));
+            }
+        }
+
+        for (const HullPiece& piece : done)
+        {
+            if (!piece.Vertices.empty())
+                result.Hulls.push_back(SimplifyHull(piece.Vertices, maxVertices));
+        }
+
+        return result;
+    }
+
+    std::filesystem::path ConvexHullCache::GetHullPath(uint64_t uuid)
+    {
+        return CacheManager::GetCachedFilePath(std::to_string(uuid) + "_hull");
+    }
+
+} // namespace Coffee
@@ -0,0 +1,97 @@
+/**
+ * @file ConvexHullCache.h
+ * @brief Declares the convex hulls generated from meshes for dynamic colliders.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee
+{
+
+    class Mesh;
+
+    /**
+     * @struct ConvexHullSet
+     * @brief Simplified convex pieces approximating a mesh, a single hull when the mesh is close to convex.
+     */
+    struct ConvexHullSet
+    {
+        std::vector<std::vector<glm::vec3>> Hulls; ///< Points of each hull in mesh space.
+        uint64_t MeshHash = 0;                     ///< Hash of the mesh geometry the hulls were built from.
+        int MaxVertices = 0;                       ///< Vertex cap the hulls were built with.
+        int MaxPieces = 0;                         ///< Piece cap the hulls were built with.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Hulls", Hulls), cereal::make_nvp("MeshHash", MeshHash),
+                    cereal::make_nvp("MaxVertices", MaxVertices), cereal::make_nvp("MaxPieces", MaxPieces));
+        }
+    };
+
+    /**
+     * @class ConvexHullCache
+     * @brief Builds convex hulls from meshes and keeps them in memory and in the resource cache.
+     *
+     * Meshes are cooked when they are imported, so loading a scene only reads the hulls from the
+     * resource cache. A hull set is rebuilt when the mesh geometry or the hull limits in
+     * PhysicsSettings change. Hulls are in mesh space, the collider scale is applied to the shape.
+     */
+    class ConvexHullCache
+    {
+      public:
+        /**
+         * @brief Gets the hulls of a mesh, loading them from the resource cache or building them if needed.
+         * @param mesh The mesh to approximate.
+         * @return The hulls, nullptr if the mesh has no triangles.
+         */
+        static const ConvexHullSet* Get(const Ref<Mesh>& mesh);
+
+        /**
+         * @brief Builds the hulls of a newly imported mesh and writes them to the resource cache.
+         * @param mesh The imported mesh.
+         */
+        static void Cook(const Ref<Mesh>& mesh) { Get(mesh); }
+
+        /**
+         * @brief Approximates a mesh with convex pieces.
+         *
+         * The mesh is split in two along its longest axis while the pieces fill noticeably less
+         * volume than the hull of the whole, up to maxPieces pieces. Each piece is reduced to at
+         * most maxVertices points by keeping the extreme points along evenly spread directions.
+         * @param mesh The mesh to approximate.
+         * @param maxVertices Maximum points per hull.
+         * @param maxPieces Maximum number of hulls, 1 disables the decomposition.
+         */
+        static ConvexHullSet Build(const Mesh& mesh, int maxVertices, int maxPieces);
+
+        /** @brief Drops the hulls kept in memory, the resource cache is left untouched. */
+        static void Clear() { s_Hulls.clear(); }
+
+      private:
+        /** @brief Hulls kept in memory for a mesh. */
+        struct Entry
+        {
+            ConvexHullSet Hulls;
+            std::weak_ptr<Mesh> Source; ///< Mesh the hulls were checked against, its geometry is hashed once.
+        };
+
+        /** @brief Gets the cache file of a mesh's hulls. */
+        static std::filesystem::path GetHullPath(uint64_t uuid);
+
+        static std::unordered_map<uint64_t, Entry> s_Hulls; ///< Hulls by mesh UUID.
+    };
+
+} // namespace Coffee
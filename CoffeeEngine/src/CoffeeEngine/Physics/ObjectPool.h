@@ -0,0 +1,106 @@
+/**
+ * @file ObjectPool.h
+ * @brief Declares the ObjectPool class template used for frequently created physics objects.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @class ObjectPool
+     * @brief Typed pool that hands out objects from fixed-size chunks through an intrusive free list.
+     *
+     * Chunks are only freed when the pool is destroyed, so creating and destroying objects after
+     * warm-up never reaches the global heap.
+     * @tparam T The pooled type.
+     * @tparam ChunkSize Number of objects allocated per chunk.
+     */
+    template <typename T, size_t ChunkSize = 256> class ObjectPool
+    {
+      public:
+        ObjectPool() = default;
+        ObjectPool(const ObjectPool&) = delete;
+        ObjectPool& operator=(const ObjectPool&) = delete;
+
+        /**
+         * @brief Constructs an object in a free slot.
+         * @param args Arguments forwarded to the constructor of T.
+         * @return Pointer to the new object.
+         */
+        template <typename... Args> T* Create(Args&&... args)
+        {
+            if (!m_FreeList)
+                AllocateChunk();
+
+            Slot* slot = m_FreeList;
+            m_FreeList = slot->Next;
+
+            T* object = ::new (static_cast<void*>(slot->Storage)) T(std::forward<Args>(args)...);
+
+            if (++m_LiveCount > m_HighWaterMark)
+                m_HighWaterMark = m_LiveCount;
+
+            return object;
+        }
+
+        /**
+         * @brief Destroys an object created by this pool and returns its slot to the free list.
+         * @param object The object to destroy, may be null.
+         */
+        void Destroy(T* object)
+        {
+            if (!object)
+                return;
+
+            object->~T();
+
+            Slot* slot = reinterpret_cast<Slot*>(object);
+            slot->Next = m_FreeList;
+            m_FreeList = slot;
+
+            --m_LiveCount;
+        }
+
+        /** @brief Gets the number of objects currently alive. */
+        size_t GetLiveCount() const { return m_LiveCount; }
+        /** @brief Gets the highest number of objects alive at once since the last reset. */
+        size_t GetHighWaterMark() const { return m_HighWaterMark; }
+        /** @brief Gets the number of slots allocated. */
+        size_t GetCapacity() const { return m_Chunks.size() * ChunkSize; }
+        /** @brief Restarts high-water tracking from the current live count. */
+        void ResetHighWaterMark() { m_HighWaterMark = m_LiveCount; }
+
+      private:
+        union Slot
+        {
+            Slot* Next;
+            alignas(T) unsigned char Storage[sizeof(T)];
+        };
+
+        void AllocateChunk()
+        {
+            m_Chunks.push_back(std::make_unique<Slot[]>(ChunkSize));
+            Slot* chunk = m_Chunks.back().get();
+
+            for (size_t i = 0; i < ChunkSize; ++i)
+            {
+                chunk[i].Next = m_FreeList;
+                m_FreeList = &chunk[i];
+            }
+        }
+
+        std::vector<std::unique_ptr<Slot[]>> m_Chunks; ///< Backing storage.
+        Slot* m_FreeList = nullptr;                    ///< Next free slot.
+        size_t m_LiveCount = 0;                        ///< Objects currently alive.
+        size_t m_HighWaterMark = 0;                    ///< Peak of m_LiveCount.
+    };
+
+} // namespace Coffee
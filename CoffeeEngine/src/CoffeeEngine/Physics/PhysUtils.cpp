@@ -1,4 +1,5 @@
 #include "PhysUtils.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
 
 #include <LinearMath/btTransform.h>
 #include <glm/fwd.hpp>
@@ -30,4 +31,26 @@ namespace Coffee {
         return m;
     }
 
+    uint64_t PhysUtils::HashMeshGeometry(const Mesh& mesh)
+    {
+        // FNV-1a over the data collision shapes are built from
+        uint64_t hash = 14695981039346656037ull;
+        auto combine = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        for (const Vertex& vertex : mesh.GetVertices())
+            combine(&vertex.Position, sizeof(vertex.Position));
+
+        const std::vector<uint32_t>& indices = mesh.GetIndices();
+        combine(indices.data(), indices.size() * sizeof(uint32_t));
+
+        return hash;
+    }
+
 } // Coffee
\ No newline at end of file
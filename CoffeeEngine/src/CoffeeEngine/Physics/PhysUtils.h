@@ -4,9 +4,13 @@
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstdint>
+
 namespace Coffee
 {
 
+    class Mesh;
+
     class PhysUtils
     {
     public:
@@ -19,6 +23,9 @@ namespace Coffee
 
 
         static glm::mat4 Mat4BulletToGlm(const btTransform& t);
+
+        /** @brief Hashes the positions and indices of a mesh, used to tell stale cached collision data apart. */
+        static uint64_t HashMeshGeometry(const Mesh& mesh);
         
         
     };
@@ -0,0 +1,289 @@
+#include "PhysicsArena.h"
+#include "ObjectPool.h"
+#include "PhysicsMotionState.h"
+
+#include <LinearMath/btAlignedAllocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr size_t kHeaderSize = 16;              ///< Space reserved in front of every block.
+        constexpr size_t kSizeClassGranularity = 16;    ///< Step between size classes.
+        constexpr size_t kMaxSmallSize = 512;           ///< Largest request served from the size classes.
+        constexpr size_t kSizeClassCount = kMaxSmallSize / kSizeClassGranularity;
+        constexpr size_t kChunkSize = 64 * 1024;        ///< Size of the chunks the size classes are carved from.
+        constexpr uint32_t kLargeBlock = UINT32_MAX;    ///< Size class of blocks taken from the global heap.
+
+        struct BlockHeader
+        {
+            uint32_t SizeClass; ///< Size class index, or kLargeBlock.
+            uint32_t Alignment; ///< Alignment the block was allocated with.
+            uint64_t Size;      ///< Requested size in bytes.
+        };
+        static_assert(sizeof(BlockHeader) <= kHeaderSize, "Block header doesn't fit in front of the block");
+
+        struct FreeBlock
+        {
+            FreeBlock* Next;
+        };
+
+        /**
+         * @brief Free lists and chunk of one thread.
+         *
+         * The solver and narrowphase workers of the parallel world allocate at the same time, each
+         * one works on its own lists without locking. A block freed on another thread than the one
+         * that allocated it joins the lists of the freeing thread.
+         */
+        struct ThreadCache
+        {
+            FreeBlock* FreeLists[kSizeClassCount];
+            unsigned char* ChunkCursor;
+            size_t ChunkRemaining;
+        };
+
+        // Trivially destructible, so blocks freed by static destructors after the thread cleanup still land somewhere
+        thread_local ThreadCache t_Cache = {};
+
+        // Lists of threads that exited, picked up by the next thread that runs out of blocks of the class
+        std::mutex s_OrphanMutex;
+        FreeBlock* s_OrphanLists[kSizeClassCount] = {};
+        std::atomic<size_t> s_OrphanBlocks{0};
+
+        std::atomic<size_t> s_ReservedBytes{0};
+        std::atomic<size_t> s_BytesInUse{0};
+        std::atomic<size_t> s_PeakBytes{0};
+
+        /** @brief Hands the free lists of an exiting thread to the orphan lists. */
+        struct ThreadCacheReleaser
+        {
+            bool Registered = false;
+
+            ~ThreadCacheReleaser()
+            {
+                std::lock_guard<std::mutex> lock(s_OrphanMutex);
+                for (size_t sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass)
+                {
+                    while (FreeBlock* block = t_Cache.FreeLists[sizeClass])
+                    {
+                        t_Cache.FreeLists[sizeClass] = block->Next;
+                        block->Next = s_OrphanLists[sizeClass];
+                        s_OrphanLists[sizeClass] = block;
+                        s_OrphanBlocks.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        thread_local ThreadCacheReleaser t_CacheReleaser;
+
+        /** @brief Typed pools of the objects of the current world. */
+        struct WorldPools
+        {
+            ObjectPool<btRigidBody> RigidBodies;
+            ObjectPool<PhysicsMotionState> MotionStates;
+            ObjectPool<btCollisionObject> CollisionObjects;
+        };
+
+        std::unique_ptr<WorldPools> s_Pools;
+
+        void TrackAllocation(size_t size)
+        {
+            const size_t inUse = s_BytesInUse.fetch_add(size, std::memory_order_relaxed) + size;
+
+            size_t peak = s_PeakBytes.load(std::memory_order_relaxed);
+            while (inUse > peak && !s_PeakBytes.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /** @brief Takes a block of a size class when the free list of the thread is empty. */
+        unsigned char* RefillBlock(uint32_t sizeClass, size_t blockSize)
+        {
+            ThreadCache& cache = t_Cache;
+            t_CacheReleaser.Registered = true;
+
+            if (s_OrphanBlocks.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> lock(s_OrphanMutex);
+                if (FreeBlock* block = s_OrphanLists[sizeClass])
+                {
+                    s_OrphanLists[sizeClass] = block->Next;
+                    s_OrphanBlocks.fetch_sub(1, std::memory_order_relaxed);
+                    return reinterpret_cast<unsigned char*>(block) - kHeaderSize;
+                }
+            }
+
+            // The tail of the previous chunk is abandoned, it is smaller than the block anyway
+            if (cache.ChunkRemaining < blockSize)
+            {
+                cache.ChunkCursor =
+                    static_cast<unsigned char*>(::operator new(kChunkSize, std::align_val_t(kHeaderSize)));
+                cache.ChunkRemaining = kChunkSize;
+                s_ReservedBytes.fetch_add(kChunkSize, std::memory_order_relaxed);
+            }
+
+            unsigned char* block = cache.ChunkCursor;
+            cache.ChunkCursor += blockSize;
+            cache.ChunkRemaining -= blockSize;
+            return block;
+        }
+
+        void* ArenaAllocate(size_t size, int alignment)
+        {
+            TrackAllocation(size);
+
+            if (static_cast<size_t>(alignment) <= kHeaderSize && size <= kMaxSmallSize)
+            {
+                const uint32_t sizeClass =
+                    static_cast<uint32_t>((std::max<size_t>(size, 1) - 1) / kSizeClassGranularity);
+                const size_t blockSize = kHeaderSize + (sizeClass + 1) * kSizeClassGranularity;
+
+                unsigned char* block;
+                if (FreeBlock* freeBlock = t_Cache.FreeLists[sizeClass])
+                {
+                    t_Cache.FreeLists[sizeClass] = freeBlock->Next;
+                    block = reinterpret_cast<unsigned char*>(freeBlock) - kHeaderSize;
+                }
+                else
+                {
+                    block = RefillBlock(sizeClass, blockSize);
+                }
+
+                ::new (block) BlockHeader{sizeClass, static_cast<uint32_t>(kHeaderSize), size};
+                return block + kHeaderSize;
+            }
+
+            // Large or over-aligned requests go to the heap with the header right before the block
+            const size_t blockAlignment = std::max<size_t>(static_cast<size_t>(alignment), kHeaderSize);
+            unsigned char* base =
+                static_cast<unsigned char*>(::operator new(size + blockAlignment, std::align_val_t(blockAlignment)));
+            unsigned char* block = base + blockAlignment;
+
+            ::new (block - kHeaderSize) BlockHeader{kLargeBlock, static_cast<uint32_t>(blockAlignment), size};
+            return block;
+        }
+
+        void ArenaFree(void* memory)
+        {
+            if (!memory)
+                return;
+
+            unsigned char* block = static_cast<unsigned char*>(memory);
+            const BlockHeader* header = reinterpret_cast<const BlockHeader*>(block - kHeaderSize);
+
+            s_BytesInUse.fetch_sub(header->Size, std::memory_order_relaxed);
+
+            if (header->SizeClass == kLargeBlock)
+            {
+                const size_t blockAlignment = header->Alignment;
+                ::operator delete(block - blockAlignment, std::align_val_t(blockAlignment));
+                return;
+            }
+
+            FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(block);
+            freeBlock->Next = t_Cache.FreeLists[header->SizeClass];
+            t_Cache.FreeLists[header->SizeClass] = freeBlock;
+        }
+
+        // Installed while static objects are initialized, before any code can allocate through Bullet.
+        // A block from Bullet's default allocator would be misread by ArenaFree.
+        [[maybe_unused]] const bool s_InstalledAtStartup = [] {
+            PhysicsArena::Install();
+            return true;
+        }();
+    } // namespace
+
+    void PhysicsArena::Install()
+    {
+        static bool installed = false;
+        if (installed)
+            return;
+
+        btAlignedAllocSetCustomAligned(ArenaAllocate, ArenaFree);
+        installed = true;
+    }
+
+    void PhysicsArena::Open()
+    {
+        if (!s_Pools)
+            s_Pools = std::make_unique<WorldPools>();
+
+        ResetHighWaterMarks();
+    }
+
+    void PhysicsArena::Release()
+    {
+        s_Pools.reset();
+    }
+
+    btRigidBody* PhysicsArena::CreateRigidBody(const btRigidBody::btRigidBodyConstructionInfo& info)
+    {
+        return s_Pools->RigidBodies.Create(info);
+    }
+
+    PhysicsMotionState* PhysicsArena::CreateMotionState(const btTransform& startTransform)
+    {
+        return s_Pools->MotionStates.Create(startTransform);
+    }
+
+    btCollisionObject* PhysicsArena::CreateCollisionObject()
+    {
+        return s_Pools->CollisionObjects.Create();
+    }
+
+    void PhysicsArena::DestroyMotionState(btMotionState* motionState)
+    {
+        s_Pools->MotionStates.Destroy(static_cast<PhysicsMotionState*>(motionState));
+    }
+
+    void PhysicsArena::DestroyCollisionObject(btCollisionObject* object)
+    {
+        if (btRigidBody* body = btRigidBody::upcast(object))
+            s_Pools->RigidBodies.Destroy(body);
+        else
+            s_Pools->CollisionObjects.Destroy(object);
+    }
+
+    PhysicsArenaStats PhysicsArena::GetStats()
+    {
+        PhysicsArenaStats stats;
+
+        stats.BytesInUse = s_BytesInUse.load(std::memory_order_relaxed);
+        stats.PeakBytes = s_PeakBytes.load(std::memory_order_relaxed);
+        stats.ReservedBytes = s_ReservedBytes.load(std::memory_order_relaxed);
+
+        if (s_Pools)
+        {
+            stats.RigidBodies = s_Pools->RigidBodies.GetLiveCount();
+            stats.PeakRigidBodies = s_Pools->RigidBodies.GetHighWaterMark();
+            stats.MotionStates = s_Pools->MotionStates.GetLiveCount();
+            stats.PeakMotionStates = s_Pools->MotionStates.GetHighWaterMark();
+            stats.CollisionObjects = s_Pools->CollisionObjects.GetLiveCount();
+            stats.PeakCollisionObjects = s_Pools->CollisionObjects.GetHighWaterMark();
+        }
+
+        return stats;
+    }
+
+    void PhysicsArena::ResetHighWaterMarks()
+    {
+        s_PeakBytes.store(s_BytesInUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        if (s_Pools)
+        {
+            s_Pools->RigidBodies.ResetHighWaterMark();
+            s_Pools->MotionStates.ResetHighWaterMark();
+            s_Pools->CollisionObjects.ResetHighWaterMark();
+        }
+    }
+
+} // namespace Coffee
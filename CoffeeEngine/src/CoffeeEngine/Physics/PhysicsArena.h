@@ -0,0 +1,87 @@
+/**
+ * @file PhysicsArena.h
+ * @brief Declares the PhysicsArena class that owns the memory of the physics world.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <cstddef>
+
+namespace Coffee
+{
+
+    class PhysicsMotionState;
+
+    /**
+     * @struct PhysicsArenaStats
+     * @brief Memory usage of the physics arena.
+     */
+    struct PhysicsArenaStats
+    {
+        size_t BytesInUse = 0;       ///< Bytes currently allocated by Bullet.
+        size_t PeakBytes = 0;        ///< High-water mark of BytesInUse.
+        size_t ReservedBytes = 0;    ///< Bytes held in arena chunks for small allocations.
+
+        size_t RigidBodies = 0;          ///< Rigid bodies alive.
+        size_t PeakRigidBodies = 0;      ///< High-water mark of RigidBodies.
+        size_t MotionStates = 0;         ///< Motion states alive.
+        size_t PeakMotionStates = 0;     ///< High-water mark of MotionStates.
+        size_t CollisionObjects = 0;     ///< Plain collision objects alive.
+        size_t PeakCollisionObjects = 0; ///< High-water mark of CollisionObjects.
+    };
+
+    /**
+     * @class PhysicsArena
+     * @brief Memory arena for the physics world.
+     *
+     * Bullet's aligned allocator hooks are routed to size-class free lists carved from large
+     * chunks. The hooks are process-wide, so is this part: it is installed before anything
+     * allocates through Bullet and every thread works on its own free lists, the worker
+     * threads of the parallel world never wait on each other to allocate.
+     *
+     * Rigid bodies, motion states and collision objects come from typed pools owned by the
+     * world, opened with it and released in bulk when it is destroyed. Memory is kept when
+     * objects go away in between, so spawning and despawning bodies or reloading a scene
+     * reuses it instead of going back to the global heap.
+     */
+    class PhysicsArena
+    {
+      public:
+        /** @brief Routes Bullet allocations through the arena, done while static objects are initialized. */
+        static void Install();
+
+        /** @brief Creates the object pools of a new world, called by PhysicsEngine::Init. */
+        static void Open();
+        /**
+         * @brief Frees the object pools of the world in bulk, called by PhysicsEngine::Destroy.
+         *
+         * Objects still in the pools are dropped with them without running their destructors,
+         * the world they were in has to be deleted first.
+         */
+        static void Release();
+
+        /** @brief Creates a rigid body from the body pool. */
+        static btRigidBody* CreateRigidBody(const btRigidBody::btRigidBodyConstructionInfo& info);
+        /** @brief Creates a motion state from the motion state pool. */
+        static PhysicsMotionState* CreateMotionState(const btTransform& startTransform);
+        /** @brief Creates a plain collision object from the collision object pool. */
+        static btCollisionObject* CreateCollisionObject();
+
+        /** @brief Returns a motion state created by CreateMotionState to its pool. */
+        static void DestroyMotionState(btMotionState* motionState);
+        /**
+         * @brief Returns a rigid body or collision object to its pool.
+         *
+         * The motion state of a rigid body is destroyed separately with DestroyMotionState.
+         */
+        static void DestroyCollisionObject(btCollisionObject* object);
+
+        /** @brief Gets the current memory usage and high-water marks. */
+        static PhysicsArenaStats GetStats();
+        /** @brief Restarts every high-water mark from the current usage, called when a new world is created. */
+        static void ResetHighWaterMarks();
+    };
+
+} // namespace Coffee
@@ -0,0 +1,101 @@
+/**
+ * @file PhysicsCommandQueue.h
+ * @brief Declares the commands deferred to the physics thread and the queue that carries them.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Coffee
+{
+
+    /**
+     * @struct PhysicsCommand
+     * @brief A change to a rigid body requested from gameplay code, applied at the start of a tick.
+     */
+    struct PhysicsCommand
+    {
+        /**
+         * @enum Type
+         * @brief The operation to perform on the body.
+         */
+        enum class Type
+        {
+            ApplyForce,         ///< Applies Vector as a force at Point.
+            ApplyImpulse,       ///< Applies Vector as an impulse at Point.
+            SetVelocity,        ///< Sets the linear velocity to Vector.
+            AddVelocity,        ///< Adds Vector to the linear velocity.
+            SetAngularVelocity, ///< Sets the angular velocity to Vector.
+            SetTransform,       ///< Teleports the body to Vector with Rotation.
+            SetWorldTransform,  ///< Sets the body transform to Vector with Rotation, leaving the motion state alone.
+            SetGravity,         ///< Sets the gravity of the body to Vector.
+            SetFriction,        ///< Sets the friction to Scalar.
+            SetRestitution,     ///< Sets the restitution to Scalar.
+            Activate            ///< Wakes the body up, forced if Scalar is not zero.
+        };
+
+        Type type = Type::ApplyForce;          ///< Operation to perform.
+        btRigidBody* body = nullptr;           ///< Target body.
+        btVector3 Vector = btVector3(0, 0, 0); ///< Force, impulse, velocity or position.
+        btVector3 Point = btVector3(0, 0, 0);  ///< Relative application point of forces and impulses.
+        btQuaternion Rotation = btQuaternion::getIdentity(); ///< Rotation used by SetTransform.
+        btScalar Scalar = 0;                   ///< Friction, restitution or forced activation.
+    };
+
+    /**
+     * @class PhysicsCommandQueue
+     * @brief Fixed-size lock-free ring buffer with a single producer and a single consumer.
+     *
+     * The main thread pushes commands while the physics thread is stepping and the physics
+     * thread drains them at the start of the next tick.
+     */
+    class PhysicsCommandQueue
+    {
+      public:
+        static constexpr size_t Capacity = 1024; ///< Number of slots, must be a power of two.
+
+        /**
+         * @brief Pushes a command, only call from the producer thread.
+         * @return false if the queue is full.
+         */
+        bool Push(const PhysicsCommand& command)
+        {
+            const size_t head = m_Head.load(std::memory_order_relaxed);
+            const size_t next = (head + 1) & (Capacity - 1);
+            if (next == m_Tail.load(std::memory_order_acquire))
+                return false;
+
+            m_Commands[head] = command;
+            m_Head.store(next, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Pops the oldest command, only call from the consumer thread.
+         * @return false if the queue is empty.
+         */
+        bool Pop(PhysicsCommand& command)
+        {
+            const size_t tail = m_Tail.load(std::memory_order_relaxed);
+            if (tail == m_Head.load(std::memory_order_acquire))
+                return false;
+
+            command = m_Commands[tail];
+            m_Tail.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+            return true;
+        }
+
+      private:
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        std::array<PhysicsCommand, Capacity> m_Commands;
+        alignas(64) std::atomic<size_t> m_Head{0}; ///< Next slot written by the producer.
+        alignas(64) std::atomic<size_t> m_Tail{0}; ///< Next slot read by the consumer.
+    };
+
+} // namespace Coffee
@@ -0,0 +1,154 @@
+#include "PhysicsDebugDrawer.h"
+#include "PhysUtils.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr btScalar kContactNormalLength = 0.25f; ///< Length of the line drawn along a contact normal.
+    }
+
+    void PhysicsDebugDrawer::Draw(btDynamicsWorld* world, const PhysicsSettings& settings, const Frustum* frustum,
+                                  std::vector<DebugVertex>& lines)
+    {
+        ZoneScoped;
+
+        lines.clear();
+
+        m_Lines = &lines;
+        m_Frustum = frustum;
+        m_MaxVertices = static_cast<size_t>(DebugRenderer::GetMaxLineVertices());
+        m_DebugMode = DBG_NoDebug;
+        if (settings.DebugDrawShapes)
+            m_DebugMode |= DBG_DrawWireframe;
+        if (settings.DebugDrawAabbs)
+            m_DebugMode |= DBG_DrawAabb;
+        if (settings.DebugDrawContacts)
+            m_DebugMode |= DBG_DrawContactPoints;
+        if (settings.DebugDrawConstraints)
+            m_DebugMode |= DBG_DrawConstraints | DBG_DrawConstraintLimits;
+
+        const DefaultColors colors = getDefaultColors();
+
+        if (m_DebugMode & (DBG_DrawWireframe | DBG_DrawAabb))
+        {
+            const btCollisionObjectArray& objects = world->getCollisionObjectArray();
+            for (int i = 0; i < objects.size() && lines.size() < m_MaxVertices; ++i)
+            {
+                const btCollisionObject* object = objects[i];
+                const btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+                if (!proxy || (object->getCollisionFlags() & btCollisionObject::CF_DISABLE_VISUALIZE_OBJECT))
+                    continue;
+
+                // The broadphase AABB is up to date after the step, no need to ask the shape again
+                if (!IsVisible(proxy->m_aabbMin, proxy->m_aabbMax))
+                    continue;
+
+                if (m_DebugMode & DBG_DrawWireframe)
+                {
+                    btVector3 color;
+                    switch (object->getActivationState())
+                    {
+                    case ACTIVE_TAG:
+                        color = colors.m_activeObject;
+                        break;
+                    case ISLAND_SLEEPING:
+                        color = colors.m_deactivatedObject;
+                        break;
+                    case WANTS_DEACTIVATION:
+                        color = colors.m_wantsDeactivationObject;
+                        break;
+                    case DISABLE_DEACTIVATION:
+                        color = colors.m_disabledDeactivationObject;
+                        break;
+                    case DISABLE_SIMULATION:
+                        color = colors.m_disabledSimulationObject;
+                        break;
+                    default:
+                        color = btVector3(1.0f, 0.0f, 0.0f);
+                        break;
+                    }
+                    object->getCustomDebugColor(color);
+
+                    world->debugDrawObject(object->getWorldTransform(), object->getCollisionShape(), color);
+                }
+
+                if (m_DebugMode & DBG_DrawAabb)
+                    drawAabb(proxy->m_aabbMin, proxy->m_aabbMax, colors.m_aabb);
+            }
+        }
+
+        if (m_DebugMode & DBG_DrawContactPoints)
+        {
+            btDispatcher* dispatcher = world->getDispatcher();
+            const int manifoldCount = dispatcher->getNumManifolds();
+            for (int i = 0; i < manifoldCount && lines.size() < m_MaxVertices; ++i)
+            {
+                const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+                for (int j = 0; j < manifold->getNumContacts(); ++j)
+                {
+                    const btManifoldPoint& point = manifold->getContactPoint(j);
+                    const btVector3& position = point.getPositionWorldOnB();
+                    if (IsVisible(position, position))
+                    {
+                        drawContactPoint(position, point.m_normalWorldOnB, point.getDistance(), point.getLifeTime(),
+                                         colors.m_contactPoint);
+                    }
+                }
+            }
+        }
+
+        if (m_DebugMode & DBG_DrawConstraints)
+        {
+            // Every world CreateWorld builds is a btDiscreteDynamicsWorld
+            btDiscreteDynamicsWorld* discreteWorld = static_cast<btDiscreteDynamicsWorld*>(world);
+            for (int i = 0; i < world->getNumConstraints() && lines.size() < m_MaxVertices; ++i)
+            {
+                btTypedConstraint* constraint = world->getConstraint(i);
+                if (IsVisible(constraint->getRigidBodyA()) || IsVisible(constraint->getRigidBodyB()))
+                    discreteWorld->debugDrawConstraint(constraint);
+            }
+        }
+
+        m_Lines = nullptr;
+        m_Frustum = nullptr;
+    }
+
+    void PhysicsDebugDrawer::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
+    {
+        if (m_Lines->size() + 2 > m_MaxVertices)
+            return;
+
+        const glm::vec4 lineColor(color.x(), color.y(), color.z(), 1.0f);
+        m_Lines->push_back({PhysUtils::BulletToGlm(from), lineColor});
+        m_Lines->push_back({PhysUtils::BulletToGlm(to), lineColor});
+    }
+
+    void PhysicsDebugDrawer::drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB, btScalar distance,
+                                              int lifeTime, const btVector3& color)
+    {
+        drawLine(pointOnB, pointOnB + normalOnB * kContactNormalLength, color);
+    }
+
+    void PhysicsDebugDrawer::reportErrorWarning(const char* warningString)
+    {
+        COFFEE_CORE_WARN("Bullet: {0}", warningString);
+    }
+
+    bool PhysicsDebugDrawer::IsVisible(const btVector3& aabbMin, const btVector3& aabbMax) const
+    {
+        return !m_Frustum || m_Frustum->Contains(AABB(PhysUtils::BulletToGlm(aabbMin), PhysUtils::BulletToGlm(aabbMax)));
+    }
+
+    bool PhysicsDebugDrawer::IsVisible(const btRigidBody& body) const
+    {
+        // The fixed body of one-sided constraints is in no broadphase
+        const btBroadphaseProxy* proxy = body.getBroadphaseHandle();
+        return proxy && IsVisible(proxy->m_aabbMin, proxy->m_aabbMax);
+    }
+
+} // namespace Coffee
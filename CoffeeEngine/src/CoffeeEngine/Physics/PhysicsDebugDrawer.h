@@ -0,0 +1,61 @@
+/**
+ * @file PhysicsDebugDrawer.h
+ * @brief Declares the PhysicsDebugDrawer that turns Bullet's debug drawing into DebugRenderer lines.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Math/Frustum.h"
+#include "CoffeeEngine/Renderer/DebugRenderer.h"
+#include "PhysicsSettings.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @class PhysicsDebugDrawer
+     * @brief A btIDebugDraw writing the lines of the objects in view into a vertex buffer.
+     *
+     * Draw walks the world itself instead of calling debugDrawWorld, so objects, contacts and
+     * constraints outside the camera frustum cost an AABB test and nothing else. The lines
+     * land in a plain DebugVertex array that DebugRenderer::DrawLines copies in one go, which
+     * also lets the physics thread fill it while the main thread renders the previous one.
+     */
+    class PhysicsDebugDrawer : public btIDebugDraw
+    {
+      public:
+        /**
+         * @brief Draws the enabled categories of a world.
+         * @param world The world to draw, its debug drawer must be this object.
+         * @param settings Settings holding the category toggles.
+         * @param frustum Objects outside it are skipped, nullptr draws everything.
+         * @param lines Receives the line vertices, cleared first.
+         */
+        void Draw(btDynamicsWorld* world, const PhysicsSettings& settings, const Frustum* frustum,
+                  std::vector<DebugVertex>& lines);
+
+        void drawLine(const btVector3& from, const btVector3& to, const btVector3& color) override;
+        void drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB, btScalar distance, int lifeTime,
+                              const btVector3& color) override;
+        void reportErrorWarning(const char* warningString) override;
+        void draw3dText(const btVector3& location, const char* textString) override {}
+        void setDebugMode(int debugMode) override { m_DebugMode = debugMode; }
+        int getDebugMode() const override { return m_DebugMode; }
+
+      private:
+        /** @brief Checks if a box touches the frustum being drawn. */
+        bool IsVisible(const btVector3& aabbMin, const btVector3& aabbMax) const;
+
+        /** @brief Checks if any part of a rigid body touches the frustum being drawn. */
+        bool IsVisible(const btRigidBody& body) const;
+
+        std::vector<DebugVertex>* m_Lines = nullptr; ///< Buffer of the Draw call in progress.
+        const Frustum* m_Frustum = nullptr;          ///< Frustum of the Draw call in progress.
+        size_t m_MaxVertices = 0;                    ///< Vertices DebugRenderer can take, the rest is dropped.
+        int m_DebugMode = DBG_NoDebug;
+    };
+
+} // namespace Coffee
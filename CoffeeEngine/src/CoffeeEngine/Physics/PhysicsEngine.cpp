@@ -1,15 +1,54 @@
 #include "PhysicsEngine.h"
+#include "CharacterSystem.h"
+#include "CollisionShapeCache.h"
+#include "ConvexHullCache.h"
 #include "PhysUtils.h"
+#include "PhysicsArena.h"
+#include "PhysicsMotionState.h"
+#include "PhysicsProfiler.h"
+#include "PhysicsTelemetry.h"
+#include "ProjectileSystem.h"
+#include "StaticColliderBaker.h"
+#include "VehicleSystem.h"
 
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Scene/Components.h"
 
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
 #include <entt/entity/entity.hpp>
+#include <tracy/Tracy.hpp>
 
 
 namespace Coffee
 {
     std::vector<PhysicsEngine::DebugDrawCommand> PhysicsEngine::debugDrawList;
+
+    namespace
+    {
+        constexpr uint8_t kLodSleepRing = 3;   ///< First LOD ring whose bodies never step.
+        constexpr uint64_t kLodMaxDivisor = 4; ///< Tick divisor of the slowest stepping ring.
+
+        /** @brief Rewrites a contact point for a manifold holding the same bodies in the other order. */
+        void SwapManifoldPoint(btManifoldPoint& point)
+        {
+            std::swap(point.m_localPointA, point.m_localPointB);
+            std::swap(point.m_positionWorldOnA, point.m_positionWorldOnB);
+            std::swap(point.m_partId0, point.m_partId1);
+            std::swap(point.m_index0, point.m_index1);
+            point.m_normalWorldOnB = -point.m_normalWorldOnB;
+            point.m_lateralFrictionDir1 = -point.m_lateralFrictionDir1;
+            point.m_lateralFrictionDir2 = -point.m_lateralFrictionDir2;
+        }
+    } // namespace
     using namespace Coffee;
 
     glm::vec3 PhysicsEngine::GlobalGravity = glm::vec3(0.0f, -9.81f, 0.0f);
@@ -19,158 +58,892 @@ namespace Coffee
     btDispatcher* PhysicsEngine::m_dispatcher = nullptr;
     btBroadphaseInterface* PhysicsEngine::m_broad_phase = nullptr;
     btConstraintSolver* PhysicsEngine::m_solver = nullptr;
+    btConstraintSolver* PhysicsEngine::m_solverMt = nullptr;
+
+    btITaskScheduler* PhysicsEngine::m_TaskScheduler = nullptr;
+    PhysicsSettings PhysicsEngine::m_Settings;
 
     std::vector<btCollisionObject*> PhysicsEngine::m_CollisionObjects;
-    std::vector<btCollisionShape*> PhysicsEngine::m_CollisionShapes;
+    std::vector<PhysicsMotionState*> PhysicsEngine::m_MovedBodies;
+
+    float PhysicsEngine::m_Accumulator = 0.0f;
+    float PhysicsEngine::m_InterpolationAlpha = 0.0f;
+    uint64_t PhysicsEngine::m_TickCount = 0;
+
+    std::vector<PhysicsEngine::LodAnchor> PhysicsEngine::m_LodAnchors;
+    std::vector<btRigidBody*> PhysicsEngine::m_LodScaledBodies;
+    bool PhysicsEngine::m_LodActive = false;
+
+    PhysicsStats PhysicsEngine::m_Stats[2];
+    std::vector<uint32_t> PhysicsEngine::m_IslandBodyCounter;
+
+    std::vector<PhysicsEngine::BodyPose> PhysicsEngine::m_PoseBuffers[2];
+    int PhysicsEngine::m_FrontBuffer = 0;
+
+    ContactTracker PhysicsEngine::m_ContactTracker;
+    std::vector<ContactEvent> PhysicsEngine::m_ContactEvents[2];
+    std::vector<ContactEvent> PhysicsEngine::m_DispatchedEvents;
+    std::vector<ProjectileHit> PhysicsEngine::m_ProjectileHits[2];
+
+    PhysicsDebugDrawer PhysicsEngine::m_DebugDrawer;
+    std::vector<DebugVertex> PhysicsEngine::m_DebugLines[2];
+    std::optional<Frustum> PhysicsEngine::m_NextDebugFrustum;
+    std::optional<Frustum> PhysicsEngine::m_DebugFrustum;
+
+    PhysicsCommandQueue PhysicsEngine::m_Commands;
+
+    int PhysicsEngine::m_BatchDepth = 0;
+    int PhysicsEngine::m_BatchInserted = 0;
+    std::vector<btCollisionObject*> PhysicsEngine::m_PendingDestroys;
+    std::unordered_set<btCollisionShape*> PhysicsEngine::m_OwnedShapes;
+
+    std::thread PhysicsEngine::m_PhysicsThread;
+    std::mutex PhysicsEngine::m_StepMutex;
+    std::condition_variable PhysicsEngine::m_StepCondition;
+    float PhysicsEngine::m_PendingDt = 0.0f;
+    bool PhysicsEngine::m_StepPending = false;
+    bool PhysicsEngine::m_StepFinished = false;
+    bool PhysicsEngine::m_StopThread = false;
     // std::shared_ptr<Scene> PhysicsEngine::m_ActiveScene = nullptr;
 
     void PhysicsEngine::Init()
     {
         COFFEE_CORE_INFO("Initializing Physics Engine");
 
-        m_collision_conf = new btDefaultCollisionConfiguration();
-        m_dispatcher = new btCollisionDispatcher(m_collision_conf);
-        m_broad_phase = new btDbvtBroadphase();
-        m_solver = new btSequentialImpulseConstraintSolver();
+        PhysicsArena::Open();
+        PhysicsProfiler::Install();
+
+        CreateWorld();
+        ReserveProjectiles();
+    }
+
+    void PhysicsEngine::ReserveProjectiles()
+    {
+        const size_t capacity = static_cast<size_t>(m_Settings.MaxProjectiles);
+        ProjectileSystem::Reserve(capacity);
+
+        // Every projectile can hit something on the same tick, the buffers never grow afterwards
+        for (int i = 0; i < 2; ++i)
+        {
+            m_ProjectileHits[i].reserve(capacity);
+            m_ContactEvents[i].reserve(m_ContactEvents[i].size() + capacity);
+        }
+    }
+
+    void PhysicsEngine::CreateWorld()
+    {
+        if (m_Settings.Type == PhysicsType::PARALLEL && !m_TaskScheduler)
+        {
+            // Only available when Bullet is built with BT_THREADSAFE
+            m_TaskScheduler = btCreateDefaultTaskScheduler();
+            if (!m_TaskScheduler)
+                COFFEE_CORE_WARN("Bullet was built without multithreading, falling back to a single-threaded world");
+        }
+
+        if (m_Settings.Type == PhysicsType::PARALLEL && m_TaskScheduler)
+        {
+            int threads = m_Settings.WorkerThreads > 0 ? m_Settings.WorkerThreads : m_TaskScheduler->getMaxNumThreads();
+            m_TaskScheduler->setNumThreads(threads);
+            btSetTaskScheduler(m_TaskScheduler);
+
+            COFFEE_CORE_INFO("Creating parallel physics world with {0} worker threads",
+                             m_TaskScheduler->getNumThreads());
+
+            // Large pools so the parallel narrowphase doesn't fall back to locked heap allocations
+            btDefaultCollisionConstructionInfo constructionInfo;
+            constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+            constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+
+            m_collision_conf = new btDefaultCollisionConfiguration(constructionInfo);
+            m_dispatcher = new btCollisionDispatcherMt(m_collision_conf, 40);
+            m_broad_phase = new btDbvtBroadphase();
+            m_solver = new btConstraintSolverPoolMt(m_TaskScheduler->getMaxNumThreads());
+            m_solverMt = new btSequentialImpulseConstraintSolverMt();
+
+            m_world = new btDiscreteDynamicsWorldMt(m_dispatcher, m_broad_phase,
+                                                    static_cast<btConstraintSolverPoolMt*>(m_solver), m_solverMt,
+                                                    m_collision_conf);
+        }
+        else
+        {
+            m_collision_conf = new btDefaultCollisionConfiguration();
+            m_dispatcher = new btCollisionDispatcher(m_collision_conf);
+            m_broad_phase = new btDbvtBroadphase();
+            m_solver = new btSequentialImpulseConstraintSolver();
 
-        m_world = new btDiscreteDynamicsWorld(m_dispatcher, m_broad_phase, m_solver, m_collision_conf);
+            m_world = new btDiscreteDynamicsWorld(m_dispatcher, m_broad_phase, m_solver, m_collision_conf);
+        }
+
+        m_world->setDebugDrawer(&m_DebugDrawer);
+        VehicleSystem::Install(m_world);
+        CharacterSystem::Install(m_world);
 
         SetGravity(GlobalGravity);
     }
 
+    void PhysicsEngine::DestroyWorld()
+    {
+        delete m_world;
+        delete m_solverMt;
+        delete m_solver;
+        delete m_broad_phase;
+        delete m_dispatcher;
+        delete m_collision_conf;
+
+        m_world = nullptr;
+        m_solverMt = nullptr;
+        m_solver = nullptr;
+        m_broad_phase = nullptr;
+        m_dispatcher = nullptr;
+        m_collision_conf = nullptr;
+    }
+
+    void PhysicsEngine::ApplySettings(const PhysicsSettings& settings)
+    {
+        WaitForStep();
+        if (!settings.AsyncStep)
+            StopPhysicsThread();
+
+        const bool wasParallel = m_Settings.Type == PhysicsType::PARALLEL;
+        const bool isParallel = settings.Type == PhysicsType::PARALLEL;
+        const bool matrixChanged = m_Settings.CollisionMatrix != settings.CollisionMatrix;
+        const bool ccdChanged = (m_Settings.Type == PhysicsType::CONTINUOUS) != (settings.Type == PhysicsType::CONTINUOUS);
+        const bool projectilesChanged = m_Settings.MaxProjectiles != settings.MaxProjectiles;
+
+        m_Settings = settings;
+        m_Settings.TickRate = std::max(m_Settings.TickRate, 1);
+        m_Settings.MaxSubSteps = std::max(m_Settings.MaxSubSteps, 1);
+        m_Settings.LodFullRateRadius = std::max(m_Settings.LodFullRateRadius, 0.0f);
+        m_Settings.LodHalfRateRadius = std::max(m_Settings.LodHalfRateRadius, m_Settings.LodFullRateRadius);
+        m_Settings.LodQuarterRateRadius = std::max(m_Settings.LodQuarterRateRadius, m_Settings.LodHalfRateRadius);
+        m_Settings.MaxProjectiles = std::max(m_Settings.MaxProjectiles, 0);
+
+        if (projectilesChanged)
+            ReserveProjectiles();
+
+        if (!m_world)
+            return;
+
+        if (matrixChanged)
+            RefreshCollisionFilters();
+
+        // Bodies keep their CCD setup if the world is rebuilt below
+        if (ccdChanged)
+            RefreshContinuousCollision();
+
+        if (wasParallel == isParallel)
+        {
+            if (isParallel && m_TaskScheduler)
+            {
+                m_TaskScheduler->setNumThreads(settings.WorkerThreads > 0 ? settings.WorkerThreads
+                                                                          : m_TaskScheduler->getMaxNumThreads());
+            }
+            return;
+        }
+
+        // Move every object and constraint over to a world of the new type
+        struct WorldObject
+        {
+            btCollisionObject* object;
+            int group;
+            int mask;
+        };
+
+        std::vector<WorldObject> objects;
+        objects.reserve(m_world->getNumCollisionObjects());
+        for (int i = m_world->getNumCollisionObjects() - 1; i >= 0; --i)
+        {
+            btCollisionObject* object = m_world->getCollisionObjectArray()[i];
+            btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+            objects.push_back({object, proxy->m_collisionFilterGroup, proxy->m_collisionFilterMask});
+        }
+
+        std::vector<btTypedConstraint*> constraints;
+        constraints.reserve(m_world->getNumConstraints());
+        for (int i = m_world->getNumConstraints() - 1; i >= 0; --i)
+        {
+            constraints.push_back(m_world->getConstraint(i));
+            m_world->removeConstraint(constraints.back());
+        }
+
+        for (auto& entry : objects)
+            m_world->removeCollisionObject(entry.object);
+
+        // Manifolds don't survive the rebuild, start tracking contacts from scratch
+        m_ContactTracker.Clear();
+
+        DestroyWorld();
+        CreateWorld();
+
+        for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+        {
+            if (btRigidBody* body = btRigidBody::upcast(it->object))
+            {
+                // addRigidBody overrides the per-body gravity with the world one
+                btVector3 gravity = body->getGravity();
+                m_world->addRigidBody(body, it->group, it->mask);
+                body->setGravity(gravity);
+            }
+            else
+            {
+                m_world->addCollisionObject(it->object, it->group, it->mask);
+            }
+        }
+
+        for (auto it = constraints.rbegin(); it != constraints.rend(); ++it)
+            m_world->addConstraint(*it, true);
+    }
+
     void PhysicsEngine::Update(float dt)
     {
         if (m_world)
         {
-            m_world->stepSimulation(dt, 10);
-            m_world->debugDrawWorld();
+            ZoneScoped;
+
+            ExecuteCommands();
 
-            // Debug print positions of all rigidbodies
-            int numCollisionObjects = m_world->getNumCollisionObjects();
-            for (int i = 0; i < numCollisionObjects; i++) 
+            std::vector<ContactEvent>& contactEvents = m_ContactEvents[1 - m_FrontBuffer];
+            contactEvents.clear();
+            std::vector<ProjectileHit>& projectileHits = m_ProjectileHits[1 - m_FrontBuffer];
+            projectileHits.clear();
+
+            // Bodies that came to rest got their final pose written back last frame
+            for (size_t i = 0; i < m_MovedBodies.size();)
             {
-                btCollisionObject* obj = m_world->getCollisionObjectArray()[i];
-                btRigidBody* body = btRigidBody::upcast(obj);
-                
-                if (body && body->getMotionState())
+                PhysicsMotionState* state = m_MovedBodies[i];
+                if (state->m_PreviousTransform == state->m_Transform)
                 {
-                    btTransform trans;
-                    body->getMotionState()->getWorldTransform(trans);
-                    btVector3 pos = trans.getOrigin();
-                    COFFEE_CORE_INFO("Rigidbody {0} position: ({1}, {2}, {3})", 
-                        i, pos.x(), pos.y(), pos.z());
+                    state->m_Moved = false;
+                    m_MovedBodies[i] = m_MovedBodies.back();
+                    m_MovedBodies.pop_back();
                 }
+                else
+                {
+                    ++i;
+                }
+            }
+
+            PhysicsStats& stats = m_Stats[1 - m_FrontBuffer];
+            stats.Ticks = 0;
+            stats.StepMicroseconds = 0.0f;
+            PhysicsProfiler::Reset();
+
+            const float fixedTimeStep = m_Settings.GetFixedTimeStep();
+
+            const bool useLod = m_Settings.LodEnabled && !m_LodAnchors.empty();
+            if (!useLod && m_LodActive)
+                ReleaseLod();
+
+            // Drop the time we can't catch up with instead of falling further behind every frame
+            m_Accumulator = std::min(m_Accumulator + dt, fixedTimeStep * m_Settings.MaxSubSteps);
+
+            while (m_Accumulator >= fixedTimeStep)
+            {
+                for (PhysicsMotionState* state : m_MovedBodies)
+                    state->m_PreviousTransform = state->m_Transform;
+
+                if (useLod)
+                    ApplyLod(m_TickCount);
+
+                // Substepping is done here, so Bullet runs exactly one step of the given size
+                const auto stepStart = std::chrono::steady_clock::now();
+                m_world->stepSimulation(fixedTimeStep, 0);
+                const auto stepEnd = std::chrono::steady_clock::now();
+
+                if (useLod)
+                    FinishLodStep();
+                m_Accumulator -= fixedTimeStep;
+
+                m_ContactTracker.Update(m_dispatcher, contactEvents);
+                ProjectileSystem::Step(m_world, fixedTimeStep, projectileHits, contactEvents);
+
+                const float stepTimeMs = std::chrono::duration<float, std::milli>(stepEnd - stepStart).count();
+                RecordTelemetry(stepTimeMs);
+
+                ++stats.Ticks;
+                stats.StepMicroseconds += stepTimeMs * 1000.0f;
+            }
+
+            PhysicsProfiler::Collect(stats.PhaseMicroseconds);
+            if (stats.Ticks > 0)
+            {
+                CountIslands(stats);
             }
+            else
+            {
+                // No tick ran, the islands are still the ones of the last update
+                stats.Islands = m_Stats[m_FrontBuffer].Islands;
+                stats.IslandBodyCounts = m_Stats[m_FrontBuffer].IslandBodyCounts;
+            }
+
+            m_InterpolationAlpha = m_Accumulator / fixedTimeStep;
+
+            PublishPoses();
+            ProjectileSystem::Publish(1 - m_FrontBuffer);
+
+            // Drawn by the step itself, the main thread can't walk the world while it runs
+            std::vector<DebugVertex>& debugLines = m_DebugLines[1 - m_FrontBuffer];
+            if (m_Settings.DebugDrawEnabled)
+                m_DebugDrawer.Draw(m_world, m_Settings, m_DebugFrustum ? &*m_DebugFrustum : nullptr, debugLines);
+            else
+                debugLines.clear();
         }
+    }
+
+    void PhysicsEngine::BuildRigidbodyBatch(entt::registry& registry, RigidbodyBatch& batch)
+    {
+        ZoneScoped;
 
-      
+        batch.Clear();
 
-        /*if (debugDrawList.empty())
-            return;
-        for (const auto& cmd : debugDrawList)
+        auto view = registry.view<RigidbodyComponent, TransformComponent>();
+        for (auto entity : view)
         {
-            switch (cmd.type)
+            auto& rigidbodyComponent = view.get<RigidbodyComponent>(entity);
+            if (!rigidbodyComponent.m_RigidBody)
+                continue;
+
+            switch (rigidbodyComponent.cfg.type)
             {
-            case CollisionShapeType::BOX:
-                Coffee::DebugRenderer::DrawBox(cmd.position + glm::vec3(10,0,0), cmd.rotation,
-                                               cmd.size, 
-                                               cmd.color);
+            case RigidBodyType::Static:
+                batch.Static.push_back(entity);
                 break;
-
-            case CollisionShapeType::SPHERE:
-                Coffee::DebugRenderer::DrawSphere(cmd.position,
-                                                  cmd.size.x, 
-                                                  cmd.color);
+            case RigidBodyType::Kinematic:
+                batch.Kinematic.push_back(entity);
+                break;
+            case RigidBodyType::Dynamic:
+                batch.Dynamic.push_back(entity);
                 break;
+            }
+        }
+    }
+
+    void PhysicsEngine::ApplyKinematicBodies(entt::registry& registry, const RigidbodyBatch& batch, float dt)
+    {
+        ZoneScoped;
+
+        for (auto entity : batch.Kinematic)
+        {
+            auto& rigidbodyComponent = registry.get<RigidbodyComponent>(entity);
+            auto& transformComponent = registry.get<TransformComponent>(entity);
+            const RigidBodyConfig& cfg = rigidbodyComponent.cfg;
+
+            if (!cfg.FreezeX)
+                transformComponent.Position.x += cfg.Velocity.x * dt;
+            if (!cfg.FreezeY)
+                transformComponent.Position.y += cfg.Velocity.y * dt;
+            if (!cfg.FreezeZ)
+                transformComponent.Position.z += cfg.Velocity.z * dt;
+
+            rigidbodyComponent.m_RigidBody->SetKinematicTransform(
+                transformComponent.Position, glm::quat(glm::radians(transformComponent.Rotation)));
+        }
+    }
+
+    void PhysicsEngine::BeginStep(float dt)
+    {
+        ZoneScoped;
+
+        WaitForStep();
+
+        // Queued objects belong to owners that are gone, they can't be stepped
+        if (m_BatchDepth > 0)
+            FlushBatch();
+
+        // The step reads the frustum, so it only changes hands while no step is running
+        m_DebugFrustum = m_NextDebugFrustum;
+
+        ProjectileSystem::FlushSpawns();
+
+        if (!m_Settings.AsyncStep)
+        {
+            Update(dt);
+            m_FrontBuffer = 1 - m_FrontBuffer;
+            return;
+        }
+
+        if (!m_PhysicsThread.joinable())
+        {
+            m_StopThread = false;
+            m_PhysicsThread = std::thread(&PhysicsEngine::PhysicsThreadLoop);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_StepMutex);
+            m_PendingDt = dt;
+            m_StepPending = true;
+        }
+        m_StepCondition.notify_all();
+    }
+
+    void PhysicsEngine::WaitForStep()
+    {
+        // The physics thread reaches the world through the same accessors while stepping
+        if (!m_PhysicsThread.joinable() || std::this_thread::get_id() == m_PhysicsThread.get_id())
+            return;
+
+        ZoneScoped;
+
+        std::unique_lock<std::mutex> lock(m_StepMutex);
+        m_StepCondition.wait(lock, [] { return !m_StepPending; });
+
+        if (m_StepFinished)
+        {
+            m_StepFinished = false;
+            m_FrontBuffer = 1 - m_FrontBuffer;
+        }
+    }
+
+    void PhysicsEngine::PhysicsThreadLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_StepMutex);
+        while (true)
+        {
+            m_StepCondition.wait(lock, [] { return m_StepPending || m_StopThread; });
+            if (m_StopThread)
+                return;
+
+            const float dt = m_PendingDt;
+            lock.unlock();
 
+            Update(dt);
+
+            lock.lock();
+            m_StepPending = false;
+            m_StepFinished = true;
+            m_StepCondition.notify_all();
+        }
+    }
+
+    void PhysicsEngine::StopPhysicsThread()
+    {
+        if (!m_PhysicsThread.joinable())
+            return;
+
+        WaitForStep();
+
+        {
+            std::lock_guard<std::mutex> lock(m_StepMutex);
+            m_StopThread = true;
+        }
+        m_StepCondition.notify_all();
+        m_PhysicsThread.join();
+
+        // Commands pushed after the last step would otherwise wait for a thread that no longer exists
+        ExecuteCommands();
+    }
+
+    void PhysicsEngine::SubmitCommand(const PhysicsCommand& command)
+    {
+        if (!command.body)
+            return;
+
+        if (!m_Settings.AsyncStep)
+        {
+            ExecuteCommand(command);
+            return;
+        }
+
+        if (!m_Commands.Push(command))
+        {
+            // Queue full, apply everything now rather than dropping commands
+            WaitForStep();
+            ExecuteCommands();
+            ExecuteCommand(command);
+        }
+    }
+
+    void PhysicsEngine::ExecuteCommands()
+    {
+        PhysicsCommand command;
+        while (m_Commands.Pop(command))
+            ExecuteCommand(command);
+    }
+
+    void PhysicsEngine::ExecuteCommand(const PhysicsCommand& command)
+    {
+        btRigidBody* body = command.body;
+
+        switch (command.type)
+        {
+        case PhysicsCommand::Type::ApplyForce:
+            body->applyForce(command.Vector, command.Point);
+            break;
+        case PhysicsCommand::Type::ApplyImpulse:
+            body->applyImpulse(command.Vector, command.Point);
+            break;
+        case PhysicsCommand::Type::SetVelocity:
+            body->setLinearVelocity(command.Vector);
+            break;
+        case PhysicsCommand::Type::AddVelocity:
+            body->setLinearVelocity(body->getLinearVelocity() + command.Vector);
+            break;
+        case PhysicsCommand::Type::SetAngularVelocity:
+            body->setAngularVelocity(command.Vector);
+            break;
+        case PhysicsCommand::Type::SetTransform: {
+            btTransform transform(command.Rotation, command.Vector);
+            body->setWorldTransform(transform);
+            if (auto* motionState = static_cast<PhysicsMotionState*>(body->getMotionState()))
+                motionState->SetTransform(transform);
+            break;
+        }
+        case PhysicsCommand::Type::SetWorldTransform:
+            body->setWorldTransform(btTransform(command.Rotation, command.Vector));
+            break;
+        case PhysicsCommand::Type::SetGravity:
+            body->setGravity(command.Vector);
+            break;
+        // Material changes don't need the body awake
+        case PhysicsCommand::Type::SetFriction:
+            body->setFriction(command.Scalar);
+            return;
+        case PhysicsCommand::Type::SetRestitution:
+            body->setRestitution(command.Scalar);
+            return;
+        case PhysicsCommand::Type::Activate:
+            body->activate(command.Scalar != 0);
+            return;
+        }
+
+        body->activate(true);
+    }
+
+    void PhysicsEngine::PublishPoses()
+    {
+        ZoneScoped;
+
+        std::vector<BodyPose>& poses = m_PoseBuffers[1 - m_FrontBuffer];
+        poses.clear();
+
+        for (PhysicsMotionState* state : m_MovedBodies)
+        {
+            const btTransform transform = state->GetInterpolatedTransform(m_InterpolationAlpha);
+            const glm::vec3 velocity =
+                state->GetBody() ? PhysUtils::BulletToGlm(state->GetBody()->getLinearVelocity()) : glm::vec3(0.0f);
+
+            poses.push_back({state->GetEntity(), PhysUtils::BulletToGlm(transform.getOrigin()),
+                             PhysUtils::BulletToGlm(transform.getRotation()), velocity});
+        }
+    }
+
+    void PhysicsEngine::RecordTelemetry(float stepTimeMs)
+    {
+        PhysicsTickStats stats;
+        stats.Tick = m_TickCount++;
+        stats.StepTimeMs = stepTimeMs;
+        stats.SolverIterations = static_cast<uint32_t>(m_world->getSolverInfo().m_numIterations);
+
+        const bool sampleBody = PhysicsTelemetry::ShouldSample(stats.Tick);
+#ifdef TRACY_ENABLE
+        const bool countBodies = true;
+#else
+        const bool countBodies = PhysicsTelemetry::IsBodyCounting();
+#endif
+        const entt::entity tracedEntity = PhysicsTelemetry::GetTracedEntity();
+
+        // Walking the bodies is the only per-body cost, skipped unless a tool asked for it
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        for (int i = 0; (countBodies || sampleBody) && i < objects.size(); ++i)
+        {
+            const btCollisionObject* object = objects[i];
+            if (object->isStaticOrKinematicObject())
+                continue;
+
+            const bool active = object->isActive();
+            active ? ++stats.ActiveBodies : ++stats.SleepingBodies;
+
+            if (sampleBody)
+            {
+                const btRigidBody* body = btRigidBody::upcast(object);
+                auto* motionState = body ? static_cast<const PhysicsMotionState*>(body->getMotionState()) : nullptr;
+                if (motionState && motionState->GetEntity() == tracedEntity)
+                {
+                    PhysicsTelemetry::RecordBodySample({stats.Tick, tracedEntity,
+                                                        PhysUtils::BulletToGlm(body->getWorldTransform().getOrigin()),
+                                                        PhysUtils::BulletToGlm(body->getLinearVelocity()),
+                                                        PhysUtils::BulletToGlm(body->getAngularVelocity()), active});
+                }
             }
-        }*/
+        }
+
+        stats.Manifolds = static_cast<uint32_t>(m_dispatcher->getNumManifolds());
+        for (int i = 0; i < m_dispatcher->getNumManifolds(); ++i)
+            stats.Contacts += m_dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
 
+        PhysicsTelemetry::RecordTick(stats);
     }
 
-    void PhysicsEngine::ApplyRigidbody(RigidbodyComponent& rigidbodyComponent, TransformComponent& transformComponent,
-                                       float dt)
+    void PhysicsEngine::CollectLodAnchors(entt::registry& registry)
     {
-        if (!Scene::m_RigidbodyEntities.empty())
+        ZoneScoped;
+
+        m_LodAnchors.clear();
+        if (!m_Settings.LodEnabled)
+            return;
+
+        // The scene renders with the last camera it finds, so that's the one the rings follow
+        entt::entity activeCamera = entt::null;
+        for (auto entity : registry.view<TransformComponent, CameraComponent>())
+            activeCamera = entity;
+
+        if (activeCamera != entt::null)
         {
-            for (auto entity : Scene::m_RigidbodyEntities)
+            const auto& transform = registry.get<TransformComponent>(activeCamera);
+            m_LodAnchors.push_back({PhysUtils::GlmToBullet(glm::vec3(transform.GetWorldTransform()[3])), 1.0f});
+        }
+
+        auto anchorView = registry.view<TransformComponent, PhysicsLodAnchorComponent>();
+        for (auto entity : anchorView)
+        {
+            auto [transform, anchor] = anchorView.get<TransformComponent, PhysicsLodAnchorComponent>(entity);
+            m_LodAnchors.push_back(
+                {PhysUtils::GlmToBullet(glm::vec3(transform.GetWorldTransform()[3])), anchor.RadiusScale});
+        }
+    }
+
+    uint8_t PhysicsEngine::GetLodRing(const btVector3& position)
+    {
+        const btScalar radii[] = {m_Settings.LodFullRateRadius, m_Settings.LodHalfRateRadius,
+                                  m_Settings.LodQuarterRateRadius};
+
+        uint8_t ring = kLodSleepRing;
+        for (const LodAnchor& anchor : m_LodAnchors)
+        {
+            const btScalar distance2 = position.distance2(anchor.Position);
+            for (uint8_t i = 0; i < ring; ++i)
             {
-                if (rigidbodyComponent.cfg.type == RigidBodyType::Static)
-                    continue;
+                const btScalar radius = radii[i] * anchor.RadiusScale;
+                if (distance2 < radius * radius)
+                {
+                    ring = i;
+                    break;
+                }
+            }
+        }
+        return ring;
+    }
 
-                rigidbodyComponent.m_RigidBody->GetConfig(rigidbodyComponent.cfg);
+    void PhysicsEngine::ApplyLod(uint64_t tick)
+    {
+        ZoneScoped;
+
+        m_LodActive = true;
+        m_LodScaledBodies.clear();
+
+        // Rings only change when every ring is due, so no body skips a step it was promised
+        const bool assignRings = tick % kLodMaxDivisor == 0;
 
-                if (rigidbodyComponent.cfg.type == RigidBodyType::Dynamic)
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            btRigidBody* body = btRigidBody::upcast(objects[i]);
+            if (!body || body->isStaticOrKinematicObject() || body->getActivationState() == DISABLE_DEACTIVATION)
+                continue;
+
+            auto* state = static_cast<PhysicsMotionState*>(body->getMotionState());
+            if (!state)
+                continue;
+
+            if (assignRings)
+                state->m_LodRing = GetLodRing(body->getWorldTransform().getOrigin());
+
+            const uint32_t divisor = 1u << state->m_LodRing;
+            // Spread each ring over the ticks so the skipped work doesn't all land on one tick. The
+            // stagger comes from the entity, or the world order for bodies without one, never from
+            // an address, so replays step every body on the same ticks
+            const entt::entity entity = state->GetEntity();
+            const uint64_t stagger = entity != entt::null ? static_cast<uint64_t>(entt::to_entity(entity))
+                                                          : static_cast<uint64_t>(i);
+            const bool steps = state->m_LodRing < kLodSleepRing && (tick + stagger) % divisor == 0;
+
+            if (!steps)
+            {
+                // Bodies woken by an active neighbour since they were frozen are frozen again
+                if (body->isActive())
                 {
-                    if (rigidbodyComponent.cfg.UseGravity && !rigidbodyComponent.cfg.FreezeY)
-                    {
-                        glm::vec3 gravity = GetGravity();
-                        // gravity *= 0.1f; 
-                        
-                        if (rigidbodyComponent.cfg.shapeConfig.mass > 0.0f)
-                        {
-                            rigidbodyComponent.cfg.Acceleration += gravity * dt;
-                            rigidbodyComponent.ApplyDrag();
-                        }
-                    }
+                    state->m_LodLinearVelocity = body->getLinearVelocity();
+                    state->m_LodAngularVelocity = body->getAngularVelocity();
+                    state->m_LodFrozen = true;
+                    body->forceActivationState(ISLAND_SLEEPING);
+                }
+                continue;
+            }
 
-                    if (rigidbodyComponent.cfg.type == RigidBodyType::Kinematic)
-                    {
-                        transformComponent.Position += rigidbodyComponent.cfg.Velocity * dt;
-                        return;
-                    }
+            if (state->m_LodFrozen)
+            {
+                // Bullet zeroes the velocity of slow sleeping bodies, put back the one it had
+                if (body->getActivationState() == ISLAND_SLEEPING)
+                {
+                    body->setLinearVelocity(state->m_LodLinearVelocity);
+                    body->setAngularVelocity(state->m_LodAngularVelocity);
+                }
+                body->forceActivationState(ACTIVE_TAG);
+                body->setDeactivationTime(0);
+                state->m_LodFrozen = false;
+            }
+
+            if (divisor == 1 || !body->isActive())
+                continue;
+
+            // One tick at d times the velocity and d^2 times the gravity covers the d ticks of the ring
+            const btScalar scale = static_cast<btScalar>(divisor);
+            body->setLinearVelocity(body->getLinearVelocity() * scale);
+            body->setAngularVelocity(body->getAngularVelocity() * scale);
+            body->setGravity(body->getGravity() * (scale * scale));
+            m_LodScaledBodies.push_back(body);
+        }
+    }
 
-                    rigidbodyComponent.cfg.Velocity += rigidbodyComponent.cfg.Acceleration * dt;
-
-                    if (!rigidbodyComponent.cfg.FreezeX)
-                        transformComponent.Position.x += rigidbodyComponent.cfg.Velocity.x * dt;
-                    if (!rigidbodyComponent.cfg.FreezeY)
-                        transformComponent.Position.y += rigidbodyComponent.cfg.Velocity.y * dt;
-                    if (!rigidbodyComponent.cfg.FreezeZ)
-                        transformComponent.Position.z += rigidbodyComponent.cfg.Velocity.z * dt;
-                    if (rigidbodyComponent.cfg.FreezeRotX)
-                        rigidbodyComponent.cfg.Velocity.x = 0.0f;
-                    if (rigidbodyComponent.cfg.FreezeRotY)
-                        rigidbodyComponent.cfg.Velocity.y = 0.0f;
-                    if (rigidbodyComponent.cfg.FreezeRotZ)
-                        rigidbodyComponent.cfg.Velocity.z = 0.0f;
-
-                    rigidbodyComponent.ApplyAngularDrag();
+    void PhysicsEngine::FinishLodStep()
+    {
+        for (btRigidBody* body : m_LodScaledBodies)
+        {
+            const auto* state = static_cast<const PhysicsMotionState*>(body->getMotionState());
+            const btScalar scale = static_cast<btScalar>(1u << state->m_LodRing);
+
+            body->setLinearVelocity(body->getLinearVelocity() / scale);
+            body->setAngularVelocity(body->getAngularVelocity() / scale);
+            body->setGravity(body->getGravity() / (scale * scale));
+        }
+        m_LodScaledBodies.clear();
+    }
+
+    void PhysicsEngine::ReleaseLod()
+    {
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            btRigidBody* body = btRigidBody::upcast(objects[i]);
+            auto* state = body ? static_cast<PhysicsMotionState*>(body->getMotionState()) : nullptr;
+            if (!state)
+                continue;
+
+            if (state->m_LodFrozen)
+            {
+                if (body->getActivationState() == ISLAND_SLEEPING)
+                {
+                    body->setLinearVelocity(state->m_LodLinearVelocity);
+                    body->setAngularVelocity(state->m_LodAngularVelocity);
                 }
+                body->forceActivationState(ACTIVE_TAG);
+                body->setDeactivationTime(0);
+                state->m_LodFrozen = false;
             }
+            state->m_LodRing = 0;
         }
+        m_LodActive = false;
     }
-    void PhysicsEngine::Destroy()
+
+    void PhysicsEngine::CountIslands(PhysicsStats& stats)
     {
-        for (auto* obj : m_CollisionObjects)
+        ZoneScoped;
+
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+
+        // Island tags are union-find indices, so they are always below the object count
+        m_IslandBodyCounter.assign(objects.size(), 0);
+        for (int i = 0; i < objects.size(); ++i)
         {
-            m_world->removeCollisionObject(obj);
-            delete obj;
+            const int tag = objects[i]->getIslandTag();
+            if (tag >= 0 && tag < objects.size() && !objects[i]->isStaticOrKinematicObject())
+                ++m_IslandBodyCounter[tag];
         }
-        m_CollisionObjects.clear();
 
-        for (auto* shape : m_CollisionShapes)
+        stats.IslandBodyCounts.clear();
+        for (uint32_t count : m_IslandBodyCounter)
         {
-            delete shape;
+            if (count > 0)
+                stats.IslandBodyCounts.push_back(count);
         }
-        m_CollisionShapes.clear();
+        std::sort(stats.IslandBodyCounts.begin(), stats.IslandBodyCounts.end(), std::greater<uint32_t>());
+        stats.Islands = static_cast<uint32_t>(stats.IslandBodyCounts.size());
+    }
 
-        delete m_world;
-        delete m_solver;
-        delete m_broad_phase;
-        delete m_dispatcher;
-        delete m_collision_conf;
+    void PhysicsEngine::ApplyRigidbodies(entt::registry& registry)
+    {
+        ZoneScoped;
 
-        m_world = nullptr;
-        m_solver = nullptr;
-        m_broad_phase = nullptr;
-        m_dispatcher = nullptr;
-        m_collision_conf = nullptr;
+        for (const BodyPose& pose : m_PoseBuffers[m_FrontBuffer])
+        {
+            if (!registry.valid(pose.Entity))
+                continue;
+
+            auto* rigidbodyComponent = registry.try_get<RigidbodyComponent>(pose.Entity);
+            if (!rigidbodyComponent || !rigidbodyComponent->m_RigidBody)
+                continue;
+
+            auto& transformComponent = registry.get<TransformComponent>(pose.Entity);
+
+            transformComponent.Position = pose.Position;
+            transformComponent.Rotation = glm::degrees(glm::eulerAngles(pose.Rotation));
+            rigidbodyComponent->cfg.Velocity = pose.Velocity;
+        }
+    }
+
+    void PhysicsEngine::Destroy()
+    {
+        StopPhysicsThread();
+
+        FlushBatch();
+        m_BatchDepth = 0;
+
+        // Baked compounds are not in m_CollisionObjects and hold references on the cached shapes
+        StaticColliderBaker::Clear();
+
+        // Objects still in the world aren't removed one by one: the world drops their proxies when
+        // it is deleted and the arena frees them with its pools. Owners destroyed later find no world.
+        m_CollisionObjects.clear();
+        DestroyWorld();
+
+        for (btCollisionShape* shape : m_OwnedShapes)
+            delete shape;
+        m_OwnedShapes.clear();
+
+        CollisionShapeCache::Clear();
+        ConvexHullCache::Clear();
+
+        const PhysicsArenaStats arenaStats = PhysicsArena::GetStats();
+        COFFEE_CORE_INFO("Physics arena high-water marks: {0} KB, {1} rigid bodies, {2} collision objects",
+                         arenaStats.PeakBytes / 1024, arenaStats.PeakRigidBodies, arenaStats.PeakCollisionObjects);
+        PhysicsArena::Release();
+
+        m_Accumulator = 0.0f;
+        m_InterpolationAlpha = 0.0f;
+        m_TickCount = 0;
+        PhysicsTelemetry::Clear();
+        m_LodAnchors.clear();
+        m_LodScaledBodies.clear();
+        m_LodActive = false;
+        m_Stats[0] = PhysicsStats();
+        m_Stats[1] = PhysicsStats();
+        m_IslandBodyCounter.clear();
+        m_PoseBuffers[0].clear();
+        m_PoseBuffers[1].clear();
+        m_ContactTracker.Clear();
+        m_ContactEvents[0].clear();
+        m_ContactEvents[1].clear();
+        m_DispatchedEvents.clear();
+        ProjectileSystem::Clear();
+        m_ProjectileHits[0].clear();
+        m_ProjectileHits[1].clear();
+        m_DebugLines[0].clear();
+        m_DebugLines[1].clear();
+        m_NextDebugFrustum.reset();
+        m_DebugFrustum.reset();
+
+        if (m_TaskScheduler)
+        {
+            btSetTaskScheduler(btGetSequentialTaskScheduler());
+            delete m_TaskScheduler;
+            m_TaskScheduler = nullptr;
+        }
     }
 
     void PhysicsEngine::SetGravity(const glm::vec3& gravity)
     {
-        
+        WaitForStep();
+
         if (m_world)
         {
             m_world->setGravity(PhysUtils::GlmToBullet(gravity));
@@ -179,6 +952,8 @@ namespace Coffee
 
     glm::vec3 PhysicsEngine::GetGravity()
     {
+        WaitForStep();
+
         if (m_world)
         {
             return PhysUtils::BulletToGlm(m_world->getGravity());
@@ -225,29 +1000,7 @@ namespace Coffee
 
     btCollisionShape* PhysicsEngine::CreateCollisionShape(const CollisionShapeConfig& config)
     {
-        btCollisionShape* shape = nullptr;
-
-        switch (config.type)
-        {
-        case CollisionShapeType::BOX:
-            shape = new btBoxShape(PhysUtils::GlmToBullet(config.size * 0.5f));
-            break;
-        case CollisionShapeType::SPHERE:
-            shape = new btSphereShape(config.size.x);
-            break;
-        case CollisionShapeType::CAPSULE:
-            shape = new btCapsuleShape(config.size.x, config.size.y);
-            break;
-        case CollisionShapeType::CYLINDER:
-            shape = new btCylinderShape(PhysUtils::GlmToBullet(config.size));
-            break;
-        default:
-            shape = new btBoxShape(PhysUtils::GlmToBullet(config.size * 0.5f));
-            break;
-        }
-
-        m_CollisionShapes.push_back(shape);
-        return shape;
+        return CollisionShapeCache::Acquire(config);
     }
 
     void PhysicsEngine::AddDebugDrawCommand(CollisionShapeType type, const glm::vec3& position,
@@ -260,32 +1013,19 @@ namespace Coffee
                                                             const glm::vec3& position, const glm::vec3& scale,
                                                             const glm::quat& rotation)
     {
-        // Adjust the size based on the GameObject's scale
-        glm::vec3 adjustedSize = config.size;
+        WaitForStep();
 
-        // Create the collision shape with the adjusted size
-        btCollisionShape* shape = nullptr;
-
-        switch (config.type)
-        {
-        case CollisionShapeType::BOX:
-            shape = new btBoxShape(PhysUtils::GlmToBullet(adjustedSize * 0.5f)); // Half extents
-            break;
-        case CollisionShapeType::SPHERE:
-            shape = new btSphereShape(config.size.x);
-            break;
-        // Other types...
-        default:
-            shape = new btBoxShape(PhysUtils::GlmToBullet(adjustedSize * 0.5f));
-            break;
-        }
+        // Triangle meshes and hulls take the object scale so the shared mesh-space shape fits the instance
+        const bool isMesh = config.type == CollisionShapeType::MESH || config.type == CollisionShapeType::CONVEX_HULL;
+        btCollisionShape* shape = CollisionShapeCache::Acquire(config, isMesh ? scale : glm::vec3(1.0f));
+        const float mass = shape->isConcave() ? 0.0f : config.mass;
 
         btCollisionObject* object = nullptr;
 
         if (config.isTrigger)
         {
             // Create a simple collision object for triggers
-            object = new btCollisionObject();
+            object = PhysicsArena::CreateCollisionObject();
             object->setCollisionShape(shape);
             object->setCollisionFlags(object->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
         }
@@ -294,20 +1034,22 @@ namespace Coffee
             btVector3 localInertia(0, 0, 0);
 
             // Calculate local inertia if the object has mass
-            if (config.mass != 0.0f)
+            if (mass != 0.0f)
             {
-                shape->calculateLocalInertia(config.mass, localInertia);
+                shape->calculateLocalInertia(mass, localInertia);
             }
 
             // Create the motion state with initial transform
-            btDefaultMotionState* motionState = new btDefaultMotionState(
+            PhysicsMotionState* motionState = PhysicsArena::CreateMotionState(
                 btTransform(PhysUtils::GlmToBullet(rotation), PhysUtils::GlmToBullet(position)));
 
             // Set up rigid body construction info
-            btRigidBody::btRigidBodyConstructionInfo rbInfo(config.mass, motionState, shape, localInertia);
+            btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motionState, shape, localInertia);
 
             // Create the rigid body
-            btRigidBody* rigidBody = new btRigidBody(rbInfo);
+            btRigidBody* rigidBody = PhysicsArena::CreateRigidBody(rbInfo);
+            motionState->SetBody(rigidBody);
+            ApplyContinuousCollision(rigidBody);
 
             object = rigidBody;
         }
@@ -320,27 +1062,57 @@ namespace Coffee
         transform.setRotation(PhysUtils::GlmToBullet(rotation));
         object->setWorldTransform(transform);
 
+        AddCollisionObject(object, config.layer);
+
+        return object;
+    }
+
+    void PhysicsEngine::AddCollisionObject(btCollisionObject* object, int layer, bool ownsShape)
+    {
+        WaitForStep();
+
+        layer = std::clamp(layer, 0, PhysicsSettings::MaxCollisionLayers - 1);
         if (object->getInternalType() == btCollisionObject::CO_RIGID_BODY)
         {
             btRigidBody* body = static_cast<btRigidBody*>(object);
-            m_world->addRigidBody(body);
+            m_world->addRigidBody(body, GetCollisionGroup(layer), GetCollisionMask(layer));
         }
         else
         {
-            m_world->addCollisionObject(object);
+            m_world->addCollisionObject(object, GetCollisionGroup(layer), GetCollisionMask(layer));
         }
 
-        m_CollisionObjects.push_back(object);
+        if (m_BatchDepth > 0)
+            m_BatchInserted++;
 
-        return object;
+        if (ownsShape)
+            m_OwnedShapes.insert(object->getCollisionShape());
+
+        m_CollisionObjects.push_back(object);
     }
 
     void PhysicsEngine::DestroyCollisionObject(btCollisionObject* object)
     {
-        if (!object)
+        // Without a world the object was freed in bulk by Destroy
+        if (!object || !m_world)
+            return;
+
+        WaitForStep();
+        ExecuteCommands();
+        StaticColliderBaker::Forget(object);
+
+        if (m_BatchDepth > 0)
+        {
+            // The owner is going away, the object stays in the world until the batch ends
+            object->setUserPointer(nullptr);
+            m_PendingDestroys.push_back(object);
             return;
+        }
+
+        ForgetCollisionObject(object);
 
-        m_world->removeCollisionObject(object);
+        if (m_world)
+            m_world->removeCollisionObject(object);
 
         auto it = std::find(m_CollisionObjects.begin(), m_CollisionObjects.end(), object);
         if (it != m_CollisionObjects.end())
@@ -348,43 +1120,137 @@ namespace Coffee
             m_CollisionObjects.erase(it);
         }
 
+        ReleaseShape(object->getCollisionShape());
+
         // if rigid body, delete motion state
         btRigidBody* body = btRigidBody::upcast(object);
         if (body && body->getMotionState())
         {
-            delete body->getMotionState();
+            PhysicsArena::DestroyMotionState(body->getMotionState());
         }
 
-        delete object;
+        PhysicsArena::DestroyCollisionObject(object);
     }
 
-    void PhysicsEngine::ProcessTriggerEvents()
+    void PhysicsEngine::SubmitDebugLines(const Frustum& frustum)
     {
-        if (!m_world)
+        if (!m_Settings.DebugDrawEnabled)
+            return;
+
+        ZoneScoped;
+
+        m_NextDebugFrustum = frustum;
+
+        const std::vector<DebugVertex>& lines = m_DebugLines[m_FrontBuffer];
+        DebugRenderer::DrawLines(lines.data(), static_cast<int>(lines.size()));
+    }
+
+    void PhysicsEngine::DrawDebugWorld(const Frustum& frustum)
+    {
+        if (!m_world || !m_Settings.DebugDrawEnabled)
             return;
 
-        int numManifolds = m_world->getDispatcher()->getNumManifolds();
-        for (int i = 0; i < numManifolds; ++i)
+        ZoneScoped;
+
+        WaitForStep();
+
+        // Without a step nothing refreshes the broadphase AABBs of objects moved in the editor
+        m_world->updateAabbs();
+
+        std::vector<DebugVertex>& lines = m_DebugLines[m_FrontBuffer];
+        m_DebugDrawer.Draw(m_world, m_Settings, &frustum, lines);
+        DebugRenderer::DrawLines(lines.data(), static_cast<int>(lines.size()));
+    }
+
+    void PhysicsEngine::DispatchContactEvents()
+    {
+        ZoneScoped;
+
+        // Callbacks can destroy objects, which clears their events from the buffers while this loop
+        // runs. The events are swapped out first and walked by index, a cleared event has no objects.
+        std::vector<ContactEvent>& events = m_DispatchedEvents;
+        events.swap(m_ContactEvents[m_FrontBuffer]);
+
+        for (size_t i = 0; i < events.size(); ++i)
         {
-            btPersistentManifold* contactManifold = m_world->getDispatcher()->getManifoldByIndexInternal(i);
+            const ContactEvent event = events[i];
+            if (!event.ObjectA)
+                continue;
+
+            if (event.type == ContactEvent::Type::ProjectileHit)
+            {
+                auto* callbacks = static_cast<CollisionCallbacks*>(event.ObjectA->getUserPointer());
+                if (callbacks && callbacks->m_OnProjectileHit)
+                    callbacks->m_OnProjectileHit(m_ProjectileHits[m_FrontBuffer][event.Hit]);
+                continue;
+            }
+
+            auto* callbacksA = static_cast<CollisionCallbacks*>(event.ObjectA->getUserPointer());
+            auto* callbacksB = static_cast<CollisionCallbacks*>(event.ObjectB->getUserPointer());
+            if (!callbacksA || !callbacksB)
+                continue;
 
-            const btCollisionObject* objA = contactManifold->getBody0();
-            const btCollisionObject* objB = contactManifold->getBody1();
+            // The first callback may destroy either object, the event is cleared when it does
+            auto alive = [&events, i]() { return events[i].ObjectA != nullptr; };
 
-            if (contactManifold->getNumContacts() > 0)
+            switch (event.type)
             {
-                // Aseg�rate de que los UserPointers son v�lidos y convertibles
-                if (objA->getUserPointer() && objB->getUserPointer())
-                {
-                    Collider* colliderA = dynamic_cast<Collider*>(static_cast<Collider*>(objA->getUserPointer()));
-                    Collider* colliderB = dynamic_cast<Collider*>(static_cast<Collider*>(objB->getUserPointer()));
+            case ContactEvent::Type::Enter:
+                if (callbacksA->m_OnContactStarted)
+                    callbacksA->m_OnContactStarted(callbacksB);
+                if (alive() && callbacksB->m_OnContactStarted)
+                    callbacksB->m_OnContactStarted(callbacksA);
 
-                    if (colliderA && colliderB)
-                    {
-                        colliderA->OnCollision(colliderB);
-                        colliderB->OnCollision(colliderA);
-                    }
+                if (alive() && callbacksA->collider && callbacksB->collider)
+                {
+                    callbacksA->collider->OnCollision(callbacksB->collider);
+                    if (alive())
+                        callbacksB->collider->OnCollision(callbacksA->collider);
                 }
+                break;
+            case ContactEvent::Type::Stay:
+                if (callbacksA->m_OnContactStay)
+                    callbacksA->m_OnContactStay(callbacksB);
+                if (alive() && callbacksB->m_OnContactStay)
+                    callbacksB->m_OnContactStay(callbacksA);
+                break;
+            case ContactEvent::Type::Exit:
+                if (callbacksA->m_OnContactEnded)
+                    callbacksA->m_OnContactEnded(callbacksB);
+                if (alive() && callbacksB->m_OnContactEnded)
+                    callbacksB->m_OnContactEnded(callbacksA);
+                break;
+            case ContactEvent::Type::ProjectileHit:
+                break;
+            }
+        }
+
+        // Hand the storage back to the front buffer, emptied so the events aren't dispatched twice
+        events.clear();
+        events.swap(m_ContactEvents[m_FrontBuffer]);
+    }
+
+    void PhysicsEngine::ForgetCollisionObject(const btCollisionObject* object)
+    {
+        m_ContactTracker.RemoveObject(object);
+
+        // Cleared in place, DispatchContactEvents may be walking one of these buffers
+        for (auto* events : {&m_ContactEvents[0], &m_ContactEvents[1], &m_DispatchedEvents})
+        {
+            for (ContactEvent& event : *events)
+            {
+                if (event.ObjectA == object || event.ObjectB == object)
+                    event.ObjectA = event.ObjectB = nullptr;
+            }
+        }
+
+        // Hits keep their index in the buffer, only the dangling pointer goes
+        for (auto& hits : m_ProjectileHits)
+        {
+            for (ProjectileHit& hit : hits)
+            {
+                if (hit.Object == object)
+                    hit.Object = nullptr;
             }
         }
     }
@@ -394,6 +1260,8 @@ namespace Coffee
         if (!object)
             return;
 
+        WaitForStep();
+
         btTransform transform = object->getWorldTransform();
         transform.setOrigin(PhysUtils::GlmToBullet(position));
         object->setWorldTransform(transform);
@@ -404,6 +1272,8 @@ namespace Coffee
         if (!object)
             return glm::vec3(0.0f);
 
+        WaitForStep();
+
         const btTransform& transform = object->getWorldTransform();
         return PhysUtils::BulletToGlm(transform.getOrigin());
     }
@@ -425,38 +1295,569 @@ namespace Coffee
         }
         return flags;
     }
-    btRigidBody* PhysicsEngine::CreateRigidBody(CollisionCallbacks* colCallbacks, const RigidBodyConfig& config)
+    btRigidBody* PhysicsEngine::CreateRigidBody(CollisionCallbacks* colCallbacks, const RigidBodyConfig& config,
+                                                const btTransform& startTransform, btCollisionShape* shape)
     {
-        auto shape = CreateCollisionShape(config.shapeConfig);
+        WaitForStep();
+
+        // A given shape has other users, the body takes its own reference like a cached one
+        if (shape)
+            CollisionShapeCache::Retain(shape);
+        else
+            shape = CreateCollisionShape(config.shapeConfig);
+
+        // Only dynamic bodies have mass, Bullet treats zero mass bodies as static or kinematic
+        bool isDynamic = config.type == RigidBodyType::Dynamic;
+        if (isDynamic && shape->isConcave())
+        {
+            COFFEE_CORE_WARN("PhysicsEngine: Triangle mesh bodies cannot be dynamic, the body is created static");
+            isDynamic = false;
+        }
+        const float mass = isDynamic ? config.shapeConfig.mass : 0.0f;
 
         btVector3 localInertia(0, 0, 0);
-        if (config.type != RigidBodyType::Static)
-            shape->calculateLocalInertia(config.shapeConfig.mass, localInertia);
+        if (isDynamic)
+            shape->calculateLocalInertia(mass, localInertia);
 
-        btDefaultMotionState* motionState =
-            new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(0, 0, 0)));
+        PhysicsMotionState* motionState = PhysicsArena::CreateMotionState(startTransform);
 
-        btRigidBody::btRigidBodyConstructionInfo rbInfo(config.shapeConfig.mass, motionState, shape, localInertia);
+        btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, motionState, shape, localInertia);
         
         rbInfo.m_linearDamping = config.LinearDrag;
         rbInfo.m_angularDamping = config.AngularDrag;
         rbInfo.m_friction = config.friction;
         rbInfo.m_restitution = config.restitution;
 
-        btRigidBody* body = new btRigidBody(rbInfo);
+        btRigidBody* body = PhysicsArena::CreateRigidBody(rbInfo);
+        motionState->SetBody(body);
         
         // Set object type
-        body->setFlags(body->getFlags() | GetRigidbodyFlags(config));
+        body->setCollisionFlags(body->getCollisionFlags() | GetRigidbodyFlags(config));
+        if (config.type == RigidBodyType::Kinematic)
+            body->setActivationState(DISABLE_DEACTIVATION);
+
+        // Constraints
+        body->setLinearFactor(btVector3(config.FreezeX ? 0.0f : 1.0f, config.FreezeY ? 0.0f : 1.0f,
+                                        config.FreezeZ ? 0.0f : 1.0f));
+        body->setAngularFactor(btVector3(config.FreezeRotX ? 0.0f : 1.0f, config.FreezeRotY ? 0.0f : 1.0f,
+                                         config.FreezeRotZ ? 0.0f : 1.0f));
 
         body->setUserPointer(colCallbacks);
-        m_world->addRigidBody(body);
+        ApplyContinuousCollision(body);
+
+        const int layer = std::clamp(config.shapeConfig.layer, 0, PhysicsSettings::MaxCollisionLayers - 1);
+        m_world->addRigidBody(body, GetCollisionGroup(layer), GetCollisionMask(layer));
+
+        if (m_BatchDepth > 0)
+            m_BatchInserted++;
 
         return body;
     }
+    void PhysicsEngine::SetCollisionLayer(btCollisionObject* object, int layer)
+    {
+        WaitForStep();
+
+        btBroadphaseProxy* proxy = object ? object->getBroadphaseHandle() : nullptr;
+        if (!m_world || !proxy)
+            return;
+
+        layer = std::clamp(layer, 0, PhysicsSettings::MaxCollisionLayers - 1);
+        proxy->m_collisionFilterGroup = GetCollisionGroup(layer);
+        proxy->m_collisionFilterMask = GetCollisionMask(layer);
+
+        // A new proxy drops the pairs the old filter let through and finds the new ones
+        m_world->refreshBroadphaseProxy(object);
+    }
+
+    int PhysicsEngine::GetCollisionLayer(const btCollisionObject* object)
+    {
+        const btBroadphaseProxy* proxy = object ? object->getBroadphaseHandle() : nullptr;
+        if (!proxy || proxy->m_collisionFilterGroup == 0)
+            return 0;
+
+        return std::countr_zero(static_cast<uint32_t>(proxy->m_collisionFilterGroup));
+    }
+
+    void PhysicsEngine::RefreshCollisionFilters()
+    {
+        ZoneScoped;
+
+        btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            btBroadphaseProxy* proxy = objects[i]->getBroadphaseHandle();
+            if (!proxy)
+                continue;
+
+            const int mask = GetCollisionMask(GetCollisionLayer(objects[i]));
+            if (proxy->m_collisionFilterMask == mask)
+                continue;
+
+            proxy->m_collisionFilterMask = mask;
+            m_world->refreshBroadphaseProxy(objects[i]);
+        }
+    }
+
+    void PhysicsEngine::ApplyContinuousCollision(btRigidBody* body)
+    {
+        WaitForStep();
+
+        btScalar innerRadius = 0.0f;
+        if (m_Settings.Type == PhysicsType::CONTINUOUS)
+        {
+            // The shape was built from its CollisionShapeConfig, so its bounds are the configured extents
+            btVector3 aabbMin, aabbMax;
+            body->getCollisionShape()->getAabb(btTransform::getIdentity(), aabbMin, aabbMax);
+            const btVector3 halfExtents = (aabbMax - aabbMin) * 0.5f;
+            innerRadius = halfExtents[halfExtents.minAxis()];
+        }
+
+        // Bullet only sweeps a body that moves farther than the threshold in one tick, a zero threshold
+        // turns the sweep off. Slower bodies overlap their previous pose, the narrowphase sees what they hit.
+        body->setCcdMotionThreshold(innerRadius);
+        // The swept sphere stays inside the shape so the sweep doesn't stop short of real contacts
+        body->setCcdSweptSphereRadius(innerRadius * 0.8f);
+    }
+
+    void PhysicsEngine::RefreshContinuousCollision()
+    {
+        ZoneScoped;
+
+        btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            if (btRigidBody* body = btRigidBody::upcast(objects[i]))
+                ApplyContinuousCollision(body);
+        }
+    }
+
     void PhysicsEngine::RemoveRigidBody(btRigidBody* rigidBody)
     {
+        // Flush commands that may still target the body before it goes away
+        WaitForStep();
+        ExecuteCommands();
+        ForgetCollisionObject(rigidBody);
+
         if (m_world)
             m_world->removeRigidBody(rigidBody);
     }
 
+    void PhysicsEngine::BeginBatch()
+    {
+        WaitForStep();
+
+        // Pairs of new proxies are found by the tree-against-tree pass in FlushBatch
+        if (m_BatchDepth++ == 0 && m_broad_phase)
+            static_cast<btDbvtBroadphase*>(m_broad_phase)->m_deferedcollide = true;
+    }
+
+    void PhysicsEngine::EndBatch()
+    {
+        if (m_BatchDepth == 0 || --m_BatchDepth > 0)
+            return;
+
+        WaitForStep();
+        FlushBatch();
+    }
+
+    void PhysicsEngine::FlushBatch()
+    {
+        ZoneScoped;
+
+        auto* broadphase = static_cast<btDbvtBroadphase*>(m_broad_phase);
+
+        if (!m_PendingDestroys.empty())
+        {
+            const std::unordered_set<const btCollisionObject*> objects(m_PendingDestroys.begin(),
+                                                                       m_PendingDestroys.end());
+
+            if (m_world)
+            {
+                std::unordered_set<const btBroadphaseProxy*> proxies;
+                for (btCollisionObject* object : m_PendingDestroys)
+                {
+                    if (object->getBroadphaseHandle())
+                        proxies.insert(object->getBroadphaseHandle());
+                }
+
+                // Bullet sweeps the whole pair cache twice for every removed proxy, sweep it once for all of them
+                struct RemovePairsCallback : public btOverlapCallback
+                {
+                    const std::unordered_set<const btBroadphaseProxy*>* Proxies = nullptr;
+
+                    bool processOverlap(btBroadphasePair& pair) override
+                    {
+                        return Proxies->contains(pair.m_pProxy0) || Proxies->contains(pair.m_pProxy1);
+                    }
+                };
+
+                RemovePairsCallback removePairs;
+                removePairs.Proxies = &proxies;
+                broadphase->m_paircache->processAllOverlappingPairs(&removePairs, m_dispatcher);
+
+                // No pair is left to clean, the per-proxy sweeps run against an empty cache
+                btOverlappingPairCache* pairCache = broadphase->m_paircache;
+                btNullPairCache emptyPairCache;
+                broadphase->m_paircache = &emptyPairCache;
+                for (btCollisionObject* object : m_PendingDestroys)
+                    m_world->removeCollisionObject(object);
+                broadphase->m_paircache = pairCache;
+            }
+
+            std::erase_if(m_CollisionObjects, [&objects](btCollisionObject* object) { return objects.contains(object); });
+
+            m_ContactTracker.RemoveObjects(objects);
+            for (auto* events : {&m_ContactEvents[0], &m_ContactEvents[1], &m_DispatchedEvents})
+            {
+                for (ContactEvent& event : *events)
+                {
+                    if (objects.contains(event.ObjectA) || objects.contains(event.ObjectB))
+                        event.ObjectA = event.ObjectB = nullptr;
+                }
+            }
+            for (auto& hits : m_ProjectileHits)
+            {
+                for (ProjectileHit& hit : hits)
+                {
+                    if (objects.contains(hit.Object))
+                        hit.Object = nullptr;
+                }
+            }
+
+            for (btCollisionObject* object : m_PendingDestroys)
+            {
+                ReleaseShape(object->getCollisionShape());
+
+                btRigidBody* body = btRigidBody::upcast(object);
+                if (body && body->getMotionState())
+                    PhysicsArena::DestroyMotionState(body->getMotionState());
+
+                PhysicsArena::DestroyCollisionObject(object);
+            }
+            m_PendingDestroys.clear();
+        }
+
+        if (!broadphase)
+        {
+            m_BatchInserted = 0;
+            return;
+        }
+
+        if (m_BatchInserted > 0)
+        {
+            // New proxies all start in the dynamic set, rebuild it once rather than leave it to incremental passes
+            btDbvt& dynamicSet = broadphase->m_sets[0];
+            if (m_BatchInserted * 4 >= dynamicSet.m_leaves)
+                dynamicSet.optimizeTopDown();
+            else
+                dynamicSet.optimizeIncremental(m_BatchInserted);
+
+            broadphase->m_deferedcollide = true;
+            broadphase->calculateOverlappingPairs(m_dispatcher);
+            m_BatchInserted = 0;
+        }
+
+        // Deferred collision runs the full tree-against-tree pass every step, keep it to open batches
+        broadphase->m_deferedcollide = m_BatchDepth > 0;
+    }
+
+    void PhysicsEngine::ReleaseShape(btCollisionShape* shape)
+    {
+        if (m_OwnedShapes.erase(shape) > 0)
+            delete shape;
+        else
+            CollisionShapeCache::Release(shape);
+    }
+
+    void PhysicsEngine::Snapshot(PhysicsSnapshot& snapshot)
+    {
+        ZoneScoped;
+
+        WaitForStep();
+        ExecuteCommands();
+        if (m_BatchDepth > 0)
+            FlushBatch();
+
+        snapshot.Clear();
+        if (!m_world)
+            return;
+
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        snapshot.Bodies.resize(objects.size());
+
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            const btCollisionObject* object = objects[i];
+            const btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+
+            // Zeroed so padding compares equal between snapshots of the same state
+            BodySnapshot& body = snapshot.Bodies[i];
+            std::memset(&body, 0, sizeof(BodySnapshot));
+
+            body.Object = object;
+            body.FilterGroup = proxy ? proxy->m_collisionFilterGroup : 0;
+            body.FilterMask = proxy ? proxy->m_collisionFilterMask : 0;
+            body.CollisionFlags = object->getCollisionFlags();
+            body.ActivationState = object->getActivationState();
+            body.DeactivationTime = object->getDeactivationTime();
+            body.HitFraction = object->getHitFraction();
+            object->getWorldTransform().serialize(body.WorldTransform);
+            object->getInterpolationWorldTransform().serialize(body.InterpolationWorldTransform);
+            object->getInterpolationLinearVelocity().serialize(body.InterpolationLinearVelocity);
+            object->getInterpolationAngularVelocity().serialize(body.InterpolationAngularVelocity);
+
+            const btRigidBody* rigidBody = btRigidBody::upcast(object);
+            if (!rigidBody)
+                continue;
+
+            rigidBody->getLinearVelocity().serialize(body.LinearVelocity);
+            rigidBody->getAngularVelocity().serialize(body.AngularVelocity);
+            rigidBody->getGravity().serialize(body.Gravity);
+            rigidBody->getTotalForce().serialize(body.TotalForce);
+            rigidBody->getTotalTorque().serialize(body.TotalTorque);
+
+            const auto* state = static_cast<const PhysicsMotionState*>(rigidBody->getMotionState());
+            if (!state)
+                continue;
+
+            body.HasMotionState = 1;
+            state->m_Transform.serialize(body.MotionTransform);
+            state->m_PreviousTransform.serialize(body.MotionPreviousTransform);
+            state->m_LodLinearVelocity.serialize(body.LodLinearVelocity);
+            state->m_LodAngularVelocity.serialize(body.LodAngularVelocity);
+            body.LodRing = state->m_LodRing;
+            body.LodFrozen = state->m_LodFrozen ? 1 : 0;
+        }
+
+        for (int i = 0; i < m_dispatcher->getNumManifolds(); ++i)
+        {
+            const btPersistentManifold* manifold = m_dispatcher->getManifoldByIndexInternal(i);
+            if (manifold->getNumContacts() == 0)
+                continue;
+
+            ManifoldSnapshot& record = snapshot.Manifolds.emplace_back();
+            record.Body0 = manifold->getBody0();
+            record.Body1 = manifold->getBody1();
+            record.FirstPoint = static_cast<uint32_t>(snapshot.Points.size());
+            record.PointCount = static_cast<uint32_t>(manifold->getNumContacts());
+
+            for (int j = 0; j < manifold->getNumContacts(); ++j)
+            {
+                btManifoldPoint& point = snapshot.Points.emplace_back(manifold->getContactPoint(j));
+                point.m_userPersistentData = nullptr;
+            }
+        }
+
+        snapshot.TickCount = m_TickCount;
+        snapshot.Accumulator = m_Accumulator;
+        snapshot.LodActive = m_LodActive;
+    }
+
+    bool PhysicsEngine::Restore(const PhysicsSnapshot& snapshot)
+    {
+        ZoneScoped;
+
+        WaitForStep();
+        ExecuteCommands();
+        if (m_BatchDepth > 0)
+            FlushBatch();
+
+        if (!m_world)
+            return false;
+
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+        bool matches = snapshot.Bodies.size() == static_cast<size_t>(objects.size());
+        for (int i = 0; matches && i < objects.size(); ++i)
+            matches = snapshot.Bodies[i].Object == objects[i];
+
+        if (!matches)
+        {
+            COFFEE_CORE_WARN("PhysicsEngine: Snapshot was taken with other objects in the world, it was not restored");
+            return false;
+        }
+
+        ApplySnapshot(snapshot);
+        return true;
+    }
+
+    void PhysicsEngine::ApplySnapshot(const PhysicsSnapshot& snapshot)
+    {
+        ZoneScoped;
+
+        auto* broadphase = static_cast<btDbvtBroadphase*>(m_broad_phase);
+        btOverlappingPairCache* pairCache = broadphase->getOverlappingPairCache();
+        const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+
+        // Dropping every pair frees the collision algorithms along with their manifolds
+        struct RemoveAllPairsCallback : public btOverlapCallback
+        {
+            bool processOverlap(btBroadphasePair&) override { return true; }
+        };
+
+        RemoveAllPairsCallback removeAllPairs;
+        pairCache->processAllOverlappingPairs(&removeAllPairs, m_dispatcher);
+
+        // An empty Dbvt broadphase resets its trees, stage counters and proxy ids
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            if (btBroadphaseProxy* proxy = objects[i]->getBroadphaseHandle())
+            {
+                broadphase->destroyProxy(proxy, m_dispatcher);
+                objects[i]->setBroadphaseHandle(nullptr);
+            }
+        }
+        broadphase->resetPool(m_dispatcher);
+
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            const BodySnapshot& body = snapshot.Bodies[i];
+            btCollisionObject* object = objects[i];
+
+            btTransform transform;
+            transform.deSerialize(body.WorldTransform);
+
+            btRigidBody* rigidBody = btRigidBody::upcast(object);
+            if (rigidBody)
+            {
+                btVector3 vector;
+                vector.deSerialize(body.LinearVelocity);
+                rigidBody->setLinearVelocity(vector);
+                vector.deSerialize(body.AngularVelocity);
+                rigidBody->setAngularVelocity(vector);
+                vector.deSerialize(body.Gravity);
+                rigidBody->setGravity(vector);
+
+                // Also refreshes the world inertia tensor from the restored basis
+                rigidBody->setCenterOfMassTransform(transform);
+
+                rigidBody->clearForces();
+                vector.deSerialize(body.TotalForce);
+                rigidBody->applyCentralForce(vector);
+                vector.deSerialize(body.TotalTorque);
+                rigidBody->applyTorque(vector);
+
+                auto* state = static_cast<PhysicsMotionState*>(rigidBody->getMotionState());
+                if (state && body.HasMotionState)
+                {
+                    state->m_Transform.deSerialize(body.MotionTransform);
+                    state->m_PreviousTransform.deSerialize(body.MotionPreviousTransform);
+                    state->m_LodLinearVelocity.deSerialize(body.LodLinearVelocity);
+                    state->m_LodAngularVelocity.deSerialize(body.LodAngularVelocity);
+                    state->m_LodRing = body.LodRing;
+                    state->m_LodFrozen = body.LodFrozen != 0;
+
+                    // The scene has to pick up the restored pose, sleeping bodies included
+                    if (!state->m_Moved && state->m_Entity != entt::null)
+                    {
+                        state->m_Moved = true;
+                        m_MovedBodies.push_back(state);
+                    }
+                }
+            }
+            else
+            {
+                object->setWorldTransform(transform);
+            }
+
+            object->setCollisionFlags(body.CollisionFlags);
+            object->forceActivationState(body.ActivationState);
+            object->setDeactivationTime(body.DeactivationTime);
+            object->setHitFraction(body.HitFraction);
+
+            transform.deSerialize(body.InterpolationWorldTransform);
+            object->setInterpolationWorldTransform(transform);
+            btVector3 velocity;
+            velocity.deSerialize(body.InterpolationLinearVelocity);
+            object->setInterpolationLinearVelocity(velocity);
+            velocity.deSerialize(body.InterpolationAngularVelocity);
+            object->setInterpolationAngularVelocity(velocity);
+        }
+
+        // Proxies go back in world array order, which fixes the tree shape and the order pairs are found in
+        for (int i = 0; i < objects.size(); ++i)
+        {
+            btCollisionObject* object = objects[i];
+            btVector3 aabbMin, aabbMax;
+            object->getCollisionShape()->getAabb(object->getWorldTransform(), aabbMin, aabbMax);
+            object->setBroadphaseHandle(broadphase->createProxy(aabbMin, aabbMax,
+                                                                object->getCollisionShape()->getShapeType(), object,
+                                                                snapshot.Bodies[i].FilterGroup,
+                                                                snapshot.Bodies[i].FilterMask, m_dispatcher));
+        }
+        broadphase->m_deferedcollide = m_BatchDepth > 0;
+
+        // Algorithms and manifolds are created in pair order, the saved points are written into them after
+        m_dispatcher->dispatchAllCollisionPairs(pairCache, m_world->getDispatchInfo(), m_dispatcher);
+
+        struct ManifoldSlot
+        {
+            const btCollisionObject* Low;
+            const btCollisionObject* High;
+            btPersistentManifold* Manifold;
+        };
+
+        auto makeSlot = [](const btCollisionObject* a, const btCollisionObject* b, btPersistentManifold* manifold) {
+            return std::less<>()(a, b) ? ManifoldSlot{a, b, manifold} : ManifoldSlot{b, a, manifold};
+        };
+
+        std::vector<ManifoldSlot> slots;
+        slots.reserve(m_dispatcher->getNumManifolds());
+        for (int i = 0; i < m_dispatcher->getNumManifolds(); ++i)
+        {
+            btPersistentManifold* manifold = m_dispatcher->getManifoldByIndexInternal(i);
+            manifold->clearManifold();
+            slots.push_back(makeSlot(manifold->getBody0(), manifold->getBody1(), manifold));
+        }
+
+        // Stable, so pairs with several manifolds keep them in dispatcher order
+        auto slotLess = [](const ManifoldSlot& a, const ManifoldSlot& b) {
+            return std::less<>()(a.Low, b.Low) || (a.Low == b.Low && std::less<>()(a.High, b.High));
+        };
+        std::stable_sort(slots.begin(), slots.end(), slotLess);
+
+        for (const ManifoldSnapshot& record : snapshot.Manifolds)
+        {
+            const ManifoldSlot key = makeSlot(record.Body0, record.Body1, nullptr);
+            auto it = std::lower_bound(slots.begin(), slots.end(), key, slotLess);
+
+            // Take the first manifold of the pair not filled yet, pairs the broadphase no longer has are dropped
+            while (it != slots.end() && it->Low == key.Low && it->High == key.High && !it->Manifold)
+                ++it;
+            if (it == slots.end() || it->Low != key.Low || it->High != key.High)
+                continue;
+
+            btPersistentManifold* manifold = it->Manifold;
+            it->Manifold = nullptr;
+
+            const bool swapped = manifold->getBody0() != record.Body0;
+            for (uint32_t i = 0; i < record.PointCount; ++i)
+            {
+                btManifoldPoint point = snapshot.Points[record.FirstPoint + i];
+                if (swapped)
+                    SwapManifoldPoint(point);
+                manifold->addManifoldPoint(point, true);
+            }
+        }
+
+        m_solver->reset();
+        if (m_solverMt)
+            m_solverMt->reset();
+
+        // The restored manifolds are the pairs touching when the snapshot was taken. Events of the
+        // abandoned timeline are dropped, the ones being dispatched are cleared in place.
+        m_ContactTracker.Rebuild(m_dispatcher);
+        m_ContactEvents[0].clear();
+        m_ContactEvents[1].clear();
+        for (ContactEvent& event : m_DispatchedEvents)
+            event.ObjectA = event.ObjectB = nullptr;
+        m_ProjectileHits[0].clear();
+        m_ProjectileHits[1].clear();
+
+        m_TickCount = snapshot.TickCount;
+        m_Accumulator = snapshot.Accumulator;
+        m_InterpolationAlpha = m_Accumulator / m_Settings.GetFixedTimeStep();
+        m_LodActive = snapshot.LodActive;
+        m_LodScaledBodies.clear();
+    }
+
 } // namespace Coffee
\ No newline at end of file
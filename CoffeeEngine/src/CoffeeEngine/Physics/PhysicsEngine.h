@@ -9,30 +9,33 @@
 #include "CoffeeEngine/Scene/Entity.h"
 #include "Collider.h"
 #include "CollisionCallbacks.h"
+#include "ContactTracker.h"
+#include "PhysicsCommandQueue.h"
+#include "PhysicsDebugDrawer.h"
+#include "PhysicsProfiler.h"
+#include "PhysicsSettings.h"
+#include "PhysicsSnapshot.h"
+#include "ProjectileSystem.h"
+#include "RigidbodyBatch.h"
 #include <bullet/btBulletDynamicsCommon.h>
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+class btITaskScheduler;
+
 namespace Coffee
 {
 
     class RigidbodyComponent;
+    class PhysicsMotionState;
     class TransformComponent;
 
-    /**
-     * @enum PhysicsType
-     * @brief Defines different types of physics simulations.
-     */
-    enum class PhysicsType
-    {
-        BASIC,     ///< Basic physics simulation.
-        DISCRETE,  ///< Discrete collision detection.
-        PARALLEL,  ///< Parallel physics processing.
-        CONTINUOUS ///< Continuous collision detection.
-    };
-
-
 
     /**
      * @class PhysicsEngine
@@ -50,30 +53,128 @@ namespace Coffee
             CollisionShapeType type; // Collider Type
         };
 
+        /**
+         * @struct BodyPose
+         * @brief Pose of a moving body published at the end of a step for the scene to read.
+         */
+        struct BodyPose
+        {
+            entt::entity Entity; ///< Entity owning the body.
+            glm::vec3 Position;  ///< Interpolated position.
+            glm::quat Rotation;  ///< Interpolated rotation.
+            glm::vec3 Velocity;  ///< Linear velocity.
+        };
+
 
         /** @brief Initializes the physics engine. */
         static void Init();
-        /** @brief Updates the physics simulation. */
+        /**
+         * @brief Advances the simulation by a number of fixed ticks.
+         *
+         * Frame time is accumulated and consumed in ticks of PhysicsSettings::TickRate, at most
+         * PhysicsSettings::MaxSubSteps per call. The leftover time sets the interpolation alpha.
+         * @param dt Frame delta time.
+         */
         static void Update(float dt);
+        /**
+         * @brief Starts the step for this frame.
+         *
+         * With PhysicsSettings::AsyncStep the step runs on the physics thread and this returns
+         * immediately, otherwise the step runs inline. Either way the poses read by
+         * ApplyRigidbodies are the ones of the last finished step.
+         * @param dt Frame delta time.
+         */
+        static void BeginStep(float dt);
+        /** @brief Blocks until the step started by BeginStep finishes, the world is safe to touch afterwards. */
+        static void WaitForStep();
+        /**
+         * @brief Applies a change to a rigid body, deferred to the start of the next tick when stepping asynchronously.
+         * @param command The command to apply.
+         */
+        static void SubmitCommand(const PhysicsCommand& command);
         /** @brief Destroys the physics engine and releases resources. */
         static void Destroy();
         /**
-         * @brief Applies a rigid body to an entity's components.
-         * @param rigidbodyComponent The rigid body component.
-         * @param transformComponent The transform component.
+         * @brief Applies new physics settings, rebuilding the world if the world type changed.
+         *
+         * Bodies already in the world are moved over to the new one.
+         * @param settings The settings to apply.
+         */
+        static void ApplySettings(const PhysicsSettings& settings);
+        /** @brief Gets the settings the world was built with. */
+        static const PhysicsSettings& GetSettings() { return m_Settings; }
+        /**
+         * @brief Walks the rigidbody view once and splits the bodies by type.
+         * @param registry The scene registry.
+         * @param batch The batch to fill, previous contents are discarded.
+         */
+        static void BuildRigidbodyBatch(entt::registry& registry, RigidbodyBatch& batch);
+        /**
+         * @brief Moves kinematic bodies by their velocity and pushes the result to Bullet.
+         * @param registry The scene registry.
+         * @param batch The batch built this tick.
          * @param dt Delta time.
          */
-        static void ApplyRigidbody(RigidbodyComponent& rigidbodyComponent, TransformComponent& transformComponent,
-                                   float dt);
-        /** @brief Gets the physics world. */
-        static btDynamicsWorld* GetWorld() { return m_world; }
+        static void ApplyKinematicBodies(entt::registry& registry, const RigidbodyBatch& batch, float dt);
+        /**
+         * @brief Writes the poses published by the last finished step back into the scene.
+         * @param registry The scene registry.
+         */
+        static void ApplyRigidbodies(entt::registry& registry);
+        /**
+         * @brief Collects the points the simulation LOD rings are centred on.
+         *
+         * The rings follow the last camera in the scene and every entity with a
+         * PhysicsLodAnchorComponent. Call between WaitForStep and BeginStep.
+         * @param registry The scene registry.
+         */
+        static void CollectLodAnchors(entt::registry& registry);
+        /** @brief Gets the motion states whose render pose may still change, see ApplyRigidbodies. */
+        static const std::vector<PhysicsMotionState*>& GetMovedBodies() { return m_MovedBodies; }
+        /** @brief Gets the per-phase timings and island breakdown of the last finished update. */
+        static const PhysicsStats& GetStats() { return m_Stats[m_FrontBuffer]; }
+        /** @brief Gets the projectile hits of the last finished update, indexed by ContactEvent::Hit. */
+        static const std::vector<ProjectileHit>& GetProjectileHits() { return m_ProjectileHits[m_FrontBuffer]; }
+        /** @brief Gets the contact events of the last finished update, in dispatch order. */
+        static const std::vector<ContactEvent>& GetContactEvents() { return m_ContactEvents[m_FrontBuffer]; }
+        /** @brief Gets the fraction of a tick elapsed since the last fixed tick, used to interpolate poses. */
+        static float GetInterpolationAlpha() { return m_InterpolationAlpha; }
+        /** @brief Gets the physics world, waiting for an in-flight step first. */
+        static btDynamicsWorld* GetWorld()
+        {
+            WaitForStep();
+            return m_world;
+        }
         /** @brief Sets the gravity of the physics world. */
         static void SetGravity(const glm::vec3& gravity);
         /** @brief Gets the current gravity setting. */
         static glm::vec3 GetGravity();
 
-        /** @brief Processes trigger events for collision detection. */
-        static void ProcessTriggerEvents();
+        /**
+         * @brief Fires the contact callbacks for the events of the last finished step.
+         *
+         * Enter events drive CollisionCallbacks::m_OnContactStarted and Collider::OnCollision, stay
+         * events m_OnContactStay and exit events m_OnContactEnded. Projectile hits drive
+         * m_OnProjectileHit of the object hit.
+         *
+         * The events are taken out of the front buffer before the first callback runs, so each is
+         * dispatched once and callbacks may destroy objects: the events of a destroyed object are
+         * dropped instead of reaching the callbacks after it.
+         */
+        static void DispatchContactEvents();
+        /**
+         * @brief Hands the debug lines of the last finished step to the DebugRenderer.
+         *
+         * Does nothing unless PhysicsSettings::DebugDrawEnabled is set. The next step only draws what
+         * is inside the given frustum. Call between Renderer::BeginScene and Renderer::EndScene.
+         * @param frustum The frustum of the camera the scene is rendered from.
+         */
+        static void SubmitDebugLines(const Frustum& frustum);
+        /**
+         * @brief Draws the world as it is now and hands the lines to the DebugRenderer, for views that don't step.
+         * @param frustum Objects outside it are skipped.
+         */
+        static void DrawDebugWorld(const Frustum& frustum);
         /** @brief Sets the position of a collision object. */
         static void SetPosition(btCollisionObject* object, const glm::vec3& position);
         /** @brief Gets the position of a collision object. */
@@ -87,7 +188,24 @@ namespace Coffee
         /** @brief Destroys a collision object. */
         static void DestroyCollisionObject(btCollisionObject* object);
 
-        /** @brief Creates a collision shape based on configuration. */
+        /**
+         * @brief Adds a collision object built by the caller to the world.
+         *
+         * The object counts towards the open batch like the ones from CreateCollisionObject and is
+         * destroyed through DestroyCollisionObject, which frees it once it has left the world.
+         *
+         * @param object Object from PhysicsArena with its shape and transform set.
+         * @param layer Collision layer of the object.
+         * @param ownsShape Whether the shape is handed over and deleted with the object, otherwise
+         *        it is released to CollisionShapeCache.
+         */
+        static void AddCollisionObject(btCollisionObject* object, int layer, bool ownsShape = false);
+
+        /**
+         * @brief Gets a shared collision shape matching the configuration.
+         *
+         * The shape comes from CollisionShapeCache, release it there when the body using it goes away.
+         */
         static btCollisionShape* CreateCollisionShape(const CollisionShapeConfig& config);
 
         
@@ -111,13 +229,96 @@ namespace Coffee
          * @brief Creates a rigid body.
          * @param colCallbacks Pointer to collision callbacks.
          * @param config The rigid body configuration.
+         * @param startTransform The initial world transform of the body.
+         * @param shape Shape to share instead of the one described by config.shapeConfig, the body
+         *        retains it in CollisionShapeCache.
          * @return Pointer to the created rigid body.
          */
-        static btRigidBody* CreateRigidBody(CollisionCallbacks* colCallbacks, const RigidBodyConfig& config);
+        static btRigidBody* CreateRigidBody(CollisionCallbacks* colCallbacks, const RigidBodyConfig& config,
+                                            const btTransform& startTransform = btTransform::getIdentity(),
+                                            btCollisionShape* shape = nullptr);
+
+        /**
+         * @brief Moves a collision object to another collision layer.
+         *
+         * The filter is applied to the broadphase proxy, so pairs the new layer doesn't collide
+         * with are dropped before they reach the narrowphase.
+         */
+        static void SetCollisionLayer(btCollisionObject* object, int layer);
+        /** @brief Gets the collision layer of an object in the world, 0 if it isn't in one. */
+        static int GetCollisionLayer(const btCollisionObject* object);
+
+        /**
+         * @brief Sets up continuous collision detection for a body from the extents of its shape.
+         *
+         * With PhysicsType::CONTINUOUS the body is swept between ticks whenever it moves farther
+         * than its own inner radius in one tick, slower bodies are left to the discrete narrowphase.
+         * With any other type CCD is turned off.
+         */
+        static void ApplyContinuousCollision(btRigidBody* body);
+        /** @brief Gets the broadphase filter group of a collision layer. */
+        static int GetCollisionGroup(int layer) { return static_cast<int>(1u << layer); }
+        /** @brief Gets the broadphase filter mask of a collision layer from the collision matrix. */
+        static int GetCollisionMask(int layer) { return static_cast<int>(m_Settings.CollisionMatrix[layer]); }
 
         /** @brief Removes a rigid body from the physics world. */
         static void RemoveRigidBody(btRigidBody* rigidBody);
 
+        /**
+         * @brief Starts a batch of insertions and removals, used when a level section loads or unloads.
+         *
+         * Until the batch ends, objects added to the world skip the broadphase pair query Bullet
+         * runs on every insertion, and destroyed objects are queued instead of being removed.
+         * Ending the batch removes the queued objects with a single pass over the pair cache,
+         * rebuilds the dynamic broadphase tree once and finds the pairs of the new objects in
+         * one tree-against-tree pass. Batches nest, the work is done when the outermost one ends.
+         * Call from the main thread, a step started inside a batch flushes it first.
+         */
+        static void BeginBatch();
+        /** @brief Ends a batch started by BeginBatch. */
+        static void EndBatch();
+
+        /**
+         * @brief Saves the dynamic state of the world for Restore.
+         *
+         * Transforms, velocities, forces, activation, the LOD state and the contact points with
+         * their warm-starting impulses are copied into the flat arrays of the snapshot. The world
+         * itself is only read, taking a snapshot never changes how it steps.
+         *
+         * Only the world is saved. Vehicles, character controllers and projectiles keep their own
+         * state outside of it and are not part of the snapshot, restore them separately or
+         * recreate them after Restore.
+         * @param snapshot The snapshot to fill, its buffers are reused.
+         */
+        static void Snapshot(PhysicsSnapshot& snapshot);
+        /**
+         * @brief Puts the world back in the state saved by Snapshot.
+         *
+         * The broadphase trees, pair cache and contact manifolds are rebuilt from the saved state
+         * in a fixed order, so every restore of a snapshot steps bit for bit the same from there.
+         * The world the snapshot was taken from grew its caches in another order and may drift in
+         * the last bits. Pending CCD predictive contacts and the parallel world's threaded
+         * narrowphase are not replayed exactly. The contact tracker is rebuilt from the restored
+         * manifolds and the pending contact events and projectile hits are dropped.
+         * @param snapshot A snapshot of this world holding the same objects in the same order.
+         * @return False if the objects in the world changed since the snapshot, nothing is restored then.
+         */
+        static bool Restore(const PhysicsSnapshot& snapshot);
+
+        /**
+         * @class BatchScope
+         * @brief Keeps a batch open for the lifetime of the object.
+         */
+        class BatchScope
+        {
+          public:
+            BatchScope() { BeginBatch(); }
+            ~BatchScope() { EndBatch(); }
+
+            BatchScope(const BatchScope&) = delete;
+            BatchScope& operator=(const BatchScope&) = delete;
+        };
+
 
         static glm::vec3 GlobalGravity;
             
@@ -131,14 +332,118 @@ namespace Coffee
         static btDispatcher* m_dispatcher;                 ///< Collision dispatcher.
         static btBroadphaseInterface* m_broad_phase;       ///< Broadphase collision detection.
         static btConstraintSolver* m_solver;               ///< Constraint solver.
+        static btConstraintSolver* m_solverMt;             ///< Per-island solver used by the parallel world.
+
+        static btITaskScheduler* m_TaskScheduler; ///< Task scheduler used by the parallel world.
+        static PhysicsSettings m_Settings;        ///< Settings the world was built with.
+
+        /** @brief Creates the world and its components according to m_Settings. */
+        static void CreateWorld();
+        /** @brief Deletes the world and its components without touching the collision objects. */
+        static void DestroyWorld();
 
         
 
         static std::vector<btCollisionObject*> m_CollisionObjects; ///< List of collision objects.
-        static std::vector<btCollisionShape*> m_CollisionShapes;   ///< List of collision shapes.
 
         static std::vector<RigidBody*> m_Rigidbodies; ///< List of rigid bodies.
 
+        static std::vector<PhysicsMotionState*> m_MovedBodies; ///< Bodies moving between ticks, filled by motion states.
+
+        static float m_Accumulator;        ///< Frame time not yet consumed by a fixed tick.
+        static float m_InterpolationAlpha; ///< m_Accumulator as a fraction of a tick.
+        static uint64_t m_TickCount;       ///< Fixed ticks run since the engine started.
+
+        /**
+         * @struct LodAnchor
+         * @brief Centre of a set of simulation LOD rings.
+         */
+        struct LodAnchor
+        {
+            btVector3 Position;      ///< World position of the anchor.
+            btScalar RadiusScale;    ///< Multiplies the ring radii.
+        };
+
+        static std::vector<LodAnchor> m_LodAnchors;       ///< Anchors collected for the next step.
+        static std::vector<btRigidBody*> m_LodScaledBodies; ///< Bodies whose velocity is scaled for the current tick.
+        static bool m_LodActive;                            ///< Whether any body may be frozen or assigned to a ring.
+
+        static PhysicsStats m_Stats[2];                     ///< Update stats, the back buffer is written by the step.
+        static std::vector<uint32_t> m_IslandBodyCounter;   ///< Bodies per island tag, reused by CountIslands.
+
+        static std::vector<BodyPose> m_PoseBuffers[2]; ///< Published poses, the back buffer is written by the step.
+        static int m_FrontBuffer;                      ///< Index of the pose and event buffers read by the scene.
+
+        static ContactTracker m_ContactTracker;                ///< Touching pairs carried between ticks.
+        static std::vector<ContactEvent> m_ContactEvents[2]; ///< Contact events, the back buffer is written by the step.
+        static std::vector<ContactEvent> m_DispatchedEvents; ///< Events being dispatched, swapped out of the front buffer.
+        static std::vector<ProjectileHit> m_ProjectileHits[2]; ///< Projectile hits, the back buffer is written by the step.
+
+        static PhysicsDebugDrawer m_DebugDrawer;          ///< Debug drawer installed in the world.
+        static std::vector<DebugVertex> m_DebugLines[2];  ///< Debug lines, the back buffer is written by the step.
+        static std::optional<Frustum> m_NextDebugFrustum; ///< Frustum given by the scene for the next step.
+        static std::optional<Frustum> m_DebugFrustum;     ///< Frustum the running step culls its debug lines against.
+
+        static PhysicsCommandQueue m_Commands; ///< Commands waiting for the next tick.
+
+        static int m_BatchDepth;                                  ///< Open BeginBatch calls.
+        static int m_BatchInserted;                               ///< Objects added to the world in the open batch.
+        static std::vector<btCollisionObject*> m_PendingDestroys; ///< Objects destroyed in the open batch.
+        static std::unordered_set<btCollisionShape*> m_OwnedShapes; ///< Shapes handed over by AddCollisionObject.
+
+        static std::thread m_PhysicsThread;               ///< Thread running asynchronous steps.
+        static std::mutex m_StepMutex;                    ///< Guards the step handoff state below.
+        static std::condition_variable m_StepCondition;   ///< Signals step requests and completions.
+        static float m_PendingDt;                         ///< Delta time of the requested step.
+        static bool m_StepPending;                        ///< Whether a step is requested or running.
+        static bool m_StepFinished;                       ///< Whether a finished step has not been swapped in yet.
+        static bool m_StopThread;                         ///< Asks the physics thread to exit.
+
+        /** @brief Body of the physics thread, runs a step every time one is requested. */
+        static void PhysicsThreadLoop();
+        /** @brief Stops and joins the physics thread after its current step. */
+        static void StopPhysicsThread();
+        /** @brief Applies every queued command. */
+        static void ExecuteCommands();
+        /** @brief Applies a single command to its body. */
+        static void ExecuteCommand(const PhysicsCommand& command);
+        /** @brief Copies the interpolated pose of every moving body into the back pose buffer. */
+        static void PublishPoses();
+        /** @brief Counts the bodies and contacts of the tick that just ran and records them in PhysicsTelemetry. */
+        static void RecordTelemetry(float stepTimeMs);
+        /** @brief Fills the island count and bodies per island of the world after the last tick. */
+        static void CountIslands(PhysicsStats& stats);
+        /** @brief Sizes the projectile pool and the hit buffers from PhysicsSettings::MaxProjectiles. */
+        static void ReserveProjectiles();
+        /**
+         * @brief Freezes the bodies skipping this tick and scales the ones catching up.
+         *
+         * A body in ring n > 0 steps once every 2^n ticks, with its velocity and gravity scaled
+         * so it covers the ticks it skipped. Bodies past the last ring stay asleep.
+         */
+        static void ApplyLod(uint64_t tick);
+        /** @brief Undoes the velocity and gravity scaling applied by ApplyLod after the tick ran. */
+        static void FinishLodStep();
+        /** @brief Wakes every body frozen by LOD and puts all of them back in the full-rate ring. */
+        static void ReleaseLod();
+        /** @brief Gets the LOD ring of a position from its distance to the nearest anchor. */
+        static uint8_t GetLodRing(const btVector3& position);
+        /** @brief Reapplies the collision matrix to the filter of every object in the world. */
+        static void RefreshCollisionFilters();
+        /** @brief Reapplies ApplyContinuousCollision to every rigid body in the world. */
+        static void RefreshContinuousCollision();
+        /** @brief Drops the contact state and pending events of an object leaving the world. */
+        static void ForgetCollisionObject(const btCollisionObject* object);
+        /** @brief Removes and frees the objects destroyed in the batch and finds the pairs of the ones added. */
+        static void FlushBatch();
+        /** @brief Deletes a shape handed over by AddCollisionObject, or releases it to CollisionShapeCache. */
+        static void ReleaseShape(btCollisionShape* shape);
+        /** @brief Writes a snapshot into the world and rebuilds the broadphase and contact caches from it. */
+        static void ApplySnapshot(const PhysicsSnapshot& snapshot);
+
         friend class RigidBody; ///< Grant RigidBody access to private members.
+        friend class PhysicsMotionState; ///< Grant PhysicsMotionState access to the moved-bodies list.
+        friend class CharacterSystem; ///< Grant CharacterSystem access to the contact state of the capsules.
+        friend class ProjectileSystem; ///< Grant ProjectileSystem access to the front buffer index.
     };
 } // namespace Coffee
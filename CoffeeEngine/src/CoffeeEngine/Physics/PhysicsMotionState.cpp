@@ -0,0 +1,42 @@
+#include "PhysicsMotionState.h"
+#include "PhysicsEngine.h"
+
+#include <algorithm>
+
+namespace Coffee
+{
+
+    PhysicsMotionState::~PhysicsMotionState()
+    {
+        if (!m_Moved)
+            return;
+
+        auto& movedBodies = PhysicsEngine::m_MovedBodies;
+        auto it = std::find(movedBodies.begin(), movedBodies.end(), this);
+        if (it != movedBodies.end())
+        {
+            *it = movedBodies.back();
+            movedBodies.pop_back();
+        }
+    }
+
+    void PhysicsMotionState::setWorldTransform(const btTransform& worldTrans)
+    {
+        m_Transform = worldTrans;
+
+        if (!m_Moved && m_Entity != entt::null)
+        {
+            m_Moved = true;
+            PhysicsEngine::m_MovedBodies.push_back(this);
+        }
+    }
+
+    btTransform PhysicsMotionState::GetInterpolatedTransform(btScalar alpha) const
+    {
+        btTransform transform;
+        transform.setOrigin(m_PreviousTransform.getOrigin().lerp(m_Transform.getOrigin(), alpha));
+        transform.setRotation(m_PreviousTransform.getRotation().slerp(m_Transform.getRotation(), alpha));
+        return transform;
+    }
+
+} // namespace Coffee
@@ -0,0 +1,79 @@
+/**
+ * @file PhysicsMotionState.h
+ * @brief Declares the PhysicsMotionState class used to track bodies moved by the simulation.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <entt/entity/entity.hpp>
+
+#include <cstdint>
+
+namespace Coffee
+{
+
+    /**
+     * @class PhysicsMotionState
+     * @brief Motion state that records which entities Bullet moved during a step.
+     *
+     * Bullet only calls setWorldTransform for active dynamic bodies, so sleeping bodies never
+     * reach the moved-bodies list and the scene skips them when writing transforms back.
+     * The pose before the last tick is kept so rendering can interpolate between fixed ticks.
+     */
+    class PhysicsMotionState : public btMotionState
+    {
+      public:
+        explicit PhysicsMotionState(const btTransform& startTransform = btTransform::getIdentity())
+            : m_Transform(startTransform), m_PreviousTransform(startTransform)
+        {
+        }
+        /** @brief Removes the motion state from the moved-bodies list if it is still in it. */
+        ~PhysicsMotionState() override;
+
+        /** @brief Called by Bullet to read the initial and kinematic pose. */
+        void getWorldTransform(btTransform& worldTrans) const override { worldTrans = m_Transform; }
+
+        /** @brief Called by Bullet for every body that moved during the step. */
+        void setWorldTransform(const btTransform& worldTrans) override;
+
+        /** @brief Sets the pose from the engine side without flagging the body as moved, teleports are not interpolated. */
+        void SetTransform(const btTransform& transform)
+        {
+            m_Transform = transform;
+            m_PreviousTransform = transform;
+        }
+        /** @brief Gets the last pose written by Bullet or the engine. */
+        const btTransform& GetTransform() const { return m_Transform; }
+        /**
+         * @brief Gets the pose between the previous and the last tick.
+         * @param alpha Fraction of a tick elapsed since the last one, in [0, 1].
+         */
+        btTransform GetInterpolatedTransform(btScalar alpha) const;
+
+        /** @brief Sets the entity reported when the body moves. */
+        void SetEntity(entt::entity entity) { m_Entity = entity; }
+        /** @brief Gets the entity reported when the body moves. */
+        entt::entity GetEntity() const { return m_Entity; }
+
+        /** @brief Sets the body driven by this motion state. */
+        void SetBody(const btRigidBody* body) { m_Body = body; }
+        /** @brief Gets the body driven by this motion state. */
+        const btRigidBody* GetBody() const { return m_Body; }
+
+      private:
+        btTransform m_Transform;           ///< Last known world transform.
+        btTransform m_PreviousTransform;   ///< World transform before the last tick.
+        entt::entity m_Entity = entt::null; ///< Owning entity, null until the body is attached to a scene.
+        const btRigidBody* m_Body = nullptr; ///< Body driven by this motion state.
+        bool m_Moved = false;              ///< Whether the state is in the moved-bodies list.
+
+        uint8_t m_LodRing = 0;             ///< LOD ring of the body, 0 steps every tick.
+        bool m_LodFrozen = false;          ///< Whether LOD put the body to sleep.
+        btVector3 m_LodLinearVelocity = btVector3(0, 0, 0);  ///< Linear velocity saved when LOD froze the body.
+        btVector3 m_LodAngularVelocity = btVector3(0, 0, 0); ///< Angular velocity saved when LOD froze the body.
+
+        friend class PhysicsEngine; ///< Grant PhysicsEngine access to the interpolation state.
+    };
+
+} // namespace Coffee
@@ -0,0 +1,190 @@
+#include "PhysicsProfiler.h"
+
+#include <LinearMath/btQuickprof.h>
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef TRACY_ENABLE
+#include <tracy/TracyC.h>
+#endif
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr int kNoPhase = -1;
+        constexpr int kMaxZoneDepth = 64;
+
+        /** @brief Bullet zone names and the phase they are counted in. */
+        struct PhaseZone
+        {
+            const char* Name;
+            PhysicsPhase Phase;
+        };
+
+        constexpr PhaseZone kPhaseZones[] = {
+            {"updateAabbs", PhysicsPhase::Broadphase},
+            {"calculateOverlappingPairs", PhysicsPhase::Broadphase},
+            {"dispatchAllCollisionPairs", PhysicsPhase::Narrowphase},
+            {"createPredictiveContacts", PhysicsPhase::Narrowphase},
+            {"calculateSimulationIslands", PhysicsPhase::Islands},
+            {"updateActivationState", PhysicsPhase::Islands},
+            {"solveConstraints", PhysicsPhase::Solver},
+            {"predictUnconstraintMotion", PhysicsPhase::Integration},
+            {"integrateTransforms", PhysicsPhase::Integration},
+            {"synchronizeMotionStates", PhysicsPhase::Integration},
+        };
+
+        /** @brief What a Bullet zone name maps to, resolved once per name. */
+        struct ZoneInfo
+        {
+            int Phase = kNoPhase;
+#ifdef TRACY_ENABLE
+            const ___tracy_source_location_data* SourceLocation = nullptr;
+#endif
+        };
+
+        struct OpenZone
+        {
+            int Phase;
+            std::chrono::steady_clock::time_point Start;
+#ifdef TRACY_ENABLE
+            TracyCZoneCtx Context;
+#endif
+        };
+
+        // Per thread, so only the zones of the thread calling Reset and Collect are reported
+        thread_local uint64_t t_PhaseNanoseconds[PhysicsPhaseCount] = {};
+
+        thread_local OpenZone t_ZoneStack[kMaxZoneDepth];
+        thread_local int t_ZoneDepth = 0;
+
+        /**
+         * @brief Resolves a zone name, caching the result per thread.
+         *
+         * Tracy keeps pointers to source locations for the lifetime of the program, so they are
+         * created once per name in a shared registry and never freed.
+         */
+        const ZoneInfo& GetZoneInfo(const char* name)
+        {
+            thread_local std::unordered_map<const char*, ZoneInfo> cache;
+
+            auto it = cache.find(name);
+            if (it != cache.end())
+                return it->second;
+
+            ZoneInfo info;
+            for (const PhaseZone& zone : kPhaseZones)
+            {
+                if (std::strcmp(zone.Name, name) == 0)
+                {
+                    info.Phase = static_cast<int>(zone.Phase);
+                    break;
+                }
+            }
+
+#ifdef TRACY_ENABLE
+            static std::mutex registryMutex;
+            static std::unordered_map<std::string_view, const ___tracy_source_location_data*> registry;
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            const ___tracy_source_location_data*& sourceLocation = registry[name];
+            if (!sourceLocation)
+                sourceLocation = new ___tracy_source_location_data{name, name, "Bullet", 0, 0};
+            info.SourceLocation = sourceLocation;
+#endif
+
+            return cache.emplace(name, info).first->second;
+        }
+    } // namespace
+
+    const char* GetPhysicsPhaseName(PhysicsPhase phase)
+    {
+        switch (phase)
+        {
+        case PhysicsPhase::Broadphase:
+            return "Broadphase";
+        case PhysicsPhase::Narrowphase:
+            return "Narrowphase";
+        case PhysicsPhase::Islands:
+            return "Islands";
+        case PhysicsPhase::Solver:
+            return "Solver";
+        case PhysicsPhase::Integration:
+            return "Integration";
+        default:
+            return "Unknown";
+        }
+    }
+
+    void PhysicsProfiler::Install()
+    {
+        btSetCustomEnterProfileZoneFunc(&PhysicsProfiler::EnterZone);
+        btSetCustomLeaveProfileZoneFunc(&PhysicsProfiler::LeaveZone);
+    }
+
+    void PhysicsProfiler::Reset()
+    {
+        for (uint64_t& nanoseconds : t_PhaseNanoseconds)
+            nanoseconds = 0;
+    }
+
+    void PhysicsProfiler::Collect(std::array<float, PhysicsPhaseCount>& microseconds)
+    {
+        for (size_t i = 0; i < PhysicsPhaseCount; ++i)
+            microseconds[i] = static_cast<float>(t_PhaseNanoseconds[i]) / 1000.0f;
+    }
+
+    void PhysicsProfiler::EnterZone(const char* name)
+    {
+        // Keep counting past the limit so enters and leaves stay paired
+        const int depth = t_ZoneDepth++;
+        if (depth >= kMaxZoneDepth)
+            return;
+
+        const ZoneInfo& info = GetZoneInfo(name);
+        OpenZone& zone = t_ZoneStack[depth];
+
+        // Phases nested in the same phase on this thread are already being timed
+        zone.Phase = info.Phase;
+        for (int i = 0; i < depth && zone.Phase != kNoPhase; ++i)
+        {
+            if (t_ZoneStack[i].Phase == zone.Phase)
+                zone.Phase = kNoPhase;
+        }
+        if (zone.Phase != kNoPhase)
+            zone.Start = std::chrono::steady_clock::now();
+
+#ifdef TRACY_ENABLE
+        zone.Context = ___tracy_emit_zone_begin(info.SourceLocation, 1);
+#endif
+    }
+
+    void PhysicsProfiler::LeaveZone()
+    {
+        if (t_ZoneDepth == 0)
+            return;
+
+        const int depth = --t_ZoneDepth;
+        if (depth >= kMaxZoneDepth)
+            return;
+
+        const OpenZone& zone = t_ZoneStack[depth];
+
+#ifdef TRACY_ENABLE
+        ___tracy_emit_zone_end(zone.Context);
+#endif
+
+        if (zone.Phase != kNoPhase)
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - zone.Start;
+            t_PhaseNanoseconds[zone.Phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+    }
+
+} // namespace Coffee
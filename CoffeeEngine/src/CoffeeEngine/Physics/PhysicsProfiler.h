@@ -0,0 +1,82 @@
+/**
+ * @file PhysicsProfiler.h
+ * @brief Declares the bridge from Bullet's profiling hooks to Tracy and the per-phase physics stats.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @enum PhysicsPhase
+     * @brief Stages of a Bullet step timed by PhysicsProfiler.
+     */
+    enum class PhysicsPhase
+    {
+        Broadphase,  ///< Updating AABBs and finding overlapping pairs.
+        Narrowphase, ///< Generating contacts for the overlapping pairs.
+        Islands,     ///< Building simulation islands and updating sleep states.
+        Solver,      ///< Solving contacts and constraints.
+        Integration, ///< Predicting and integrating motion, syncing motion states.
+        Count
+    };
+
+    constexpr size_t PhysicsPhaseCount = static_cast<size_t>(PhysicsPhase::Count);
+
+    /** @brief Gets the display name of a phase. */
+    const char* GetPhysicsPhaseName(PhysicsPhase phase);
+
+    /**
+     * @struct PhysicsStats
+     * @brief Cost breakdown of the last physics update.
+     */
+    struct PhysicsStats
+    {
+        uint32_t Ticks = 0;                                      ///< Fixed ticks run by the update.
+        float StepMicroseconds = 0.0f;                           ///< Time spent in stepSimulation across the ticks.
+        std::array<float, PhysicsPhaseCount> PhaseMicroseconds{}; ///< Wall time per phase on the stepping thread across the ticks.
+        uint32_t Islands = 0;                                    ///< Simulation islands after the last tick.
+        std::vector<uint32_t> IslandBodyCounts;                  ///< Bodies per island, largest first.
+
+        /** @brief Gets the wall time spent in a phase. */
+        float GetPhaseMicroseconds(PhysicsPhase phase) const { return PhaseMicroseconds[static_cast<size_t>(phase)]; }
+    };
+
+    /**
+     * @class PhysicsProfiler
+     * @brief Routes Bullet's BT_PROFILE zones to Tracy and accumulates the wall time spent per phase.
+     *
+     * Every Bullet zone becomes a Tracy zone of the same name on the thread that entered it.
+     * Zones matching a PhysicsPhase are also timed, but only on the thread calling Reset and
+     * Collect, the one stepping the world. A phase Bullet spreads over its workers is entered on
+     * that thread too, which waits for them, so PhysicsStats reports wall time rather than the
+     * CPU time summed over every worker. Per-worker costs are in the Tracy zones.
+     * Bullet built with BT_NO_PROFILE never calls the hooks and every phase reads zero.
+     */
+    class PhysicsProfiler
+    {
+      public:
+        /** @brief Installs the profiling hooks into Bullet. */
+        static void Install();
+        /** @brief Zeroes the phase timings of the calling thread, call before stepping on the stepping thread. */
+        static void Reset();
+        /**
+         * @brief Copies the phase timings the calling thread accumulated since its last Reset.
+         * @param microseconds Receives the wall time per phase.
+         */
+        static void Collect(std::array<float, PhysicsPhaseCount>& microseconds);
+
+      private:
+        /** @brief Called by Bullet when a profile zone starts. */
+        static void EnterZone(const char* name);
+        /** @brief Called by Bullet when the innermost profile zone ends. */
+        static void LeaveZone();
+    };
+
+} // namespace Coffee
@@ -0,0 +1,234 @@
+#include "PhysicsQueries.h"
+#include "CharacterController.h"
+#include "PhysUtils.h"
+#include "PhysicsEngine.h"
+#include "PhysicsMotionState.h"
+
+#include <LinearMath/btThreads.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr int kGrainSize = 64; ///< Queries handed to a worker at a time.
+
+        entt::entity GetEntity(const btCollisionObject* object)
+        {
+            if (const btRigidBody* body = btRigidBody::upcast(object))
+            {
+                if (auto* motionState = static_cast<const PhysicsMotionState*>(body->getMotionState()))
+                    return motionState->GetEntity();
+            }
+
+            // Character capsules are plain collision objects, their controller knows the entity
+            const auto* callbacks = static_cast<const CollisionCallbacks*>(object->getUserPointer());
+            if (callbacks && callbacks->character)
+                return callbacks->character->GetEntity();
+
+            return entt::null;
+        }
+
+        /**
+         * @brief Closest hit of a query, skipping triggers and ghosts when asked to.
+         *
+         * Same filter as the character sweeps and the wheel probes: nothing without contact
+         * response stops a query that only wants solid geometry. Objects of the ignored entity
+         * are skipped here too, so whatever lies behind them can still be the closest hit.
+         */
+        template <class ResultCallback> struct ClosestHitCallback : public ResultCallback
+        {
+            ClosestHitCallback(const btVector3& from, const btVector3& to, bool ignoreTriggers,
+                               entt::entity ignoredEntity)
+                : ResultCallback(from, to), m_IgnoreTriggers(ignoreTriggers), m_IgnoredEntity(ignoredEntity)
+            {
+            }
+
+            bool needsCollision(btBroadphaseProxy* proxy) const override
+            {
+                if (!ResultCallback::needsCollision(proxy))
+                    return false;
+
+                const auto* object = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+                if (m_IgnoreTriggers && (!object->hasContactResponse() ||
+                                         object->getInternalType() == btCollisionObject::CO_GHOST_OBJECT))
+                    return false;
+
+                return m_IgnoredEntity == entt::null || GetEntity(object) != m_IgnoredEntity;
+            }
+
+            bool m_IgnoreTriggers;
+            entt::entity m_IgnoredEntity;
+        };
+
+        /**
+         * @brief Runs the narrowphase on every object whose broadphase bounds the ray crosses.
+         *
+         * Mirrors the ray callback btCollisionWorld::rayTest uses internally.
+         */
+        struct ClosestRayBroadphaseCallback : public btBroadphaseRayCallback
+        {
+            ClosestRayBroadphaseCallback(const btVector3& from, const btVector3& to,
+                                         btCollisionWorld::ClosestRayResultCallback& result)
+                : m_From(btQuaternion::getIdentity(), from), m_To(btQuaternion::getIdentity(), to), m_Result(result)
+            {
+                btVector3 direction = (to - from).normalized();
+
+                m_rayDirectionInverse[0] = direction[0] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[0];
+                m_rayDirectionInverse[1] = direction[1] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[1];
+                m_rayDirectionInverse[2] = direction[2] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[2];
+                m_signs[0] = m_rayDirectionInverse[0] < 0.0;
+                m_signs[1] = m_rayDirectionInverse[1] < 0.0;
+                m_signs[2] = m_rayDirectionInverse[2] < 0.0;
+
+                m_lambda_max = direction.dot(to - from);
+            }
+
+            bool process(const btBroadphaseProxy* proxy) override
+            {
+                // A hit at the very start can't be beaten
+                if (m_Result.m_closestHitFraction == btScalar(0.f))
+                    return false;
+
+                auto* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+                if (m_Result.needsCollision(object->getBroadphaseHandle()))
+                {
+                    btCollisionWorld::rayTestSingle(m_From, m_To, object, object->getCollisionShape(),
+                                                    object->getWorldTransform(), m_Result);
+                }
+                return true;
+            }
+
+            btTransform m_From;
+            btTransform m_To;
+            btCollisionWorld::ClosestRayResultCallback& m_Result;
+        };
+
+        void WriteHit(const QueryHits& hits, size_t index, const btCollisionObject* object, float distance,
+                      const btVector3& point, const btVector3& normal)
+        {
+            if (!hits.Objects.empty())
+                hits.Objects[index] = object;
+            if (!hits.Distances.empty())
+                hits.Distances[index] = object ? distance : 0.0f;
+            if (!hits.Points.empty())
+                hits.Points[index] = PhysUtils::BulletToGlm(point);
+            if (!hits.Normals.empty())
+                hits.Normals[index] = PhysUtils::BulletToGlm(normal);
+            if (!hits.Entities.empty())
+                hits.Entities[index] = object ? GetEntity(object) : entt::null;
+        }
+
+        float GetMaxDistance(const RayBatch& batch, size_t index)
+        {
+            return batch.MaxDistances.empty() ? batch.MaxDistance : batch.MaxDistances[index];
+        }
+
+        entt::entity GetIgnoredEntity(const RayBatch& batch, size_t index)
+        {
+            return batch.IgnoreEntities.empty() ? entt::null : batch.IgnoreEntities[index];
+        }
+
+        struct RaycastJob : public btIParallelForBody
+        {
+            RaycastJob(btBroadphaseInterface* broadphase, const RayBatch& rays, const QueryHits& hits)
+                : m_Broadphase(broadphase), m_Rays(rays), m_Hits(hits)
+            {
+            }
+
+            void forLoop(int begin, int end) const override
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    const float maxDistance = GetMaxDistance(m_Rays, i);
+                    const btVector3 from = PhysUtils::GlmToBullet(m_Rays.Origins[i]);
+                    const btVector3 to = PhysUtils::GlmToBullet(m_Rays.Origins[i] + m_Rays.Directions[i] * maxDistance);
+
+                    ClosestHitCallback<btCollisionWorld::ClosestRayResultCallback> result(
+                        from, to, m_Rays.IgnoreTriggers, GetIgnoredEntity(m_Rays, i));
+                    result.m_collisionFilterMask = m_Rays.CollisionMask;
+
+                    ClosestRayBroadphaseCallback rayCallback(from, to, result);
+                    m_Broadphase->rayTest(from, to, rayCallback);
+
+                    WriteHit(m_Hits, i, result.m_collisionObject, result.m_closestHitFraction * maxDistance,
+                             result.m_hitPointWorld, result.m_hitNormalWorld);
+                }
+            }
+
+            btBroadphaseInterface* m_Broadphase;
+            const RayBatch& m_Rays;
+            const QueryHits& m_Hits;
+        };
+
+        struct SphereCastJob : public btIParallelForBody
+        {
+            SphereCastJob(btCollisionWorld* world, const SweepBatch& sweeps, const QueryHits& hits)
+                : m_World(world), m_Sweeps(sweeps), m_Hits(hits)
+            {
+            }
+
+            void forLoop(int begin, int end) const override
+            {
+                btSphereShape sphere(m_Sweeps.Radius);
+
+                for (int i = begin; i < end; ++i)
+                {
+                    const float maxDistance = GetMaxDistance(m_Sweeps, i);
+                    const btVector3 from = PhysUtils::GlmToBullet(m_Sweeps.Origins[i]);
+                    const btVector3 to =
+                        PhysUtils::GlmToBullet(m_Sweeps.Origins[i] + m_Sweeps.Directions[i] * maxDistance);
+
+                    ClosestHitCallback<btCollisionWorld::ClosestConvexResultCallback> result(
+                        from, to, m_Sweeps.IgnoreTriggers, GetIgnoredEntity(m_Sweeps, i));
+                    result.m_collisionFilterMask = m_Sweeps.CollisionMask;
+
+                    m_World->convexSweepTest(&sphere, btTransform(btQuaternion::getIdentity(), from),
+                                             btTransform(btQuaternion::getIdentity(), to), result);
+
+                    WriteHit(m_Hits, i, result.m_hitCollisionObject, result.m_closestHitFraction * maxDistance,
+                             result.m_hitPointWorld, result.m_hitNormalWorld);
+                }
+            }
+
+            btCollisionWorld* m_World;
+            const SweepBatch& m_Sweeps;
+            const QueryHits& m_Hits;
+        };
+    } // namespace
+
+    void PhysicsQueries::RaycastBatch(const RayBatch& rays, const QueryHits& hits)
+    {
+        ZoneScoped;
+
+        // Scripts query after BeginStep, the tree and the task scheduler belong to the step until it ends
+        PhysicsEngine::WaitForStep();
+
+        RaycastBatch(PhysicsEngine::GetWorld(), rays, hits);
+    }
+
+    void PhysicsQueries::RaycastBatch(btCollisionWorld* world, const RayBatch& rays, const QueryHits& hits)
+    {
+        if (!world || rays.Size() == 0)
+            return;
+
+        RaycastJob job(world->getBroadphase(), rays, hits);
+        btParallelFor(0, static_cast<int>(rays.Size()), kGrainSize, job);
+    }
+
+    void PhysicsQueries::SphereCastBatch(const SweepBatch& sweeps, const QueryHits& hits)
+    {
+        ZoneScoped;
+
+        PhysicsEngine::WaitForStep();
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+        if (!world || sweeps.Size() == 0)
+            return;
+
+        SphereCastJob job(world, sweeps, hits);
+        btParallelFor(0, static_cast<int>(sweeps.Size()), kGrainSize, job);
+    }
+
+} // namespace Coffee
@@ -0,0 +1,96 @@
+/**
+ * @file PhysicsQueries.h
+ * @brief Declares the batched raycast and shape-cast queries against the physics world.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+#include <span>
+
+namespace Coffee
+{
+
+    /**
+     * @struct RayBatch
+     * @brief Rays to cast, stored as parallel arrays.
+     */
+    struct RayBatch
+    {
+        std::span<const glm::vec3> Origins;    ///< Start point of each ray.
+        std::span<const glm::vec3> Directions; ///< Normalized direction of each ray.
+        std::span<const float> MaxDistances;   ///< Length of each ray, MaxDistance is used when empty.
+        std::span<const entt::entity> IgnoreEntities; ///< Entity whose objects each ray passes through, none when empty or null.
+        float MaxDistance = 1000.0f;           ///< Length of every ray when MaxDistances is empty.
+        int CollisionMask = btBroadphaseProxy::AllFilter; ///< Collision groups the rays can hit.
+        bool IgnoreTriggers = false;                      ///< Skip objects without contact response and ghost objects.
+
+        /** @brief Gets the number of rays in the batch. */
+        size_t Size() const { return Origins.size(); }
+    };
+
+    /**
+     * @struct SweepBatch
+     * @brief Sphere sweeps to cast, stored as parallel arrays.
+     */
+    struct SweepBatch : RayBatch
+    {
+        float Radius = 0.5f; ///< Radius of the swept sphere.
+    };
+
+    /**
+     * @struct QueryHits
+     * @brief Caller-provided buffers the closest hit of every query is written to.
+     *
+     * Every non-empty buffer must hold at least one element per query. Empty buffers are skipped.
+     */
+    struct QueryHits
+    {
+        std::span<const btCollisionObject*> Objects; ///< Hit object, null on a miss.
+        std::span<float> Distances;                   ///< Distance along the query to the hit.
+        std::span<glm::vec3> Points;                  ///< World-space hit point.
+        std::span<glm::vec3> Normals;                 ///< World-space hit normal.
+        std::span<entt::entity> Entities;             ///< Entity owning the hit body, null if unknown.
+    };
+
+    /**
+     * @class PhysicsQueries
+     * @brief Batched scene queries that don't allocate and run over Bullet's task scheduler.
+     *
+     * Rays walk the broadphase tree directly and only run the narrowphase on the objects whose
+     * bounds they cross. Batches are split across worker threads when the world is PARALLEL and
+     * run serially otherwise. Queries wait for an in-flight step before touching the world.
+     */
+    class PhysicsQueries
+    {
+      public:
+        /**
+         * @brief Casts every ray of the batch and writes the closest hits, waiting for an in-flight step first.
+         * @param rays The rays to cast.
+         * @param hits The buffers to fill.
+         */
+        static void RaycastBatch(const RayBatch& rays, const QueryHits& hits);
+
+        /**
+         * @brief Casts every ray of the batch against a world without waiting for the step.
+         *
+         * Only for systems updated by the step itself, on the thread running it. Anything else
+         * must use the overload without a world, which waits for the step.
+         * @param world The world to cast against.
+         * @param rays The rays to cast.
+         * @param hits The buffers to fill.
+         */
+        static void RaycastBatch(btCollisionWorld* world, const RayBatch& rays, const QueryHits& hits);
+
+        /**
+         * @brief Sweeps a sphere along every query of the batch and writes the closest hits, waiting for an in-flight step first.
+         * @param sweeps The sweeps to cast.
+         * @param hits The buffers to fill.
+         */
+        static void SphereCastBatch(const SweepBatch& sweeps, const QueryHits& hits);
+    };
+
+} // namespace Coffee
@@ -0,0 +1,173 @@
+/**
+ * @file PhysicsSettings.h
+ * @brief Declares the project-level physics settings.
+ */
+
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/string.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Coffee
+{
+
+    /**
+     * @enum PhysicsType
+     * @brief Defines different types of physics simulations.
+     */
+    enum class PhysicsType
+    {
+        BASIC,     ///< Basic physics simulation.
+        DISCRETE,  ///< Discrete collision detection.
+        PARALLEL,  ///< Parallel physics processing.
+        CONTINUOUS ///< Discrete world that sweeps bodies fast enough to tunnel, see PhysicsEngine::ApplyContinuousCollision.
+    };
+
+    /**
+     * @struct PhysicsSettings
+     * @brief Physics configuration stored in the project file.
+     */
+    struct PhysicsSettings
+    {
+        PhysicsType Type = PhysicsType::DISCRETE; ///< Kind of world to simulate.
+        int WorkerThreads = 0;                    ///< Worker threads used by PARALLEL, 0 uses every hardware thread.
+        int TickRate = 60;                        ///< Fixed simulation ticks per second.
+        int MaxSubSteps = 5;                      ///< Maximum ticks run in a single frame, extra time is dropped.
+        bool AsyncStep = false;                   ///< Step on a dedicated thread while the main thread renders.
+
+        bool LodEnabled = false;          ///< Step bodies far from the LOD anchors at reduced rates.
+        float LodFullRateRadius = 40.0f;  ///< Bodies closer than this to an anchor step every tick.
+        float LodHalfRateRadius = 80.0f;  ///< Bodies closer than this step every other tick.
+        float LodQuarterRateRadius = 160.0f; ///< Bodies closer than this step every fourth tick, farther ones sleep.
+
+        int HullMaxVertices = 32; ///< Points kept per convex hull generated from a mesh.
+        int HullMaxPieces = 8;    ///< Convex pieces a concave mesh may be split into, 1 always uses a single hull.
+
+        bool StaticBakeEnabled = false;    ///< Merge static colliders into one compound per cell when the scene starts.
+        float StaticBakeCellSize = 64.0f; ///< Edge length of the cells static colliders are merged by.
+
+        bool DebugDrawEnabled = false;     ///< Draw the physics world in the viewport, nothing is drawn when off.
+        bool DebugDrawShapes = true;       ///< Draw collider wireframes.
+        bool DebugDrawAabbs = false;       ///< Draw broadphase AABBs.
+        bool DebugDrawContacts = false;    ///< Draw contact points and normals.
+        bool DebugDrawConstraints = false; ///< Draw constraint frames and limits.
+
+        int MaxProjectiles = 20000; ///< Projectiles alive at once, the pool is allocated for this many up front.
+
+        static constexpr int MaxCollisionLayers = 32; ///< Layers fit in the 32 bits of a Bullet filter group.
+
+        std::array<std::string, MaxCollisionLayers> CollisionLayerNames = {"Default"}; ///< Layer names, unnamed layers are unused.
+        std::array<uint32_t, MaxCollisionLayers> CollisionMatrix = MakeDefaultCollisionMatrix(); ///< Bit j of entry i is set when layers i and j collide.
+
+        /** @brief Gets a matrix where every layer collides with every other. */
+        static constexpr std::array<uint32_t, MaxCollisionLayers> MakeDefaultCollisionMatrix()
+        {
+            std::array<uint32_t, MaxCollisionLayers> matrix{};
+            for (uint32_t& mask : matrix)
+                mask = ~0u;
+            return matrix;
+        }
+
+        /** @brief Sets whether two layers collide, keeping the matrix symmetric. */
+        void SetLayersCollide(int layerA, int layerB, bool collide)
+        {
+            if (collide)
+            {
+                CollisionMatrix[layerA] |= 1u << layerB;
+                CollisionMatrix[layerB] |= 1u << layerA;
+            }
+            else
+            {
+                CollisionMatrix[layerA] &= ~(1u << layerB);
+                CollisionMatrix[layerB] &= ~(1u << layerA);
+            }
+        }
+
+        /** @brief Gets whether two layers collide. */
+        bool DoLayersCollide(int layerA, int layerB) const { return (CollisionMatrix[layerA] >> layerB) & 1u; }
+
+        /** @brief Gets the index of a named layer, -1 if no layer has that name. */
+        int FindCollisionLayer(std::string_view name) const
+        {
+            for (int i = 0; i < MaxCollisionLayers; ++i)
+            {
+                if (!name.empty() && CollisionLayerNames[i] == name)
+                    return i;
+            }
+            return -1;
+        }
+
+        /** @brief Gets the duration of a single simulation tick in seconds. */
+        float GetFixedTimeStep() const { return 1.0f / static_cast<float>(TickRate); }
+
+        /**
+         * @brief Serializes the PhysicsSettings.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         */
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Type", Type), cereal::make_nvp("WorkerThreads", WorkerThreads),
+                    cereal::make_nvp("TickRate", TickRate), cereal::make_nvp("MaxSubSteps", MaxSubSteps),
+                    cereal::make_nvp("AsyncStep", AsyncStep), cereal::make_nvp("LodEnabled", LodEnabled),
+                    cereal::make_nvp("LodFullRateRadius", LodFullRateRadius),
+                    cereal::make_nvp("LodHalfRateRadius", LodHalfRateRadius),
+                    cereal::make_nvp("LodQuarterRateRadius", LodQuarterRateRadius));
+
+            // Projects saved before collision layers keep every layer colliding
+            try
+            {
+                archive(cereal::make_nvp("CollisionLayerNames", CollisionLayerNames),
+                        cereal::make_nvp("CollisionMatrix", CollisionMatrix));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
+            try
+            {
+                archive(cereal::make_nvp("HullMaxVertices", HullMaxVertices),
+                        cereal::make_nvp("HullMaxPieces", HullMaxPieces));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
+            try
+            {
+                archive(cereal::make_nvp("StaticBakeEnabled", StaticBakeEnabled),
+                        cereal::make_nvp("StaticBakeCellSize", StaticBakeCellSize));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
+            try
+            {
+                archive(cereal::make_nvp("DebugDrawEnabled", DebugDrawEnabled),
+                        cereal::make_nvp("DebugDrawShapes", DebugDrawShapes),
+                        cereal::make_nvp("DebugDrawAabbs", DebugDrawAabbs),
+                        cereal::make_nvp("DebugDrawContacts", DebugDrawContacts),
+                        cereal::make_nvp("DebugDrawConstraints", DebugDrawConstraints));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
+            try
+            {
+                archive(cereal::make_nvp("MaxProjectiles", MaxProjectiles));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+        }
+    };
+
+} // namespace Coffee
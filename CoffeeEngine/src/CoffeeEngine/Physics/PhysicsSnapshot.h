@@ -0,0 +1,99 @@
+/**
+ * @file PhysicsSnapshot.h
+ * @brief Declares the PhysicsSnapshot buffers filled by PhysicsEngine::Snapshot.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @struct BodySnapshot
+     * @brief Dynamic state of one collision object, plain data copied bit for bit.
+     */
+    struct BodySnapshot
+    {
+        const btCollisionObject* Object; ///< Object the state belongs to, checked on restore.
+        int FilterGroup;                 ///< Broadphase filter group.
+        int FilterMask;                  ///< Broadphase filter mask.
+        int CollisionFlags;
+        int ActivationState;
+        btScalar DeactivationTime;
+        btScalar HitFraction;
+
+        btTransformData WorldTransform;
+        btTransformData InterpolationWorldTransform;
+        btVector3Data InterpolationLinearVelocity;
+        btVector3Data InterpolationAngularVelocity;
+
+        // Rigid bodies only
+        btVector3Data LinearVelocity;
+        btVector3Data AngularVelocity;
+        btVector3Data Gravity;     ///< Gravity acceleration.
+        btVector3Data TotalForce;  ///< Forces applied since the last tick.
+        btVector3Data TotalTorque; ///< Torques applied since the last tick.
+
+        // PhysicsMotionState only
+        btTransformData MotionTransform;
+        btTransformData MotionPreviousTransform;
+        btVector3Data LodLinearVelocity;
+        btVector3Data LodAngularVelocity;
+        uint8_t LodRing;
+        uint8_t LodFrozen;
+        uint8_t HasMotionState;
+    };
+
+    /**
+     * @struct ManifoldSnapshot
+     * @brief A contact manifold, its points are stored in PhysicsSnapshot::Points.
+     */
+    struct ManifoldSnapshot
+    {
+        const btCollisionObject* Body0;
+        const btCollisionObject* Body1;
+        uint32_t FirstPoint; ///< Index of the first point in PhysicsSnapshot::Points.
+        uint32_t PointCount;
+    };
+
+    /**
+     * @struct PhysicsSnapshot
+     * @brief The full dynamic state of the physics world as flat arrays of plain records.
+     *
+     * The arrays keep their capacity between snapshots, so taking one in a loop doesn't allocate
+     * once the buffers have grown to the size of the world. The records hold object pointers
+     * and are only valid for the world they were taken from, with the same set of objects in it.
+     * Vehicle, character and projectile state lives outside the world and is not included.
+     */
+    struct PhysicsSnapshot
+    {
+        std::vector<BodySnapshot> Bodies;         ///< One record per object, in world array order.
+        std::vector<ManifoldSnapshot> Manifolds;  ///< Contact manifolds, in dispatcher order.
+        std::vector<btManifoldPoint> Points;      ///< Contact points with their warm-starting impulses.
+
+        uint64_t TickCount = 0;   ///< Fixed ticks run when the snapshot was taken.
+        float Accumulator = 0.0f; ///< Frame time not yet consumed by a tick.
+        bool LodActive = false;   ///< Whether LOD had bodies frozen or assigned to rings.
+
+        /** @brief Empties the snapshot while keeping its capacity. */
+        void Clear()
+        {
+            Bodies.clear();
+            Manifolds.clear();
+            Points.clear();
+        }
+
+        /** @brief Gets the number of bytes the snapshot records use. */
+        size_t GetSizeInBytes() const
+        {
+            return Bodies.size() * sizeof(BodySnapshot) + Manifolds.size() * sizeof(ManifoldSnapshot) +
+                   Points.size() * sizeof(btManifoldPoint);
+        }
+    };
+
+} // namespace Coffee
@@ -0,0 +1,45 @@
+#include "PhysicsTelemetry.h"
+
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    TelemetryRing<PhysicsTickStats, PhysicsTelemetry::TickCapacity> PhysicsTelemetry::s_Ticks;
+    TelemetryRing<PhysicsBodySample, PhysicsTelemetry::TraceCapacity> PhysicsTelemetry::s_BodySamples;
+    std::atomic<entt::entity> PhysicsTelemetry::s_TracedEntity{entt::null};
+    std::atomic<int> PhysicsTelemetry::s_TraceInterval{1};
+    std::atomic<bool> PhysicsTelemetry::s_CountBodies{false};
+
+    void PhysicsTelemetry::RecordTick(const PhysicsTickStats& stats)
+    {
+        s_Ticks.Push(stats);
+
+        TracyPlot("Physics Step (ms)", stats.StepTimeMs);
+        TracyPlot("Physics Active Bodies", static_cast<int64_t>(stats.ActiveBodies));
+        TracyPlot("Physics Sleeping Bodies", static_cast<int64_t>(stats.SleepingBodies));
+        TracyPlot("Physics Manifolds", static_cast<int64_t>(stats.Manifolds));
+        TracyPlot("Physics Contacts", static_cast<int64_t>(stats.Contacts));
+    }
+
+    PhysicsTickStats PhysicsTelemetry::GetLastTick()
+    {
+        PhysicsTickStats stats;
+        s_Ticks.Read({&stats, 1});
+        return stats;
+    }
+
+    void PhysicsTelemetry::TraceBody(entt::entity entity, int interval)
+    {
+        s_TraceInterval.store(std::max(1, interval), std::memory_order_relaxed);
+        s_TracedEntity.store(entity, std::memory_order_relaxed);
+    }
+
+    void PhysicsTelemetry::Clear()
+    {
+        s_Ticks.Clear();
+        s_BodySamples.Clear();
+    }
+
+} // namespace Coffee
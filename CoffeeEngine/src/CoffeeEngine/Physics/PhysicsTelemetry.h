@@ -0,0 +1,182 @@
+/**
+ * @file PhysicsTelemetry.h
+ * @brief Declares the per-tick physics counters and the rings they are recorded into.
+ */
+
+#pragma once
+
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Coffee
+{
+
+    /**
+     * @struct PhysicsTickStats
+     * @brief Counters recorded at the end of every fixed tick.
+     */
+    struct PhysicsTickStats
+    {
+        uint64_t Tick = 0;             ///< Index of the tick since the engine started.
+        uint32_t ActiveBodies = 0;     ///< Dynamic bodies awake after the tick, 0 unless body counting is on.
+        uint32_t SleepingBodies = 0;   ///< Dynamic bodies asleep after the tick, 0 unless body counting is on.
+        uint32_t Manifolds = 0;        ///< Narrowphase manifolds.
+        uint32_t Contacts = 0;         ///< Contact points across every manifold.
+        uint32_t SolverIterations = 0; ///< Solver iterations per tick.
+        float StepTimeMs = 0.0f;       ///< Time spent in stepSimulation.
+    };
+
+    /**
+     * @struct PhysicsBodySample
+     * @brief State of the traced body at a sampled tick.
+     */
+    struct PhysicsBodySample
+    {
+        uint64_t Tick = 0;                      ///< Tick the sample was taken at.
+        entt::entity Entity = entt::null;       ///< Traced entity.
+        glm::vec3 Position = glm::vec3(0.0f);        ///< World position.
+        glm::vec3 LinearVelocity = glm::vec3(0.0f);  ///< Linear velocity.
+        glm::vec3 AngularVelocity = glm::vec3(0.0f); ///< Angular velocity.
+        bool Active = false;                    ///< Whether the body was awake.
+    };
+
+    /**
+     * @class TelemetryRing
+     * @brief Fixed-size lock-free ring with a single writer that overwrites the oldest entries.
+     *
+     * The writer announces every push before touching its slot and publishes it once written,
+     * like a sequence lock. Readers copy the newest entries and drop the ones the writer started
+     * overwriting while they were copying, so the writer never waits on a reader.
+     * @tparam T Trivially copyable entry type.
+     * @tparam Capacity Number of entries kept.
+     */
+    template <typename T, size_t Capacity> class TelemetryRing
+    {
+      public:
+        /** @brief Appends an entry, only call from the writer thread. */
+        void Push(const T& entry)
+        {
+            const uint64_t head = m_Head.load(std::memory_order_relaxed);
+
+            // Readers that see any byte of the new entry also see that its slot is being rewritten
+            m_Started.store(head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            m_Entries[head % Capacity] = entry;
+            m_Head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Copies the newest entries, oldest first.
+         * @param out Buffer to fill, at most out.size() entries are copied.
+         * @return Number of entries copied.
+         */
+        size_t Read(std::span<T> out) const
+        {
+            const uint64_t head = m_Head.load(std::memory_order_acquire);
+            const uint64_t count = std::min<uint64_t>({head, Capacity, out.size()});
+            const uint64_t first = head - count;
+
+            for (uint64_t i = 0; i < count; ++i)
+                out[i] = m_Entries[(first + i) % Capacity];
+
+            // Entries in slots the writer started rewriting while we were copying may be torn, drop them
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t started = m_Started.load(std::memory_order_relaxed);
+            const uint64_t oldestValid = started > Capacity ? started - Capacity : 0;
+            if (first >= oldestValid)
+                return count;
+
+            const uint64_t dropped = std::min(oldestValid - first, count);
+            for (uint64_t i = dropped; i < count; ++i)
+                out[i - dropped] = out[i];
+            return count - dropped;
+        }
+
+        /** @brief Gets the number of entries ever pushed. */
+        uint64_t GetPushCount() const { return m_Head.load(std::memory_order_acquire); }
+
+        /** @brief Forgets every entry, only call while the writer is idle. */
+        void Clear()
+        {
+            m_Started.store(0, std::memory_order_relaxed);
+            m_Head.store(0, std::memory_order_release);
+        }
+
+      private:
+        std::array<T, Capacity> m_Entries{};
+        alignas(64) std::atomic<uint64_t> m_Head{0};    ///< Entries published so far.
+        std::atomic<uint64_t> m_Started{0};             ///< Entries whose write has started.
+    };
+
+    /**
+     * @class PhysicsTelemetry
+     * @brief Physics counters recorded every tick for the editor and the profiler.
+     *
+     * Recording is a handful of stores per tick and never formats or locks. The counters are
+     * also sent to Tracy plots when profiling is enabled. Counting active and sleeping bodies
+     * walks the dynamic bodies, so it only happens while body counting is on, and always in
+     * profiling builds for the Tracy plots. A single body can be traced on demand, which costs nothing while
+     * no body is traced.
+     */
+    class PhysicsTelemetry
+    {
+      public:
+        static constexpr size_t TickCapacity = 512;  ///< Ticks kept in the ring.
+        static constexpr size_t TraceCapacity = 512; ///< Body samples kept in the ring.
+
+        /** @brief Records the counters of a finished tick, called from the thread stepping the world. */
+        static void RecordTick(const PhysicsTickStats& stats);
+        /**
+         * @brief Copies the newest tick counters, oldest first.
+         * @return Number of ticks copied.
+         */
+        static size_t ReadTicks(std::span<PhysicsTickStats> out) { return s_Ticks.Read(out); }
+        /** @brief Gets the counters of the last recorded tick, zeroed if none was recorded. */
+        static PhysicsTickStats GetLastTick();
+
+        /**
+         * @brief Starts sampling the body of an entity.
+         * @param entity Entity to trace, entt::null stops tracing.
+         * @param interval Ticks between samples.
+         */
+        static void TraceBody(entt::entity entity, int interval = 1);
+        /** @brief Gets the traced entity, entt::null when tracing is off. */
+        static entt::entity GetTracedEntity() { return s_TracedEntity.load(std::memory_order_relaxed); }
+        /** @brief Whether the traced body should be sampled at the given tick. */
+        static bool ShouldSample(uint64_t tick)
+        {
+            return GetTracedEntity() != entt::null && tick % s_TraceInterval.load(std::memory_order_relaxed) == 0;
+        }
+        /** @brief Records a sample of the traced body, called from the thread stepping the world. */
+        static void RecordBodySample(const PhysicsBodySample& sample) { s_BodySamples.Push(sample); }
+        /**
+         * @brief Copies the newest samples of the traced body, oldest first.
+         * @return Number of samples copied.
+         */
+        static size_t ReadBodySamples(std::span<PhysicsBodySample> out) { return s_BodySamples.Read(out); }
+
+        /** @brief Turns the active and sleeping body counters on or off, for tools showing them. */
+        static void SetBodyCounting(bool enabled) { s_CountBodies.store(enabled, std::memory_order_relaxed); }
+        /** @brief Whether the body counters are filled in. */
+        static bool IsBodyCounting() { return s_CountBodies.load(std::memory_order_relaxed); }
+
+        /** @brief Forgets every recorded tick and sample, only call while the world isn't stepping. */
+        static void Clear();
+
+      private:
+        static TelemetryRing<PhysicsTickStats, TickCapacity> s_Ticks;          ///< Per-tick counters.
+        static TelemetryRing<PhysicsBodySample, TraceCapacity> s_BodySamples; ///< Samples of the traced body.
+        static std::atomic<entt::entity> s_TracedEntity; ///< Entity whose body is sampled.
+        static std::atomic<int> s_TraceInterval;         ///< Ticks between body samples.
+        static std::atomic<bool> s_CountBodies;          ///< Whether active and sleeping bodies are counted.
+    };
+
+} // namespace Coffee
@@ -0,0 +1,258 @@
+#include "ProjectileSystem.h"
+#include "PhysicsEngine.h"
+#include "PhysicsQueries.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    size_t ProjectileSystem::s_Capacity = 0;
+    size_t ProjectileSystem::s_LiveCount = 0;
+    uint32_t ProjectileSystem::s_NextId = 1;
+    int ProjectileSystem::s_CollisionLayer = 0;
+    float ProjectileSystem::s_GravityScale = 1.0f;
+
+    std::vector<float> ProjectileSystem::s_PositionX;
+    std::vector<float> ProjectileSystem::s_PositionY;
+    std::vector<float> ProjectileSystem::s_PositionZ;
+    std::vector<float> ProjectileSystem::s_VelocityX;
+    std::vector<float> ProjectileSystem::s_VelocityY;
+    std::vector<float> ProjectileSystem::s_VelocityZ;
+    std::vector<float> ProjectileSystem::s_Lifetime;
+    std::vector<entt::entity> ProjectileSystem::s_Owner;
+    std::vector<uint32_t> ProjectileSystem::s_Id;
+
+    std::vector<ProjectileSystem::PendingSpawn> ProjectileSystem::s_Pending;
+
+    ProjectileSystem::PublishedPositions ProjectileSystem::s_Published[2];
+
+    std::vector<glm::vec3> ProjectileSystem::s_RayOrigins;
+    std::vector<glm::vec3> ProjectileSystem::s_RayDirections;
+    std::vector<float> ProjectileSystem::s_RayLengths;
+    std::vector<const btCollisionObject*> ProjectileSystem::s_HitObjects;
+    std::vector<glm::vec3> ProjectileSystem::s_HitPoints;
+    std::vector<glm::vec3> ProjectileSystem::s_HitNormals;
+    std::vector<entt::entity> ProjectileSystem::s_HitEntities;
+
+    void ProjectileSystem::Reserve(size_t capacity)
+    {
+        Clear();
+
+        s_Capacity = capacity;
+
+        // Every buffer is sized once here, spawning and stepping only move elements around
+        for (auto* attribute : {&s_PositionX, &s_PositionY, &s_PositionZ, &s_VelocityX, &s_VelocityY, &s_VelocityZ,
+                                &s_Lifetime})
+        {
+            attribute->reserve(capacity);
+        }
+        s_Owner.reserve(capacity);
+        s_Id.reserve(capacity);
+        s_Pending.reserve(capacity);
+        for (PublishedPositions& published : s_Published)
+        {
+            published.X.reserve(capacity);
+            published.Y.reserve(capacity);
+            published.Z.reserve(capacity);
+        }
+
+        s_RayOrigins.resize(capacity);
+        s_RayDirections.resize(capacity);
+        s_RayLengths.resize(capacity);
+        s_HitObjects.resize(capacity);
+        s_HitPoints.resize(capacity);
+        s_HitNormals.resize(capacity);
+        s_HitEntities.resize(capacity);
+    }
+
+    uint32_t ProjectileSystem::Spawn(const glm::vec3& position, const glm::vec3& velocity, float lifetime,
+                                     entt::entity owner)
+    {
+        // The live arrays belong to an in-flight step, so spawns wait in their own buffer and the
+        // pool is measured by the count taken when the step began, which the step only lowers
+        if (s_LiveCount + s_Pending.size() >= s_Capacity || lifetime <= 0.0f)
+            return 0;
+
+        const uint32_t id = s_NextId++;
+        if (s_NextId == 0)
+            s_NextId = 1;
+
+        s_Pending.push_back({position, velocity, lifetime, owner, id});
+        return id;
+    }
+
+    void ProjectileSystem::Clear()
+    {
+        PhysicsEngine::WaitForStep();
+
+        for (auto* attribute : {&s_PositionX, &s_PositionY, &s_PositionZ, &s_VelocityX, &s_VelocityY, &s_VelocityZ,
+                                &s_Lifetime})
+        {
+            attribute->clear();
+        }
+        s_Owner.clear();
+        s_Id.clear();
+        s_Pending.clear();
+        s_LiveCount = 0;
+
+        for (PublishedPositions& published : s_Published)
+        {
+            published.X.clear();
+            published.Y.clear();
+            published.Z.clear();
+        }
+    }
+
+    size_t ProjectileSystem::GetCount()
+    {
+        return s_Published[PhysicsEngine::m_FrontBuffer].X.size();
+    }
+
+    std::span<const float> ProjectileSystem::GetPositionsX()
+    {
+        return s_Published[PhysicsEngine::m_FrontBuffer].X;
+    }
+
+    std::span<const float> ProjectileSystem::GetPositionsY()
+    {
+        return s_Published[PhysicsEngine::m_FrontBuffer].Y;
+    }
+
+    std::span<const float> ProjectileSystem::GetPositionsZ()
+    {
+        return s_Published[PhysicsEngine::m_FrontBuffer].Z;
+    }
+
+    void ProjectileSystem::FlushSpawns()
+    {
+        for (const PendingSpawn& spawn : s_Pending)
+        {
+            s_PositionX.push_back(spawn.Position.x);
+            s_PositionY.push_back(spawn.Position.y);
+            s_PositionZ.push_back(spawn.Position.z);
+            s_VelocityX.push_back(spawn.Velocity.x);
+            s_VelocityY.push_back(spawn.Velocity.y);
+            s_VelocityZ.push_back(spawn.Velocity.z);
+            s_Lifetime.push_back(spawn.Lifetime);
+            s_Owner.push_back(spawn.Owner);
+            s_Id.push_back(spawn.Id);
+        }
+        s_Pending.clear();
+        s_LiveCount = s_Id.size();
+    }
+
+    void ProjectileSystem::Publish(int buffer)
+    {
+        // Sized with the pool, so assigning never allocates
+        PublishedPositions& published = s_Published[buffer];
+        published.X.assign(s_PositionX.begin(), s_PositionX.end());
+        published.Y.assign(s_PositionY.begin(), s_PositionY.end());
+        published.Z.assign(s_PositionZ.begin(), s_PositionZ.end());
+    }
+
+    void ProjectileSystem::Step(btDynamicsWorld* world, float dt, std::vector<ProjectileHit>& hits,
+                                std::vector<ContactEvent>& events)
+    {
+        const size_t count = s_Id.size();
+        if (count == 0)
+            return;
+
+        ZoneScopedN("Projectiles");
+
+        const btVector3 gravity = world->getGravity() * s_GravityScale;
+        const float gx = gravity.x() * dt;
+        const float gy = gravity.y() * dt;
+        const float gz = gravity.z() * dt;
+
+        float* __restrict px = s_PositionX.data();
+        float* __restrict py = s_PositionY.data();
+        float* __restrict pz = s_PositionZ.data();
+        float* __restrict vx = s_VelocityX.data();
+        float* __restrict vy = s_VelocityY.data();
+        float* __restrict vz = s_VelocityZ.data();
+        float* __restrict lifetime = s_Lifetime.data();
+        float* __restrict lengths = s_RayLengths.data();
+
+        // Straight loops over the attribute arrays without branches, the compiler vectorizes them
+        for (size_t i = 0; i < count; ++i)
+        {
+            vx[i] += gx;
+            vy[i] += gy;
+            vz[i] += gz;
+            lifetime[i] -= dt;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            lengths[i] = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]) * dt;
+
+        // The segment travelled this tick, resting projectiles probe a sliver below them
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float length = lengths[i];
+            s_RayOrigins[i] = {px[i], py[i], pz[i]};
+            s_RayDirections[i] = length > 1e-6f ? glm::vec3(vx[i], vy[i], vz[i]) * (dt / length)
+                                                : glm::vec3(0.0f, -1.0f, 0.0f);
+            lengths[i] = std::max(length, 1e-6f);
+        }
+
+        RayBatch rays;
+        rays.Origins = std::span<const glm::vec3>(s_RayOrigins.data(), count);
+        rays.Directions = std::span<const glm::vec3>(s_RayDirections.data(), count);
+        rays.MaxDistances = std::span<const float>(lengths, count);
+        rays.IgnoreEntities = s_Owner;
+        rays.CollisionMask =
+            PhysicsEngine::GetCollisionMask(std::clamp(s_CollisionLayer, 0, PhysicsSettings::MaxCollisionLayers - 1));
+        rays.IgnoreTriggers = true;
+
+        QueryHits rayHits;
+        rayHits.Objects = std::span<const btCollisionObject*>(s_HitObjects.data(), count);
+        rayHits.Points = std::span<glm::vec3>(s_HitPoints.data(), count);
+        rayHits.Normals = std::span<glm::vec3>(s_HitNormals.data(), count);
+        rayHits.Entities = std::span<entt::entity>(s_HitEntities.data(), count);
+
+        PhysicsQueries::RaycastBatch(world, rays, rayHits);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+        }
+
+        // Walked backwards so the projectile moved into a removed slot has already been looked at
+        for (size_t i = count; i-- > 0;)
+        {
+            // The owner's bodies were skipped by the rays themselves, any hit is a real one
+            const btCollisionObject* object = s_HitObjects[i];
+            if (object)
+            {
+                events.push_back({object, nullptr, ContactEvent::Type::ProjectileHit, static_cast<uint32_t>(hits.size())});
+                hits.push_back({s_Id[i], s_Owner[i], object, s_HitEntities[i], s_HitPoints[i], s_HitNormals[i],
+                                glm::vec3(vx[i], vy[i], vz[i])});
+            }
+
+            if (object || lifetime[i] <= 0.0f)
+                RemoveAt(i);
+        }
+
+        TracyPlot("Projectiles", static_cast<int64_t>(s_Id.size()));
+    }
+
+    void ProjectileSystem::RemoveAt(size_t index)
+    {
+        for (auto* attribute : {&s_PositionX, &s_PositionY, &s_PositionZ, &s_VelocityX, &s_VelocityY, &s_VelocityZ,
+                                &s_Lifetime})
+        {
+            (*attribute)[index] = attribute->back();
+            attribute->pop_back();
+        }
+        s_Owner[index] = s_Owner.back();
+        s_Owner.pop_back();
+        s_Id[index] = s_Id.back();
+        s_Id.pop_back();
+    }
+
+} // namespace Coffee
@@ -0,0 +1,166 @@
+/**
+ * @file ProjectileSystem.h
+ * @brief Declares the ProjectileSystem, a pool of point projectiles simulated outside the rigid-body solver.
+ */
+
+#pragma once
+
+#include "ContactTracker.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @struct ProjectileHit
+     * @brief A projectile that struck a collision object during a tick.
+     */
+    struct ProjectileHit
+    {
+        uint32_t Projectile;              ///< Id returned by ProjectileSystem::Spawn.
+        entt::entity Owner;               ///< Entity that fired the projectile.
+        const btCollisionObject* Object;  ///< Object hit.
+        entt::entity Entity;              ///< Entity owning the object hit, null if unknown.
+        glm::vec3 Point;                  ///< World-space hit point.
+        glm::vec3 Normal;                 ///< World-space normal of the surface hit.
+        glm::vec3 Velocity;               ///< Velocity of the projectile on impact.
+    };
+
+    /**
+     * @class ProjectileSystem
+     * @brief Fixed-capacity pool of projectiles stepped by the physics tick.
+     *
+     * Projectiles are points with a velocity, a lifetime and an owner. They never enter the
+     * broadphase or the solver: every tick they are integrated in bulk over flat arrays, then
+     * the segment each one travelled is raycast against the broadphase in a single batch.
+     * A projectile dies on its first hit or when its lifetime runs out. Hits are published
+     * as ProjectileHit contact events along with the other contact events of the tick.
+     *
+     * The pool is sized from PhysicsSettings::MaxProjectiles when the engine starts, so firing
+     * never allocates. Spawns are queued and join the pool when the next step begins. The live
+     * arrays belong to the step, readers get the positions it published when it ended. Projectiles hit solid objects and character
+     * capsules, triggers and ghosts are flown through.
+     */
+    class ProjectileSystem
+    {
+      public:
+        /**
+         * @brief Sizes the pool, dropping every projectile.
+         * @param capacity Projectiles alive at once.
+         */
+        static void Reserve(size_t capacity);
+
+        /**
+         * @brief Queues a projectile for the next step.
+         * @param position World-space start point.
+         * @param velocity Initial velocity.
+         * @param lifetime Seconds before the projectile expires.
+         * @param owner Entity that fired it, its bodies are never hit.
+         * @return Id reported in the hits of this projectile, 0 if the pool is full.
+         */
+        static uint32_t Spawn(const glm::vec3& position, const glm::vec3& velocity, float lifetime,
+                              entt::entity owner = entt::null);
+
+        /** @brief Drops every live and queued projectile. */
+        static void Clear();
+
+        /** @brief Sets the collision layer projectiles hit as, from the project's collision matrix. */
+        static void SetCollisionLayer(int layer) { s_CollisionLayer = layer; }
+        /** @brief Scales the world gravity applied to projectiles, 0 flies straight. */
+        static void SetGravityScale(float scale) { s_GravityScale = scale; }
+
+        /** @brief Gets the number of projectiles alive after the last published step. */
+        static size_t GetCount();
+        /** @brief Gets the number of projectiles the pool can hold. */
+        static size_t GetCapacity() { return s_Capacity; }
+
+        /** @brief Gets the X coordinates published by the last step, safe to read while the next one runs. */
+        static std::span<const float> GetPositionsX();
+        /** @brief Gets the Y coordinates published by the last step, safe to read while the next one runs. */
+        static std::span<const float> GetPositionsY();
+        /** @brief Gets the Z coordinates published by the last step, safe to read while the next one runs. */
+        static std::span<const float> GetPositionsZ();
+
+      private:
+        /** @brief Moves the queued spawns into the pool, called between steps. */
+        static void FlushSpawns();
+
+        /**
+         * @brief Copies the live positions into a read buffer, called at the end of an update.
+         * @param buffer The engine's back buffer, which becomes the front one when the step ends.
+         */
+        static void Publish(int buffer);
+
+        /**
+         * @brief Advances every projectile by one tick and collides it.
+         * @param world The world, already stepped for this tick.
+         * @param dt Tick length.
+         * @param hits Buffer the hits are appended to.
+         * @param events Buffer the hit events are appended to.
+         */
+        static void Step(btDynamicsWorld* world, float dt, std::vector<ProjectileHit>& hits,
+                         std::vector<ContactEvent>& events);
+
+        /** @brief Removes the projectile at an index by moving the last one into it. */
+        static void RemoveAt(size_t index);
+
+        /** @brief A projectile waiting for the next step. */
+        struct PendingSpawn
+        {
+            glm::vec3 Position;
+            glm::vec3 Velocity;
+            float Lifetime;
+            entt::entity Owner;
+            uint32_t Id;
+        };
+
+        static size_t s_Capacity;
+        static size_t s_LiveCount; ///< Live projectiles when the last step began, only touched between steps.
+        static uint32_t s_NextId;
+        static int s_CollisionLayer;
+        static float s_GravityScale;
+
+        // Live projectiles, one array per attribute
+        static std::vector<float> s_PositionX;
+        static std::vector<float> s_PositionY;
+        static std::vector<float> s_PositionZ;
+        static std::vector<float> s_VelocityX;
+        static std::vector<float> s_VelocityY;
+        static std::vector<float> s_VelocityZ;
+        static std::vector<float> s_Lifetime;
+        static std::vector<entt::entity> s_Owner;
+        static std::vector<uint32_t> s_Id;
+
+        static std::vector<PendingSpawn> s_Pending;
+
+        /** @brief Positions of the live projectiles at the end of an update. */
+        struct PublishedPositions
+        {
+            std::vector<float> X;
+            std::vector<float> Y;
+            std::vector<float> Z;
+        };
+
+        // Indexed like the engine's other double buffers, the front one is read between steps
+        static PublishedPositions s_Published[2];
+
+        // Per-tick ray batch, sized with the pool
+        static std::vector<glm::vec3> s_RayOrigins;
+        static std::vector<glm::vec3> s_RayDirections;
+        static std::vector<float> s_RayLengths;
+        static std::vector<const btCollisionObject*> s_HitObjects;
+        static std::vector<glm::vec3> s_HitPoints;
+        static std::vector<glm::vec3> s_HitNormals;
+        static std::vector<entt::entity> s_HitEntities;
+
+        friend class PhysicsEngine;
+    };
+
+} // namespace Coffee
@@ -2,6 +2,7 @@
 
 #include "PhysUtils.h"
 #include "PhysicsEngine.h"
+#include "PhysicsMotionState.h"
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
@@ -28,7 +29,7 @@ namespace Coffee {
                           glm::mat4_cast(rotation) * 
                           glm::scale(glm::mat4(1.0f), scale);
 
-        this->m_RigidBody = PhysicsEngine::CreateRigidBody(&m_Callbacks, config);
+        this->m_RigidBody = PhysicsEngine::CreateRigidBody(&m_Callbacks, config, startTransform);
         
         m_RigidBody->setDamping(config.LinearDrag, config.AngularDrag);
         m_RigidBody->setFriction(config.friction);
@@ -39,13 +40,15 @@ namespace Coffee {
     
     RigidBody::~RigidBody()
     {
-        PhysicsEngine::RemoveRigidBody(m_RigidBody);
-        delete m_RigidBody->getMotionState();
-        delete m_RigidBody;
+        // Releases the shape and motion state too, deferred while a PhysicsEngine batch is open
+        PhysicsEngine::DestroyCollisionObject(m_RigidBody);
     }
     void RigidBody::GetConfig(RigidBodyConfig& config)
     {
-        int flags = m_RigidBody->getFlags();
+        // Reads the live body, which an in-flight step is still writing
+        PhysicsEngine::WaitForStep();
+
+        int flags = m_RigidBody->getCollisionFlags();
         if (flags & btCollisionObject::CF_STATIC_OBJECT)
             config.type = RigidBodyType::Static;
         else if (flags & btCollisionObject::CF_KINEMATIC_OBJECT)
@@ -62,31 +65,74 @@ namespace Coffee {
         config.AngularDrag = m_RigidBody->getAngularDamping();
         config.friction = m_RigidBody->getFriction();
         config.restitution = m_RigidBody->getRestitution();
+
+        // Bodies without mass keep the configured one, Bullet only stores the inverse
+        if (m_RigidBody->getInvMass() > 0.0f)
+            config.shapeConfig.mass = 1.0f / m_RigidBody->getInvMass();
+        config.shapeConfig.layer = PhysicsEngine::GetCollisionLayer(m_RigidBody);
+
         // Constraints
-        // TODO usar joints para esto? No hay opcion para ello en el rigidbody
-        
+        const btVector3& linearFactor = m_RigidBody->getLinearFactor();
+        const btVector3& angularFactor = m_RigidBody->getAngularFactor();
+        config.FreezeX = linearFactor.x() == 0.0f;
+        config.FreezeY = linearFactor.y() == 0.0f;
+        config.FreezeZ = linearFactor.z() == 0.0f;
+        config.FreezeRotX = angularFactor.x() == 0.0f;
+        config.FreezeRotY = angularFactor.y() == 0.0f;
+        config.FreezeRotZ = angularFactor.z() == 0.0f;
+    }
+
+    void RigidBody::GetState(glm::vec3& position, glm::quat& rotation, glm::vec3& velocity) const
+    {
+        PhysicsEngine::WaitForStep();
+
+        const btTransform transform =
+            GetPhysicsMotionState()->GetInterpolatedTransform(PhysicsEngine::GetInterpolationAlpha());
+
+        position = PhysUtils::BulletToGlm(transform.getOrigin());
+        rotation = PhysUtils::BulletToGlm(transform.getRotation());
+        velocity = PhysUtils::BulletToGlm(m_RigidBody->getLinearVelocity());
+    }
+
+    void RigidBody::SetKinematicTransform(const glm::vec3& position, const glm::quat& rotation)
+    {
+        // Bullet pulls kinematic bodies from their motion state at the start of every step
+        GetPhysicsMotionState()->SetTransform(
+            btTransform(PhysUtils::GlmToBullet(rotation), PhysUtils::GlmToBullet(position)));
+    }
+
+    void RigidBody::SetEntity(entt::entity entity)
+    {
+        GetPhysicsMotionState()->SetEntity(entity);
+    }
+
+    PhysicsMotionState* RigidBody::GetPhysicsMotionState() const
+    {
+        return static_cast<PhysicsMotionState*>(m_RigidBody->getMotionState());
     }
 
     void RigidBody::ApplyForce(const glm::vec3& force, const glm::vec3& point)
     {
         if (!m_RigidBody) return;
-        
-        btVector3 btForce = PhysUtils::GlmToBullet(force);
-        btVector3 btPoint = PhysUtils::GlmToBullet(point);
-        
-        m_RigidBody->applyForce(btForce, btPoint);
-        m_RigidBody->activate(true);
+
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::ApplyForce;
+        command.body = m_RigidBody;
+        command.Vector = PhysUtils::GlmToBullet(force);
+        command.Point = PhysUtils::GlmToBullet(point);
+        PhysicsEngine::SubmitCommand(command);
     }
 
     void RigidBody::ApplyImpulse(const glm::vec3& impulse, const glm::vec3& point)
     {
         if (!m_RigidBody) return;
-        
-        btVector3 btImpulse = PhysUtils::GlmToBullet(impulse);
-        btVector3 btPoint = PhysUtils::GlmToBullet(point);
-        
-        m_RigidBody->applyImpulse(btImpulse, btPoint);
-        m_RigidBody->activate(true);
+
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::ApplyImpulse;
+        command.body = m_RigidBody;
+        command.Vector = PhysUtils::GlmToBullet(impulse);
+        command.Point = PhysUtils::GlmToBullet(point);
+        PhysicsEngine::SubmitCommand(command);
     }
 
     void RigidBody::ApplyShape(btCollisionShape* shape, glm::vec3 position,
@@ -96,42 +142,23 @@ namespace Coffee {
         if (!m_RigidBody || !shape)
             return;
 
-        // Remover el rigidbody del mundo antes de modificarlo
-        PhysicsEngine::GetWorld()->removeRigidBody(m_RigidBody);
-
-        // Calcular la nueva inercia basada en la nueva forma
-        btVector3 localInertia(0, 0, 0);
-        shape->calculateLocalInertia(1.0f, localInertia);
+        // Rebuilt from the settings of the current body, only the shape and the pose change
+        RigidBodyConfig config;
+        GetConfig(config);
 
-        // Crear la nueva transformaci�n con los valores pasados
         btTransform newTransform;
         newTransform.setIdentity();
         newTransform.setOrigin(PhysUtils::GlmToBullet(position));
         newTransform.setRotation(PhysUtils::GlmToBullet(rotation));
 
-        // Si el shape es un btBoxShape, ajustar la escala manualmente
-        /*btBoxShape* boxShape = dynamic_cast<btBoxShape*>(shape);
-        if (boxShape)
-        {
-            boxShape->setImplicitShapeDimensions(PhysUtils::GlmToBullet(size * 0.5f));
-        }*/
-
-        // Crear el nuevo motion state con la transformaci�n proporcionada
-        btDefaultMotionState* motionState = new btDefaultMotionState(newTransform);
-
-        // Crear la nueva configuraci�n del rigidbody con la forma y transformaci�n correctas
-        btRigidBody::btRigidBodyConstructionInfo rbInfo(1.0f, motionState, shape, localInertia);
-        btRigidBody* newBody = new btRigidBody(rbInfo);
+        btRigidBody* newBody = PhysicsEngine::CreateRigidBody(&m_Callbacks, config, newTransform, shape);
+        static_cast<PhysicsMotionState*>(newBody->getMotionState())->SetEntity(GetPhysicsMotionState()->GetEntity());
 
-        // Mantener las propiedades del objeto
-        newBody->setFlags(newBody->getFlags() | btCollisionObject::CF_DYNAMIC_OBJECT);
-        newBody->setUserPointer(&m_Callbacks);
-
-        // Agregarlo de nuevo al mundo f�sico
-        PhysicsEngine::GetWorld()->addRigidBody(newBody);
-
-        // Reemplazar el puntero del rigidbody anterior con el nuevo
+        // Releases the old shape reference and motion state, deferred while a PhysicsEngine batch is open
+        PhysicsEngine::DestroyCollisionObject(m_RigidBody);
         m_RigidBody = newBody;
+
+        UpdateGravity(config);
     }
 
     void RigidBody::SetTransform(const glm::mat4& transform)
@@ -145,29 +172,24 @@ namespace Coffee {
         glm::vec4 perspective;
         glm::decompose(transform, scale, rotation, position, skew, perspective);
 
-        btTransform btTrans;
-        btTrans.setIdentity();
-        btTrans.setOrigin(PhysUtils::GlmToBullet(position));
-        btTrans.setRotation(PhysUtils::GlmToBullet(rotation));
-        
-        m_RigidBody->setWorldTransform(btTrans);
-        if (m_RigidBody->getMotionState())
-        {
-            m_RigidBody->getMotionState()->setWorldTransform(btTrans);
-        }
-        m_RigidBody->activate(true);
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::SetTransform;
+        command.body = m_RigidBody;
+        command.Vector = PhysUtils::GlmToBullet(position);
+        command.Rotation = PhysUtils::GlmToBullet(rotation);
+        PhysicsEngine::SubmitCommand(command);
     }
 
     void RigidBody::UpdateGravity(const RigidBodyConfig& config)
     {
         if (m_RigidBody)
         {
-            if (!config.UseGravity || config.type != RigidBodyType::Dynamic) {
-                m_RigidBody->setGravity(btVector3(0, 0, 0));
-            }
-            else {
-                m_RigidBody->setGravity(PhysUtils::GlmToBullet(PhysicsEngine::GetGravity()));
-            }
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetGravity;
+            command.body = m_RigidBody;
+            if (config.UseGravity && config.type == RigidBodyType::Dynamic)
+                command.Vector = PhysUtils::GlmToBullet(PhysicsEngine::GetGravity());
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -175,8 +197,11 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->setLinearVelocity(PhysUtils::GlmToBullet(velocity));
-            m_RigidBody->activate(true);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetVelocity;
+            command.body = m_RigidBody;
+            command.Vector = PhysUtils::GlmToBullet(velocity);
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -184,10 +209,11 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            btVector3 currentVel = m_RigidBody->getLinearVelocity();
-            btVector3 additionalVel = PhysUtils::GlmToBullet(velocity);
-            m_RigidBody->setLinearVelocity(currentVel + additionalVel);
-            m_RigidBody->activate(true);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::AddVelocity;
+            command.body = m_RigidBody;
+            command.Vector = PhysUtils::GlmToBullet(velocity);
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -195,8 +221,11 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->setAngularVelocity(PhysUtils::GlmToBullet(angularVelocity));
-            m_RigidBody->activate(true);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetAngularVelocity;
+            command.body = m_RigidBody;
+            command.Vector = PhysUtils::GlmToBullet(angularVelocity);
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -204,6 +233,7 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
+            PhysicsEngine::WaitForStep();
             return PhysUtils::BulletToGlm(m_RigidBody->getLinearVelocity());
         }
         return glm::vec3(0.0f);
@@ -213,6 +243,7 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
+            PhysicsEngine::WaitForStep();
             return PhysUtils::BulletToGlm(m_RigidBody->getAngularVelocity());
         }
         return glm::vec3(0.0f);
@@ -222,7 +253,11 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->activate(forceActivation);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::Activate;
+            command.body = m_RigidBody;
+            command.Scalar = forceActivation ? 1 : 0;
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -230,7 +265,12 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->setWorldTransform(worldTrans);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetWorldTransform;
+            command.body = m_RigidBody;
+            command.Vector = worldTrans.getOrigin();
+            command.Rotation = worldTrans.getRotation();
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -238,7 +278,11 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->setFriction(friction);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetFriction;
+            command.body = m_RigidBody;
+            command.Scalar = friction;
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
@@ -246,14 +290,32 @@ namespace Coffee {
     {
         if (m_RigidBody)
         {
-            m_RigidBody->setRestitution(restitution);
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::SetRestitution;
+            command.body = m_RigidBody;
+            command.Scalar = restitution;
+            PhysicsEngine::SubmitCommand(command);
         }
     }
 
+    void RigidBody::SetCollisionLayer(int layer)
+    {
+        if (m_RigidBody)
+        {
+            PhysicsEngine::SetCollisionLayer(m_RigidBody, layer);
+        }
+    }
+
+    int RigidBody::GetCollisionLayer() const
+    {
+        return PhysicsEngine::GetCollisionLayer(m_RigidBody);
+    }
+
     float RigidBody::GetRestitution() const
     {
         if (m_RigidBody)
         {
+            PhysicsEngine::WaitForStep();
             return m_RigidBody->getRestitution();
         }
         return 0.0f;
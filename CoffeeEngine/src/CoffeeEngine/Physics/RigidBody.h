@@ -2,8 +2,12 @@
 #include "Collider.h"
 #include "CollisionCallbacks.h"
 
+#include <entt/entity/entity.hpp>
+
 namespace Coffee {
 
+    class PhysicsMotionState;
+
     enum class RigidBodyType {
         Static,     // Does not move, not affected by forces
         Dynamic,    // Moves and is affected by physics forces
@@ -39,7 +43,14 @@ namespace Coffee {
         explicit RigidBody(RigidBodyConfig& config);
         ~RigidBody();
 
+        /** @brief Reads the settings back from the body, waiting for an in-flight step first. */
         void GetConfig(RigidBodyConfig& config);
+        /** @brief Reads the interpolated pose and linear velocity in a single pass, waiting for an in-flight step first. */
+        void GetState(glm::vec3& position, glm::quat& rotation, glm::vec3& velocity) const;
+        /** @brief Sets the pose Bullet will pick up for a kinematic body on the next step. */
+        void SetKinematicTransform(const glm::vec3& position, const glm::quat& rotation);
+        /** @brief Sets the entity reported in the moved-bodies list when Bullet moves this body. */
+        void SetEntity(entt::entity entity);
         
         void ApplyForce(const glm::vec3& force, const glm::vec3& point = glm::vec3(0.0f));
         void ApplyImpulse(const glm::vec3& impulse, const glm::vec3& point = glm::vec3(0.0f));
@@ -49,7 +60,9 @@ namespace Coffee {
 
         void SetVelocity(const glm::vec3& velocity);
         void SetAngularVelocity(const glm::vec3& angularVelocity);
+        /** @brief Gets the linear velocity, waiting for an in-flight step first. */
         glm::vec3 GetVelocity() const;
+        /** @brief Gets the angular velocity, waiting for an in-flight step first. */
         glm::vec3 GetAngularVelocity() const;
         void AddVelocity(const glm::vec3& velocity);
         void SetTransform(const glm::mat4& transform);
@@ -59,13 +72,20 @@ namespace Coffee {
         void SetFriction(float friction);
         void SetRestitution(float restitution);
         float GetRestitution() const;
+        /** @brief Moves the body to another collision layer, see PhysicsSettings::CollisionMatrix. */
+        void SetCollisionLayer(int layer);
+        /** @brief Gets the collision layer of the body. */
+        int GetCollisionLayer() const;
         
     private:
+        PhysicsMotionState* GetPhysicsMotionState() const;
+
         btRigidBody* m_RigidBody;
     
         CollisionCallbacks m_Callbacks;
         
         friend class PhysicsEngine;
+        friend class Vehicle;
     };
 
 } // Coffee
@@ -0,0 +1,39 @@
+/**
+ * @file RigidbodyBatch.h
+ * @brief Declares the RigidbodyBatch struct used by the batched rigidbody pass.
+ */
+
+#pragma once
+
+#include <entt/entity/entity.hpp>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @struct RigidbodyBatch
+     * @brief Rigidbody entities of a scene split by body type into contiguous ranges.
+     *
+     * Rebuilt once per tick from the RigidbodyComponent/TransformComponent view so each
+     * physics pass only walks the bodies it cares about.
+     */
+    struct RigidbodyBatch
+    {
+        std::vector<entt::entity> Static;    ///< Bodies that never move.
+        std::vector<entt::entity> Kinematic; ///< Bodies moved by the scene and pushed to Bullet.
+        std::vector<entt::entity> Dynamic;   ///< Bodies simulated by Bullet and pulled back into the scene.
+
+        /** @brief Empties all ranges while keeping their capacity. */
+        void Clear()
+        {
+            Static.clear();
+            Kinematic.clear();
+            Dynamic.clear();
+        }
+
+        /** @brief Gets the total number of bodies in the batch. */
+        size_t Size() const { return Static.size() + Kinematic.size() + Dynamic.size(); }
+    };
+
+} // namespace Coffee
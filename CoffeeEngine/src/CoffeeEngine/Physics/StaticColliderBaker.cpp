@@ -0,0 +1,267 @@
+#include "StaticColliderBaker.h"
+#include "CollisionShapeCache.h"
+#include "PhysicsArena.h"
+#include "PhysicsEngine.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Scene/Components.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        /**
+         * @struct BakeSource
+         * @brief A static collider picked for baking and the hash of its shape and pose.
+         */
+        struct BakeSource
+        {
+            btCollisionObject* Object;
+            uint64_t Hash;
+        };
+
+        uint64_t HashSource(const btCollisionObject* object)
+        {
+            // FNV-1a over the shape, which the shape cache shares by geometry, and the world pose
+            uint64_t hash = 14695981039346656037ull;
+            auto combine = [&hash](const void* data, size_t size) {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+            };
+
+            const btCollisionShape* shape = object->getCollisionShape();
+            combine(&shape, sizeof(shape));
+
+            const btTransform& transform = object->getWorldTransform();
+            for (int row = 0; row < 3; ++row)
+                combine(&transform.getBasis()[row], 3 * sizeof(btScalar));
+            combine(&transform.getOrigin(), 3 * sizeof(btScalar));
+
+            return hash;
+        }
+    }
+
+    std::unordered_map<StaticColliderBaker::CellKey, StaticColliderBaker::CachedCell, StaticColliderBaker::CellKeyHash>
+        StaticColliderBaker::s_Cache;
+    std::vector<StaticColliderBaker::ActiveCell> StaticColliderBaker::s_Active;
+
+    size_t StaticColliderBaker::CellKeyHash::operator()(const CellKey& key) const
+    {
+        size_t seed = std::hash<int>()(key.X);
+
+        auto combine = [&seed](int value) { seed ^= std::hash<int>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+
+        combine(key.Y);
+        combine(key.Z);
+        combine(key.Layer);
+        seed ^= std::hash<float>()(key.Friction) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<float>()(key.Restitution) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+        return seed;
+    }
+
+    void StaticColliderBaker::Bake(entt::registry& registry, float cellSize)
+    {
+        ZoneScoped;
+
+        Restore();
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+        if (!world)
+            return;
+
+        // The broadphase is edited below, an asynchronous step must not be reading it
+        PhysicsEngine::WaitForStep();
+
+        cellSize = std::max(cellSize, 1.0f);
+
+        std::unordered_map<CellKey, std::vector<BakeSource>, CellKeyHash> cells;
+
+        auto view = registry.view<ColliderComponent>();
+        for (auto entity : view)
+        {
+            auto& colliderComponent = view.get<ColliderComponent>(entity);
+            if (!colliderComponent.m_Collider || colliderComponent.m_Collider->HasCollisionListeners())
+                continue;
+
+            // Triggers and moving bodies need their own object, concave children are poorly supported by compounds
+            btCollisionObject* object = colliderComponent.m_Collider->GetCollisionObject();
+            if (!object->isStaticObject() || !object->hasContactResponse() || !object->getBroadphaseHandle() ||
+                object->getCollisionShape()->isConcave())
+                continue;
+
+            const btVector3& origin = object->getWorldTransform().getOrigin();
+            const CellKey key{static_cast<int>(std::floor(origin.x() / cellSize)),
+                              static_cast<int>(std::floor(origin.y() / cellSize)),
+                              static_cast<int>(std::floor(origin.z() / cellSize)),
+                              PhysicsEngine::GetCollisionLayer(object),
+                              static_cast<float>(object->getFriction()),
+                              static_cast<float>(object->getRestitution())};
+
+            cells[key].push_back({object, HashSource(object)});
+        }
+
+        // Cells gone from the scene, or edited down to a single collider, leave the cache
+        std::erase_if(s_Cache, [&](auto& entry) {
+            auto it = cells.find(entry.first);
+            if (it != cells.end() && it->second.size() > 1)
+                return false;
+
+            DestroyCachedCell(entry.second);
+            return true;
+        });
+
+        size_t reused = 0;
+        size_t merged = 0;
+
+        for (auto& [key, sources] : cells)
+        {
+            // A lone collider gains nothing from a compound
+            if (sources.size() < 2)
+                continue;
+
+            // Children follow the hash order, so an unchanged cell hashes the same whatever order the view gave
+            std::sort(sources.begin(), sources.end(),
+                      [](const BakeSource& a, const BakeSource& b) { return a.Hash < b.Hash; });
+
+            uint64_t cellHash = 14695981039346656037ull;
+            for (const BakeSource& source : sources)
+                cellHash = (cellHash ^ source.Hash) * 1099511628211ull;
+
+            CachedCell& cached = s_Cache[key];
+            if (cached.Shape && cached.Hash == cellHash)
+            {
+                reused++;
+            }
+            else
+            {
+                DestroyCachedCell(cached);
+                cached.Hash = cellHash;
+                cached.Shape = new btCompoundShape(true, static_cast<int>(sources.size()));
+                cached.Children.reserve(sources.size());
+
+                for (const BakeSource& source : sources)
+                {
+                    btCollisionShape* shape = source.Object->getCollisionShape();
+                    CollisionShapeCache::Retain(shape);
+                    cached.Children.push_back(shape);
+                    cached.Shape->addChildShape(source.Object->getWorldTransform(), shape);
+                }
+            }
+
+            ActiveCell active;
+            active.Key = key;
+            active.Object = PhysicsArena::CreateCollisionObject();
+            active.Object->setCollisionShape(cached.Shape);
+            active.Object->setWorldTransform(btTransform::getIdentity());
+            active.Object->setCollisionFlags(active.Object->getCollisionFlags() | btCollisionObject::CF_STATIC_OBJECT);
+            active.Object->setFriction(key.Friction);
+            active.Object->setRestitution(key.Restitution);
+
+            // Pairs without callbacks on both sides are skipped, bodies touching the level must still hear about it
+            active.Callbacks = CreateScope<CollisionCallbacks>();
+            active.Object->setUserPointer(active.Callbacks.get());
+
+            active.Sources.reserve(sources.size());
+            for (const BakeSource& source : sources)
+            {
+                world->removeCollisionObject(source.Object);
+                active.Sources.push_back(source.Object);
+            }
+
+            world->addCollisionObject(active.Object, PhysicsEngine::GetCollisionGroup(key.Layer),
+                                      PhysicsEngine::GetCollisionMask(key.Layer));
+
+            merged += sources.size();
+            s_Active.push_back(std::move(active));
+        }
+
+        if (!s_Active.empty())
+        {
+            COFFEE_CORE_INFO("StaticColliderBaker: Merged {0} static colliders into {1} cells, {2} reused from cache",
+                             merged, s_Active.size(), reused);
+        }
+    }
+
+    void StaticColliderBaker::Restore()
+    {
+        if (s_Active.empty())
+            return;
+
+        ZoneScoped;
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+
+        // Take the cells out first, destroying the compound objects calls back into Forget
+        std::vector<ActiveCell> active = std::move(s_Active);
+        s_Active.clear();
+
+        for (ActiveCell& cell : active)
+        {
+            PhysicsEngine::DestroyCollisionObject(cell.Object);
+
+            for (btCollisionObject* source : cell.Sources)
+            {
+                world->addCollisionObject(source, PhysicsEngine::GetCollisionGroup(cell.Key.Layer),
+                                          PhysicsEngine::GetCollisionMask(cell.Key.Layer));
+            }
+        }
+    }
+
+    void StaticColliderBaker::Forget(const btCollisionObject* object)
+    {
+        for (ActiveCell& cell : s_Active)
+        {
+            auto it = std::find(cell.Sources.begin(), cell.Sources.end(), object);
+            if (it == cell.Sources.end())
+                continue;
+
+            // Sources line up with the compound children, and both remove by swapping in the last one
+            auto cached = s_Cache.find(cell.Key);
+            const int index = static_cast<int>(it - cell.Sources.begin());
+            cached->second.Shape->removeChildShapeByIndex(index);
+            cached->second.Hash = 0;
+            PhysicsEngine::GetWorld()->updateSingleAabb(cell.Object);
+
+            *it = cell.Sources.back();
+            cell.Sources.pop_back();
+            return;
+        }
+    }
+
+    void StaticColliderBaker::Clear()
+    {
+        Restore();
+
+        for (auto& [key, cell] : s_Cache)
+            DestroyCachedCell(cell);
+        s_Cache.clear();
+    }
+
+    size_t StaticColliderBaker::GetBakedColliderCount()
+    {
+        size_t count = 0;
+        for (const ActiveCell& cell : s_Active)
+            count += cell.Sources.size();
+        return count;
+    }
+
+    void StaticColliderBaker::DestroyCachedCell(CachedCell& cell)
+    {
+        delete cell.Shape;
+        for (btCollisionShape* shape : cell.Children)
+            CollisionShapeCache::Release(shape);
+
+        cell = CachedCell();
+    }
+
+} // namespace Coffee
@@ -0,0 +1,109 @@
+/**
+ * @file StaticColliderBaker.h
+ * @brief Declares the StaticColliderBaker class that merges static colliders into regional compounds.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CollisionCallbacks.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <entt/entity/registry.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee
+{
+
+    /**
+     * @class StaticColliderBaker
+     * @brief Replaces static colliders with one compound object per grid cell, collision layer and surface.
+     *
+     * Every cell becomes a single broadphase proxy whose btCompoundShape keeps its children in
+     * its own dynamic AABB tree, so thousands of level boxes cost the broadphase a handful of
+     * proxies. Triggers, colliders with collision listeners and concave shapes stay separate.
+     * Colliders only share a compound with colliders of the same friction and restitution, and
+     * bodies touching a compound receive its callbacks, which point to no collider.
+     *
+     * Compound shapes are cached by cell together with a hash of the pose and shape of every
+     * child. Baking again reuses the cells nobody touched and rebuilds the ones holding an
+     * edited, added or removed static entity.
+     */
+    class StaticColliderBaker
+    {
+      public:
+        /**
+         * @brief Bakes the static colliders of a scene, restoring the previous bake first.
+         * @param registry The scene registry.
+         * @param cellSize Edge length of the grid cells in world units.
+         */
+        static void Bake(entt::registry& registry, float cellSize);
+
+        /** @brief Removes the compounds from the world and puts the individual colliders back, the cache is kept. */
+        static void Restore();
+
+        /**
+         * @brief Drops a collider being destroyed from the bake, its cell is rebuilt on the next bake.
+         * @param object The collider's collision object.
+         */
+        static void Forget(const btCollisionObject* object);
+
+        /** @brief Restores the colliders and deletes every cached compound. */
+        static void Clear();
+
+        /** @brief Gets the number of compound objects in the world. */
+        static size_t GetCellCount() { return s_Active.size(); }
+        /** @brief Gets the number of colliders merged into the compounds in the world. */
+        static size_t GetBakedColliderCount();
+
+      private:
+        /**
+         * @struct CellKey
+         * @brief A grid cell and the collision layer and surface of the colliders merged in it.
+         */
+        struct CellKey
+        {
+            int X;
+            int Y;
+            int Z;
+            int Layer;
+            float Friction;
+            float Restitution;
+
+            bool operator==(const CellKey& other) const = default;
+        };
+
+        /** @brief Hashes a CellKey. */
+        struct CellKeyHash
+        {
+            size_t operator()(const CellKey& key) const;
+        };
+
+        /** @brief A compound shape built for a cell and the hash of the colliders it was built from. */
+        struct CachedCell
+        {
+            uint64_t Hash = 0;
+            btCompoundShape* Shape = nullptr;
+            std::vector<btCollisionShape*> Children; ///< Shapes retained from the CollisionShapeCache.
+        };
+
+        /** @brief A compound in the world and the colliders it replaces. */
+        struct ActiveCell
+        {
+            CellKey Key;
+            btCollisionObject* Object = nullptr;
+            std::vector<btCollisionObject*> Sources;
+            Scope<CollisionCallbacks> Callbacks; ///< User pointer of the compound, so its contacts are dispatched.
+        };
+
+        /** @brief Deletes a cached compound and releases its children. */
+        static void DestroyCachedCell(CachedCell& cell);
+
+        static std::unordered_map<CellKey, CachedCell, CellKeyHash> s_Cache; ///< Compounds of the last bake by cell.
+        static std::vector<ActiveCell> s_Active;                             ///< Compounds currently in the world.
+    };
+
+} // namespace Coffee
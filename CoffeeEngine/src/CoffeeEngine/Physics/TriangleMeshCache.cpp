@@ -0,0 +1,186 @@
+#include "TriangleMeshCache.h"
+#include "PhysUtils.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <fstream>
+#include <string>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr uint32_t kBvhMagic = 0x48564243; ///< "CBVH"
+        constexpr uint32_t kBvhVersion = 1;
+
+        /**
+         * @struct BvhFileHeader
+         * @brief Header written before the serialized BVH.
+         */
+        struct BvhFileHeader
+        {
+            uint32_t Magic = kBvhMagic;
+            uint32_t Version = kBvhVersion;
+            uint64_t MeshHash = 0;   ///< Hash of the mesh data the BVH was built from.
+            uint32_t BufferSize = 0; ///< Size of the serialized BVH that follows.
+            uint32_t Padding = 0;
+        };
+    }
+
+    std::unordered_map<uint64_t, TriangleMeshCache::Entry> TriangleMeshCache::s_Entries;
+    std::unordered_map<btBvhTriangleMeshShape*, uint64_t> TriangleMeshCache::s_Meshes;
+
+    btBvhTriangleMeshShape* TriangleMeshCache::Acquire(const Ref<Mesh>& mesh)
+    {
+        if (!mesh || mesh->GetIndices().size() < 3 || mesh->GetVertices().empty())
+            return nullptr;
+
+        const uint64_t uuid = mesh->GetUUID();
+
+        Entry& entry = s_Entries[uuid];
+        if (entry.Shape)
+        {
+            entry.References++;
+            return entry.Shape;
+        }
+
+        ZoneScoped;
+
+        const std::vector<Vertex>& vertices = mesh->GetVertices();
+        const std::vector<uint32_t>& indices = mesh->GetIndices();
+
+        // Bullet reads the positions in place, skipping the rest of each vertex
+        btIndexedMesh indexedMesh;
+        indexedMesh.m_numTriangles = static_cast<int>(indices.size() / 3);
+        indexedMesh.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(indices.data());
+        indexedMesh.m_triangleIndexStride = 3 * sizeof(uint32_t);
+        indexedMesh.m_numVertices = static_cast<int>(vertices.size());
+        indexedMesh.m_vertexBase = reinterpret_cast<const unsigned char*>(&vertices[0].Position);
+        indexedMesh.m_vertexStride = sizeof(Vertex);
+        indexedMesh.m_indexType = PHY_INTEGER;
+        indexedMesh.m_vertexType = PHY_FLOAT;
+
+        entry.Source = mesh;
+        entry.Triangles = new btTriangleIndexVertexArray();
+        entry.Triangles->addIndexedMesh(indexedMesh, PHY_INTEGER);
+
+        const uint64_t hash = PhysUtils::HashMeshGeometry(*mesh);
+        if (LoadBvh(uuid, hash, entry))
+        {
+            entry.Shape = new btBvhTriangleMeshShape(entry.Triangles, true, false);
+            entry.Shape->setOptimizedBvh(entry.LoadedBvh);
+        }
+        else
+        {
+            entry.Shape = new btBvhTriangleMeshShape(entry.Triangles, true, true);
+            SaveBvh(uuid, hash, *entry.Shape->getOptimizedBvh());
+            COFFEE_CORE_INFO("TriangleMeshCache: Built BVH for mesh {0} ({1} triangles)", mesh->GetName(),
+                             indexedMesh.m_numTriangles);
+        }
+
+        s_Meshes.emplace(entry.Shape, uuid);
+        entry.References++;
+        return entry.Shape;
+    }
+
+    void TriangleMeshCache::Release(btBvhTriangleMeshShape* shape)
+    {
+        auto meshIt = s_Meshes.find(shape);
+        if (meshIt == s_Meshes.end())
+            return;
+
+        auto entryIt = s_Entries.find(meshIt->second);
+        if (--entryIt->second.References > 0)
+            return;
+
+        DestroyEntry(entryIt->second);
+        s_Entries.erase(entryIt);
+        s_Meshes.erase(meshIt);
+    }
+
+    void TriangleMeshCache::Clear()
+    {
+        for (auto& [uuid, entry] : s_Entries)
+            DestroyEntry(entry);
+
+        s_Entries.clear();
+        s_Meshes.clear();
+    }
+
+    std::filesystem::path TriangleMeshCache::GetBvhPath(uint64_t uuid)
+    {
+        return CacheManager::GetCachedFilePath(std::to_string(uuid) + "_bvh");
+    }
+
+    bool TriangleMeshCache::LoadBvh(uint64_t uuid, uint64_t hash, Entry& entry)
+    {
+        ZoneScoped;
+
+        std::ifstream file(GetBvhPath(uuid), std::ios::binary);
+        if (!file)
+            return false;
+
+        BvhFileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Magic != kBvhMagic ||
+            header.Version != kBvhVersion || header.MeshHash != hash || header.BufferSize == 0)
+            return false;
+
+        void* buffer = btAlignedAlloc(header.BufferSize, 16);
+        if (!file.read(static_cast<char*>(buffer), header.BufferSize))
+        {
+            btAlignedFree(buffer);
+            return false;
+        }
+
+        btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(buffer, header.BufferSize, false);
+        if (!bvh)
+        {
+            btAlignedFree(buffer);
+            return false;
+        }
+
+        entry.LoadedBvh = bvh;
+        entry.BvhBuffer = buffer;
+        return true;
+    }
+
+    void TriangleMeshCache::SaveBvh(uint64_t uuid, uint64_t hash, const btOptimizedBvh& bvh)
+    {
+        ZoneScoped;
+
+        BvhFileHeader header;
+        header.MeshHash = hash;
+        header.BufferSize = bvh.calculateSerializeBufferSize();
+
+        void* buffer = btAlignedAlloc(header.BufferSize, 16);
+        if (bvh.serializeInPlace(buffer, header.BufferSize, false))
+        {
+            std::ofstream file(GetBvhPath(uuid), std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(static_cast<const char*>(buffer), header.BufferSize);
+
+            if (!file)
+                COFFEE_CORE_WARN("TriangleMeshCache: Could not write the BVH cache of mesh {0}", uuid);
+        }
+        btAlignedFree(buffer);
+    }
+
+    void TriangleMeshCache::DestroyEntry(Entry& entry)
+    {
+        // A loaded BVH is not owned by the shape and its arrays point into the buffer
+        delete entry.Shape;
+        if (entry.LoadedBvh)
+        {
+            entry.LoadedBvh->~btOptimizedBvh();
+            btAlignedFree(entry.BvhBuffer);
+        }
+        delete entry.Triangles;
+
+        entry = Entry();
+    }
+
+} // namespace Coffee
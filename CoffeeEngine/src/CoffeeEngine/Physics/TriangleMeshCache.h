@@ -0,0 +1,75 @@
+/**
+ * @file TriangleMeshCache.h
+ * @brief Declares the TriangleMeshCache class that builds and caches BVH triangle-mesh shapes.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+namespace Coffee
+{
+
+    class Mesh;
+
+    /**
+     * @class TriangleMeshCache
+     * @brief Reference-counted cache of static triangle-mesh shapes keyed by mesh UUID.
+     *
+     * The shape reads positions and indices straight from the mesh, which is kept alive while
+     * the shape is in use. The quantized BVH is written to the CacheManager directory the first
+     * time a mesh is cooked and read back in place on later loads instead of being rebuilt.
+     */
+    class TriangleMeshCache
+    {
+      public:
+        /**
+         * @brief Gets the unscaled shape of a mesh, building or loading its BVH if needed, and adds a reference to it.
+         * @param mesh The mesh to collide against.
+         * @return The shared shape, nullptr if the mesh has no triangles.
+         */
+        static btBvhTriangleMeshShape* Acquire(const Ref<Mesh>& mesh);
+
+        /**
+         * @brief Removes a reference from a shape returned by Acquire and deletes it when unused.
+         * @param shape The shape to release.
+         */
+        static void Release(btBvhTriangleMeshShape* shape);
+
+        /** @brief Deletes every cached shape regardless of its references. */
+        static void Clear();
+
+        /** @brief Gets the number of meshes with a live shape. */
+        static size_t GetShapeCount() { return s_Entries.size(); }
+
+      private:
+        /** @brief A mesh shape, the data it points into and the number of users holding it. */
+        struct Entry
+        {
+            Ref<Mesh> Source;                               ///< Mesh owning the vertex and index data.
+            btTriangleIndexVertexArray* Triangles = nullptr; ///< Strided view over the mesh data.
+            btBvhTriangleMeshShape* Shape = nullptr;
+            btOptimizedBvh* LoadedBvh = nullptr;            ///< BVH read from the cache, lives inside BvhBuffer.
+            void* BvhBuffer = nullptr;                      ///< 16 byte aligned buffer the loaded BVH was read into.
+            uint32_t References = 0;
+        };
+
+        /** @brief Gets the cache file of a mesh BVH. */
+        static std::filesystem::path GetBvhPath(uint64_t uuid);
+        /** @brief Reads a BVH saved for the mesh, false if there is none or it was built from other geometry. */
+        static bool LoadBvh(uint64_t uuid, uint64_t hash, Entry& entry);
+        /** @brief Writes the BVH of a freshly built shape. */
+        static void SaveBvh(uint64_t uuid, uint64_t hash, const btOptimizedBvh& bvh);
+        /** @brief Frees a shape and the data it was built from. */
+        static void DestroyEntry(Entry& entry);
+
+        static std::unordered_map<uint64_t, Entry> s_Entries;                  ///< Shapes by mesh UUID.
+        static std::unordered_map<btBvhTriangleMeshShape*, uint64_t> s_Meshes; ///< Reverse lookup used on release.
+    };
+
+} // namespace Coffee
@@ -0,0 +1,75 @@
+#include "Vehicle.h"
+#include "PhysUtils.h"
+#include "VehicleSystem.h"
+
+#include <algorithm>
+#include <glm/gtc/constants.hpp>
+
+namespace Coffee
+{
+
+    Vehicle::Vehicle(const VehicleConfig& config, const Ref<RigidBody>& chassis)
+        : m_Chassis(chassis), m_Body(chassis->m_RigidBody), m_Config(config)
+    {
+        m_Vehicle = VehicleSystem::CreateVehicle(m_Body, m_Config);
+    }
+
+    Vehicle::~Vehicle()
+    {
+        VehicleSystem::DestroyVehicle(m_Vehicle);
+    }
+
+    void Vehicle::SetControls(float throttle, float brake, float steering)
+    {
+        throttle = std::clamp(throttle, -1.0f, 1.0f);
+        brake = std::clamp(brake, 0.0f, 1.0f);
+        steering = std::clamp(steering, -1.0f, 1.0f);
+
+        // Sleeping vehicles are not updated, so new inputs have to wake the chassis. A held
+        // throttle keeps it awake even when the vehicle is stuck against a wall.
+        if (throttle != 0.0f || throttle != m_Throttle || brake != m_Brake || steering != m_Steering)
+            m_Chassis->Activate();
+
+        m_Throttle = throttle;
+        m_Brake = brake;
+        m_Steering = steering;
+
+        const float engineForce = throttle * m_Config.MaxEngineForce;
+        const float brakeForce = brake * m_Config.MaxBrakeForce;
+        const float steeringAngle = glm::radians(steering * m_Config.MaxSteeringAngle);
+
+        for (int i = 0; i < m_Vehicle->getNumWheels(); ++i)
+        {
+            const WheelConfig& wheel = m_Config.Wheels[i];
+            m_Vehicle->applyEngineForce(wheel.Driven ? engineForce : 0.0f, i);
+            m_Vehicle->setBrake(brakeForce, i);
+            m_Vehicle->setSteeringValue(wheel.Steered ? steeringAngle : 0.0f, i);
+        }
+    }
+
+    bool Vehicle::IsAttached() const
+    {
+        return m_Chassis->m_RigidBody == m_Body;
+    }
+
+    int Vehicle::GetWheelCount() const
+    {
+        return m_Vehicle->getNumWheels();
+    }
+
+    glm::mat4 Vehicle::GetWheelTransform(int wheel) const
+    {
+        return PhysUtils::Mat4BulletToGlm(m_Vehicle->getWheelInfo(wheel).m_worldTransform);
+    }
+
+    bool Vehicle::IsWheelInContact(int wheel) const
+    {
+        return m_Vehicle->getWheelInfo(wheel).m_raycastInfo.m_isInContact;
+    }
+
+    float Vehicle::GetSpeedKmHour() const
+    {
+        return m_Vehicle->getCurrentSpeedKmHour();
+    }
+
+} // namespace Coffee
@@ -0,0 +1,130 @@
+/**
+ * @file Vehicle.h
+ * @brief Declares the Vehicle class, a raycast vehicle driving a RigidBody chassis.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include "RigidBody.h"
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+
+class btRaycastVehicle;
+
+namespace Coffee
+{
+
+    /**
+     * @struct WheelConfig
+     * @brief Placement and role of one wheel.
+     */
+    struct WheelConfig
+    {
+        glm::vec3 ConnectionPoint = {0.0f, 0.0f, 0.0f}; ///< Top of the suspension in chassis space.
+        float Radius = 0.4f;
+        bool Steered = false; ///< Turned by the steering input.
+        bool Driven = false;  ///< Receives the engine force.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("ConnectionPoint", ConnectionPoint), cereal::make_nvp("Radius", Radius),
+                    cereal::make_nvp("Steered", Steered), cereal::make_nvp("Driven", Driven));
+        }
+    };
+
+    /**
+     * @struct VehicleConfig
+     * @brief Wheel, suspension and tyre settings of a vehicle.
+     *
+     * The defaults fit a 2 x 1 x 4 box chassis with front steering and rear drive.
+     */
+    struct VehicleConfig
+    {
+        std::vector<WheelConfig> Wheels = {
+            {{-0.9f, -0.3f, 1.4f}, 0.4f, true, false},
+            {{0.9f, -0.3f, 1.4f}, 0.4f, true, false},
+            {{-0.9f, -0.3f, -1.4f}, 0.4f, false, true},
+            {{0.9f, -0.3f, -1.4f}, 0.4f, false, true}};
+
+        // Suspension
+        float SuspensionRestLength = 0.6f;  ///< Length of the unloaded suspension.
+        float SuspensionStiffness = 20.0f;  ///< Spring constant per unit of chassis mass.
+        float SuspensionCompression = 4.4f; ///< Damping while the spring compresses.
+        float SuspensionRelaxation = 2.3f;  ///< Damping while the spring extends.
+        float MaxSuspensionTravel = 0.5f;   ///< Furthest the spring may compress.
+        float MaxSuspensionForce = 6000.0f;
+
+        // Tyres
+        float FrictionSlip = 10.5f; ///< Tyre grip, higher values slide less.
+        float RollInfluence = 0.1f; ///< Scales the side forces that roll the chassis, 0 never rolls.
+
+        // Drive
+        float MaxEngineForce = 2000.0f;
+        float MaxBrakeForce = 100.0f;
+        float MaxSteeringAngle = 30.0f; ///< Degrees.
+    };
+
+    /**
+     * @class Vehicle
+     * @brief A btRaycastVehicle updated by the VehicleSystem on the body of a RigidBody.
+     *
+     * The vehicle holds a reference on its chassis, so the body stays in the world as long as
+     * the vehicle does. Controls and wheel poses are read and written between steps.
+     */
+    class Vehicle
+    {
+      public:
+        /**
+         * @brief Creates the vehicle.
+         * @param config Wheels, suspension and tyre settings.
+         * @param chassis The dynamic body the wheels are attached to.
+         */
+        Vehicle(const VehicleConfig& config, const Ref<RigidBody>& chassis);
+        ~Vehicle();
+
+        Vehicle(const Vehicle&) = delete;
+        Vehicle& operator=(const Vehicle&) = delete;
+
+        /**
+         * @brief Sets the driver inputs, waking the chassis when they change.
+         * @param throttle Engine force as a fraction of VehicleConfig::MaxEngineForce, negative reverses.
+         * @param brake Brake force as a fraction of VehicleConfig::MaxBrakeForce.
+         * @param steering Steering angle as a fraction of VehicleConfig::MaxSteeringAngle, positive turns towards +X.
+         */
+        void SetControls(float throttle, float brake, float steering);
+
+        /** @brief Gets the chassis the vehicle drives. */
+        const Ref<RigidBody>& GetChassis() const { return m_Chassis; }
+        /**
+         * @brief Checks if the vehicle is still attached to the body of its chassis.
+         *
+         * RigidBody::ApplyShape replaces the body, the vehicle must then be created again
+         * before the next step or its wheels push on a freed body.
+         */
+        bool IsAttached() const;
+        /** @brief Gets the number of wheels. */
+        int GetWheelCount() const;
+        /** @brief Gets the world transform of a wheel after the last step. */
+        glm::mat4 GetWheelTransform(int wheel) const;
+        /** @brief Checks if a wheel touched the ground in the last step. */
+        bool IsWheelInContact(int wheel) const;
+        /** @brief Gets the speed along the chassis forward axis in km/h. */
+        float GetSpeedKmHour() const;
+
+      private:
+        Ref<RigidBody> m_Chassis;
+        btRigidBody* m_Body = nullptr; ///< Body of the chassis the vehicle was created on.
+        btRaycastVehicle* m_Vehicle = nullptr;
+        VehicleConfig m_Config;
+
+        float m_Throttle = 0.0f;
+        float m_Brake = 0.0f;
+        float m_Steering = 0.0f;
+    };
+
+} // namespace Coffee
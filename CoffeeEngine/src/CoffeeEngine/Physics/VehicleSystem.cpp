@@ -0,0 +1,226 @@
+#include "VehicleSystem.h"
+#include "PhysUtils.h"
+#include "PhysicsEngine.h"
+#include "Vehicle.h"
+
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <LinearMath/btAabbUtil2.h>
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        constexpr btScalar kProbeBoundsMargin = 0.25f; ///< Slack on the probe tree leaves so slow vehicles skip the reinsert.
+    }
+
+    VehicleSystem::VehicleAction VehicleSystem::s_Action;
+    VehicleSystem::WheelProbeRaycaster VehicleSystem::s_Raycaster;
+    std::vector<VehicleSystem::VehicleEntry> VehicleSystem::s_Vehicles;
+    std::vector<VehicleSystem::WheelProbe> VehicleSystem::s_Probes;
+    btDbvt VehicleSystem::s_ProbeTree;
+
+    void VehicleSystem::Install(btDynamicsWorld* world)
+    {
+        world->addAction(&s_Action);
+    }
+
+    btRaycastVehicle* VehicleSystem::CreateVehicle(btRigidBody* chassis, const VehicleConfig& config)
+    {
+        // The vehicle list is walked by the step
+        PhysicsEngine::WaitForStep();
+
+        btRaycastVehicle::btVehicleTuning tuning;
+        tuning.m_suspensionStiffness = config.SuspensionStiffness;
+        tuning.m_suspensionCompression = config.SuspensionCompression;
+        tuning.m_suspensionDamping = config.SuspensionRelaxation;
+        tuning.m_maxSuspensionTravelCm = config.MaxSuspensionTravel * 100.0f;
+        tuning.m_frictionSlip = config.FrictionSlip;
+        tuning.m_maxSuspensionForce = config.MaxSuspensionForce;
+
+        auto* vehicle = new btRaycastVehicle(tuning, chassis, &s_Raycaster);
+        vehicle->setCoordinateSystem(0, 1, 2);
+
+        const btVector3 wheelDirection(0.0f, -1.0f, 0.0f);
+        const btVector3 wheelAxle(-1.0f, 0.0f, 0.0f);
+        for (const WheelConfig& wheel : config.Wheels)
+        {
+            btWheelInfo& info = vehicle->addWheel(PhysUtils::GlmToBullet(wheel.ConnectionPoint), wheelDirection,
+                                                  wheelAxle, config.SuspensionRestLength, wheel.Radius, tuning,
+                                                  wheel.Steered);
+            info.m_rollInfluence = config.RollInfluence;
+        }
+
+        VehicleEntry entry;
+        entry.Vehicle = vehicle;
+        entry.Leaf = s_ProbeTree.insert(btDbvtVolume::FromCR(chassis->getWorldTransform().getOrigin(), 0.0f),
+                                        reinterpret_cast<void*>(s_Vehicles.size()));
+        entry.FirstProbe = 0;
+        entry.Awake = false;
+        s_Vehicles.push_back(entry);
+
+        return vehicle;
+    }
+
+    void VehicleSystem::DestroyVehicle(btRaycastVehicle* vehicle)
+    {
+        PhysicsEngine::WaitForStep();
+
+        auto it = std::find_if(s_Vehicles.begin(), s_Vehicles.end(),
+                               [vehicle](const VehicleEntry& entry) { return entry.Vehicle == vehicle; });
+        if (it == s_Vehicles.end())
+            return;
+
+        s_ProbeTree.remove(it->Leaf);
+
+        // Swap in the last vehicle and point its leaf at the new index
+        const size_t index = static_cast<size_t>(it - s_Vehicles.begin());
+        *it = s_Vehicles.back();
+        s_Vehicles.pop_back();
+        if (index < s_Vehicles.size())
+            s_Vehicles[index].Leaf->data = reinterpret_cast<void*>(index);
+
+        delete vehicle;
+    }
+
+    void VehicleSystem::VehicleAction::updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep)
+    {
+        if (s_Vehicles.empty())
+            return;
+
+        ZoneScopedN("Vehicles");
+
+        ProbeWheels(collisionWorld);
+
+        for (const VehicleEntry& entry : s_Vehicles)
+        {
+            if (!entry.Awake)
+                continue;
+
+            s_Raycaster.m_Next = s_Probes.data() + entry.FirstProbe;
+            s_Raycaster.m_End = s_Raycaster.m_Next + entry.Vehicle->getNumWheels();
+            entry.Vehicle->updateVehicle(deltaTimeStep);
+        }
+
+        s_Raycaster.m_Next = nullptr;
+        s_Raycaster.m_End = nullptr;
+    }
+
+    void* VehicleSystem::WheelProbeRaycaster::castRay(const btVector3& from, const btVector3& to,
+                                                      btVehicleRaycasterResult& result)
+    {
+        // btRaycastVehicle::updateVehicle casts exactly one ray per wheel, in wheel order
+        if (m_Next == m_End)
+            return nullptr;
+
+        const WheelProbe& probe = *m_Next++;
+        if (!probe.Object)
+            return nullptr;
+
+        result.m_hitPointInWorld = probe.Point;
+        result.m_hitNormalInWorld = probe.Normal.normalized();
+        result.m_distFraction = probe.Fraction;
+        return const_cast<btCollisionObject*>(probe.Object);
+    }
+
+    void VehicleSystem::ProbeWheels(btCollisionWorld* world)
+    {
+        ZoneScoped;
+
+        s_Probes.clear();
+
+        for (VehicleEntry& entry : s_Vehicles)
+        {
+            btRaycastVehicle* vehicle = entry.Vehicle;
+            entry.FirstProbe = s_Probes.size();
+
+            // Sleeping chassis are left alone, like Bullet does with every other sleeping body
+            entry.Awake = vehicle->getRigidBody()->isActive() && vehicle->getNumWheels() > 0;
+            if (!entry.Awake)
+                continue;
+
+            btVector3 boundsMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+            btVector3 boundsMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+
+            for (int i = 0; i < vehicle->getNumWheels(); ++i)
+            {
+                // The ray btRaycastVehicle::rayCast would cast for this wheel
+                btWheelInfo& wheel = vehicle->getWheelInfo(i);
+                vehicle->updateWheelTransformsWS(wheel, false);
+                const btScalar length = wheel.getSuspensionRestLength() + wheel.m_wheelsRadius;
+
+                WheelProbe& probe = s_Probes.emplace_back();
+                probe.From = wheel.m_raycastInfo.m_hardPointWS;
+                probe.To = probe.From + wheel.m_raycastInfo.m_wheelDirectionWS * length;
+                probe.Fraction = 1.0f;
+                probe.Object = nullptr;
+
+                boundsMin.setMin(probe.From);
+                boundsMin.setMin(probe.To);
+                boundsMax.setMax(probe.From);
+                boundsMax.setMax(probe.To);
+            }
+
+            btDbvtVolume bounds = btDbvtVolume::FromMM(boundsMin, boundsMax);
+            s_ProbeTree.update(entry.Leaf, bounds, kProbeBoundsMargin);
+        }
+
+        /** @brief Runs the narrowphase for the wheels of a vehicle whose bounds overlap an object. */
+        struct ProbeCollider : public btDbvt::ICollide
+        {
+            void Process(const btDbvtNode* objectLeaf, const btDbvtNode* vehicleLeaf) override
+            {
+                const VehicleEntry& entry = s_Vehicles[reinterpret_cast<size_t>(vehicleLeaf->data)];
+                if (!entry.Awake)
+                    return;
+
+                const btDbvtProxy* proxy = static_cast<const btDbvtProxy*>(objectLeaf->data);
+                auto* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+
+                // Wheels pass through their own chassis and triggers and follow the chassis collision filter
+                const btRigidBody* chassis = entry.Vehicle->getRigidBody();
+                if (object == chassis || !object->hasContactResponse())
+                    return;
+
+                const btBroadphaseProxy* chassisProxy = chassis->getBroadphaseHandle();
+                if (!(proxy->m_collisionFilterGroup & chassisProxy->m_collisionFilterMask) ||
+                    !(chassisProxy->m_collisionFilterGroup & proxy->m_collisionFilterMask))
+                    return;
+
+                WheelProbe* probes = s_Probes.data() + entry.FirstProbe;
+                for (int i = 0; i < entry.Vehicle->getNumWheels(); ++i)
+                {
+                    WheelProbe& probe = probes[i];
+
+                    // Most wheels of a vehicle miss most of the objects its bounds overlap
+                    btScalar fraction = probe.Fraction;
+                    btVector3 normal;
+                    if (!btRayAabb(probe.From, probe.To, proxy->m_aabbMin, proxy->m_aabbMax, fraction, normal))
+                        continue;
+
+                    btCollisionWorld::ClosestRayResultCallback result(probe.From, probe.To);
+                    result.m_closestHitFraction = probe.Fraction;
+                    btCollisionWorld::rayTestSingle(btTransform(btQuaternion::getIdentity(), probe.From),
+                                                    btTransform(btQuaternion::getIdentity(), probe.To), object,
+                                                    object->getCollisionShape(), object->getWorldTransform(), result);
+
+                    if (result.hasHit())
+                    {
+                        probe.Fraction = result.m_closestHitFraction;
+                        probe.Point = result.m_hitPointWorld;
+                        probe.Normal = result.m_hitNormalWorld;
+                        probe.Object = object;
+                    }
+                }
+            }
+        } collider;
+
+        // One traversal of each broadphase tree against the bounds of every vehicle
+        btDbvtBroadphase* broadphase = static_cast<btDbvtBroadphase*>(world->getBroadphase());
+        for (btDbvt& set : broadphase->m_sets)
+            s_ProbeTree.collideTT(set.m_root, s_ProbeTree.m_root, collider);
+    }
+
+} // namespace Coffee
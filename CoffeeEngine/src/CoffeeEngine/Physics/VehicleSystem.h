@@ -0,0 +1,108 @@
+/**
+ * @file VehicleSystem.h
+ * @brief Declares the VehicleSystem that steps every raycast vehicle with one batched wheel query.
+ */
+
+#pragma once
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <BulletCollision/BroadphaseCollision/btDbvt.h>
+
+#include <vector>
+
+namespace Coffee
+{
+
+    struct VehicleConfig;
+
+    /**
+     * @class VehicleSystem
+     * @brief Owns the btRaycastVehicles of the world and updates them from a single world action.
+     *
+     * Bullet's vehicles cast one world ray per wheel from their own action. Here every wheel ray
+     * of every awake vehicle is gathered first, each vehicle contributes the bounds of its rays
+     * to a small tree, and that tree is collided against both broadphase trees in one pass. The
+     * narrowphase then only runs for the wheels whose ray crosses an object's bounds, and the
+     * vehicles read their hits back through a raycaster that returns the precomputed results.
+     *
+     * Vehicles are added and removed between steps, their chassis must already be in the world.
+     */
+    class VehicleSystem
+    {
+      public:
+        /**
+         * @brief Adds the vehicle action to a newly created world.
+         * @param world The world.
+         */
+        static void Install(btDynamicsWorld* world);
+
+        /**
+         * @brief Creates a vehicle on a chassis and starts updating it.
+         * @param chassis The chassis body, Y up and Z forward.
+         * @param config Wheels, suspension and tyre settings.
+         * @return The vehicle, destroy it with DestroyVehicle.
+         */
+        static btRaycastVehicle* CreateVehicle(btRigidBody* chassis, const VehicleConfig& config);
+
+        /**
+         * @brief Stops updating a vehicle and deletes it, the chassis is left alone.
+         * @param vehicle The vehicle.
+         */
+        static void DestroyVehicle(btRaycastVehicle* vehicle);
+
+        /** @brief Gets the number of vehicles being updated. */
+        static size_t GetVehicleCount() { return s_Vehicles.size(); }
+
+      private:
+        /** @brief The world action every vehicle is updated from. */
+        class VehicleAction : public btActionInterface
+        {
+          public:
+            void updateAction(btCollisionWorld* collisionWorld, btScalar deltaTimeStep) override;
+            void debugDraw(btIDebugDraw* debugDrawer) override {}
+        };
+
+        /**
+         * @struct WheelProbe
+         * @brief A wheel ray and its closest hit.
+         */
+        struct WheelProbe
+        {
+            btVector3 From;
+            btVector3 To;
+            btVector3 Point;                  ///< World-space hit point.
+            btVector3 Normal;                 ///< World-space hit normal.
+            btScalar Fraction;                ///< Hit distance as a fraction of the ray, 1 on a miss.
+            const btCollisionObject* Object;  ///< Hit object, null on a miss.
+        };
+
+        /** @brief Returns the hits of the probes of the vehicle being updated, in wheel order. */
+        class WheelProbeRaycaster : public btVehicleRaycaster
+        {
+          public:
+            void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result) override;
+
+            const WheelProbe* m_Next = nullptr;
+            const WheelProbe* m_End = nullptr;
+        };
+
+        /** @brief A vehicle, its leaf in the probe tree and the range of its probes. */
+        struct VehicleEntry
+        {
+            btRaycastVehicle* Vehicle;
+            btDbvtNode* Leaf;
+            size_t FirstProbe;
+            bool Awake; ///< Whether the chassis was active when the probes were cast.
+        };
+
+        /** @brief Casts the wheel rays of every awake vehicle against the world. */
+        static void ProbeWheels(btCollisionWorld* world);
+
+        static VehicleAction s_Action;
+        static WheelProbeRaycaster s_Raycaster;
+        static std::vector<VehicleEntry> s_Vehicles;
+        static std::vector<WheelProbe> s_Probes;
+        static btDbvt s_ProbeTree; ///< Bounds of the wheel rays of every vehicle, leaf data is the vehicle index.
+    };
+
+} // namespace Coffee
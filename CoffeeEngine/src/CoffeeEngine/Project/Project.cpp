@@ -3,6 +3,7 @@
 #include "CoffeeEngine/IO/CacheManager.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/Physics/PhysicsEngine.h"
 
 #include <cereal/archives/json.hpp>
 
@@ -26,6 +27,8 @@ namespace Coffee {
         CacheManager::SetCachePath(s_ActiveProject->m_ProjectDirectory / s_ActiveProject->m_CacheDirectory);
         ResourceLoader::SetWorkingDirectory(s_ActiveProject->m_ProjectDirectory);
 
+        PhysicsEngine::ApplySettings(s_ActiveProject->m_PhysicsSettings);
+
         return s_ActiveProject;
     }
 
@@ -48,6 +51,8 @@ namespace Coffee {
         ResourceLoader::SetWorkingDirectory(s_ActiveProject->m_ProjectDirectory);
         ResourceLoader::LoadDirectory(project->m_ProjectDirectory);
 
+        PhysicsEngine::ApplySettings(project->m_PhysicsSettings);
+
         return project;
     }
 
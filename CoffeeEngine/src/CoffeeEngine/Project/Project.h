@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Physics/PhysicsSettings.h"
 #include <cereal/cereal.hpp>
 #include <filesystem>
 #include <string>
@@ -65,6 +66,12 @@ namespace Coffee {
          */
         static std::filesystem::path GetCacheDirectory() { return s_ActiveProject->GetProjectDirectory() / s_ActiveProject->m_CacheDirectory; }
 
+        /**
+         * @brief Gets the physics settings of the active project.
+         * @return PhysicsSettings& Reference to the physics settings.
+         */
+        static PhysicsSettings& GetPhysicsSettings() { return s_ActiveProject->m_PhysicsSettings; }
+
         /**
          * @brief Serializes the project data.
          * @tparam Archive The type of the archive.
@@ -76,6 +83,15 @@ namespace Coffee {
             archive(cereal::make_nvp("Name", m_Name),
                     cereal::make_nvp("StartScene",m_StartScenePath.string()),
                     cereal::make_nvp("CacheDirectory", m_CacheDirectory));
+
+            // Older projects have no physics section, keep the defaults for them
+            try
+            {
+                archive(cereal::make_nvp("Physics", m_PhysicsSettings));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
         }
 
     private:
@@ -85,6 +101,8 @@ namespace Coffee {
 
         std::filesystem::path m_StartScenePath; ///< The path to the start scene.
 
+        PhysicsSettings m_PhysicsSettings; ///< The physics settings of the project.
+
         inline static Ref<Project> s_ActiveProject; ///< The active project.
     };
 
@@ -6,6 +6,8 @@
 
 #include "CoffeeEngine/Embedded/DebugLineShader.inl"
 
+#include <algorithm>
+#include <cstring>
 #include <glm/ext/quaternion_trigonometric.hpp>
 #include <glm/fwd.hpp>
 
@@ -89,6 +91,16 @@ namespace Coffee {
         }
     }
 
+    void DebugRenderer::DrawLines(const DebugVertex* vertices, int count)
+    {
+        count = std::min(count, static_cast<int>(MaxVertices) - m_LineVertexCount) & ~1;
+        if (count > 0)
+        {
+            std::memcpy(m_LineVertices + m_LineVertexCount, vertices, count * sizeof(DebugVertex));
+            m_LineVertexCount += count;
+        }
+    }
+
     void DebugRenderer::DrawCircle(const glm::vec3& position, float radius, const glm::quat& rotation, glm::vec4 color, float lineWidth)
     {
         const int segments = 32;
@@ -64,6 +64,18 @@ namespace Coffee {
          */
         static void DrawLine(const glm::vec3& start, const glm::vec3& end, glm::vec4 color = glm::vec4(1.0f), float lineWidth = 1.0f);
 
+        /**
+         * @brief Copies a batch of lines into the line buffer at once.
+         * @param vertices Pairs of vertices, one pair per line.
+         * @param count The number of vertices, lines that don't fit in the buffer are dropped.
+         */
+        static void DrawLines(const DebugVertex* vertices, int count);
+
+        /**
+         * @brief Gets the number of line vertices the buffer holds per frame.
+         */
+        static int GetMaxLineVertices() { return MaxVertices; }
+
         /**
          * @brief Draws a circle.
          * @param position The center position of the circle.
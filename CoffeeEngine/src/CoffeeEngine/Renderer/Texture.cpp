@@ -32,6 +32,7 @@ namespace Coffee {
             case ImageFormat::RGB32F: return GL_RGB32F; break;
             case ImageFormat::RGBA32F: return GL_RGBA32F; break;
             case ImageFormat::DEPTH24STENCIL8: return GL_DEPTH24_STENCIL8; break;
+            case ImageFormat::R16: return GL_R16; break;
         }
     }
 
@@ -49,9 +50,15 @@ namespace Coffee {
             case ImageFormat::RGB32F: return GL_RGB; break;
             case ImageFormat::RGBA32F: return GL_RGBA; break;
             case ImageFormat::DEPTH24STENCIL8: return GL_DEPTH_STENCIL; break;
+            case ImageFormat::R16: return GL_RED; break;
         }
     }
 
+    GLenum ImageFormatToOpenGLType(ImageFormat format)
+    {
+        return format == ImageFormat::R16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    }
+
     int ImageFormatToChannelCount(ImageFormat format)
     {
         switch(format)
@@ -66,6 +73,7 @@ namespace Coffee {
             case ImageFormat::RGB32F: return 3; break;
             case ImageFormat::RGBA32F: return 4; break;
             case ImageFormat::DEPTH24STENCIL8: return 1; break;
+            case ImageFormat::R16: return 1; break;
         }
     }
 
@@ -112,19 +120,33 @@ namespace Coffee {
 
         int nrComponents;
         stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(m_FilePath.string().c_str(), &m_Width, &m_Height, &nrComponents, 0);
+
+        // Grayscale 16-bit images are heightmaps, they keep their full precision
+        int bytesPerChannel = 1;
+        void* data = nullptr;
+        if (stbi_is_16_bit(m_FilePath.string().c_str()) &&
+            stbi_info(m_FilePath.string().c_str(), &m_Width, &m_Height, &nrComponents) && nrComponents == 1)
+        {
+            data = stbi_load_16(m_FilePath.string().c_str(), &m_Width, &m_Height, &nrComponents, 1);
+            bytesPerChannel = 2;
+        }
+        else
+        {
+            data = stbi_load(m_FilePath.string().c_str(), &m_Width, &m_Height, &nrComponents, 0);
+        }
 
         m_Properties.Width = m_Width, m_Properties.Height = m_Height;
 
         if(data)
         {
-            m_Data = std::vector<unsigned char>(data, data + m_Width * m_Height * nrComponents);
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            m_Data = std::vector<unsigned char>(bytes, bytes + m_Width * m_Height * nrComponents * bytesPerChannel);
             stbi_image_free(data);
 
             switch (nrComponents)
             {
                 case 1:
-                    m_Properties.Format = ImageFormat::R8;
+                    m_Properties.Format = bytesPerChannel == 2 ? ImageFormat::R16 : ImageFormat::R8;
                 break;
                 case 3:
                     m_Properties.Format = m_Properties.srgb ? ImageFormat::SRGB8 : ImageFormat::RGB8;
@@ -151,7 +173,11 @@ namespace Coffee {
             //Add an option to choose the anisotropic filtering level
             glTextureParameterf(m_textureID, GL_TEXTURE_MAX_ANISOTROPY, 16.0f);
 
-            glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, GL_UNSIGNED_BYTE, m_Data.data());
+            // Decoded rows are tightly packed, odd widths of 1, 2 and 3 byte pixels are not 4 byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format,
+                                ImageFormatToOpenGLType(m_Properties.Format), m_Data.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
             glGenerateTextureMipmap(m_textureID);
         }
@@ -226,7 +252,9 @@ namespace Coffee {
         ZoneScoped;
 
         GLenum format = ImageFormatToOpenGLFormat(m_Properties.Format);
-        glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, ImageFormatToOpenGLType(m_Properties.Format), data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         glGenerateTextureMipmap(m_textureID);
     }
 
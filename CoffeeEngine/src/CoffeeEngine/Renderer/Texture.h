@@ -27,7 +27,8 @@ namespace Coffee {
         R32F,
         RGB32F,
         RGBA32F,
-        DEPTH24STENCIL8
+        DEPTH24STENCIL8,
+        R16 ///< Single 16-bit channel, used by heightmaps.
     };
 
     struct TextureProperties
@@ -94,6 +95,9 @@ namespace Coffee {
         void Clear(glm::vec4 color);
         void SetData(void* data, uint32_t size);
 
+        /** @brief Gets the pixels kept in memory since loading, rows bottom to top, 2 bytes per channel for R16. */
+        const std::vector<unsigned char>& GetData() const { return m_Data; }
+
         static Ref<Texture2D> Load(const std::filesystem::path& path, bool srgb = true);
         static Ref<Texture2D> Create(uint32_t width, uint32_t height, ImageFormat format);
 
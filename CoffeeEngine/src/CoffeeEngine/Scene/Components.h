@@ -12,6 +12,7 @@
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Model.h"
 #include "CoffeeEngine/Scene/SceneCamera.h"
+#include "CoffeeEngine/Scene/Terrain.h"
 #include "src/CoffeeEngine/IO/Serialization/GLMSerialization.h"
 #include "src/CoffeeEngine/IO/Serialization/BulletSerialization.h"
 #include "CoffeeEngine/Physics/PhysicsEngine.h"
@@ -25,7 +26,9 @@
 #include <glm/gtc/quaternion.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
+#include "CoffeeEngine/Physics/CharacterController.h"
 #include "CoffeeEngine/Physics/RigidBody.h"
+#include "CoffeeEngine/Physics/Vehicle.h"
 
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -306,6 +309,14 @@ namespace Coffee
                     cereal::make_nvp("AngularDrag", cfg.AngularDrag),
                     cereal::make_nvp("Friction", cfg.friction),
                     cereal::make_nvp("Restitution", cfg.restitution));
+            // Scenes saved before collision layers put every body on the default layer
+            try
+            {
+                archive(cereal::make_nvp("CollisionLayer", cfg.shapeConfig.layer));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
             if (Archive::is_loading::value)
             {
                 m_RigidBody = std::make_shared<RigidBody>(cfg);
@@ -386,6 +397,17 @@ namespace Coffee
             }
         }
 
+        /**
+         * @brief Moves the rigidbody to another collision layer.
+         * @param layer Index of the layer in the project's collision matrix.
+         */
+        void SetCollisionLayer(int layer)
+        {
+            cfg.shapeConfig.layer = layer;
+            if (m_RigidBody)
+                m_RigidBody->SetCollisionLayer(layer);
+        }
+
         glm::vec3 GetVelocity() const
         {
             if (m_RigidBody)
@@ -409,13 +431,143 @@ namespace Coffee
         }
     };
 
+    /**
+     * @brief Component that drives the RigidbodyComponent of its entity as a raycast vehicle.
+     * @ingroup scene
+     *
+     * The vehicle is created by the scene once the chassis body exists. Throttle, Brake and
+     * Steering are the driver inputs, written by scripts or AI and applied every frame.
+     */
+    struct VehicleComponent
+    {
+        Ref<Vehicle> m_Vehicle = nullptr;
+        VehicleConfig cfg;
+
+        float Throttle = 0.0f; ///< -1 to 1, negative reverses.
+        float Brake = 0.0f;    ///< 0 to 1.
+        float Steering = 0.0f; ///< -1 to 1, positive turns towards +X.
+
+        /**
+         * @brief Serializes the VehicleComponent.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         */
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Wheels", cfg.Wheels),
+                    cereal::make_nvp("SuspensionRestLength", cfg.SuspensionRestLength),
+                    cereal::make_nvp("SuspensionStiffness", cfg.SuspensionStiffness),
+                    cereal::make_nvp("SuspensionCompression", cfg.SuspensionCompression),
+                    cereal::make_nvp("SuspensionRelaxation", cfg.SuspensionRelaxation),
+                    cereal::make_nvp("MaxSuspensionTravel", cfg.MaxSuspensionTravel),
+                    cereal::make_nvp("MaxSuspensionForce", cfg.MaxSuspensionForce),
+                    cereal::make_nvp("FrictionSlip", cfg.FrictionSlip),
+                    cereal::make_nvp("RollInfluence", cfg.RollInfluence),
+                    cereal::make_nvp("MaxEngineForce", cfg.MaxEngineForce),
+                    cereal::make_nvp("MaxBrakeForce", cfg.MaxBrakeForce),
+                    cereal::make_nvp("MaxSteeringAngle", cfg.MaxSteeringAngle));
+            if (Archive::is_loading::value)
+            {
+                m_Vehicle = nullptr;
+            }
+        }
+    };
+
+    /**
+     * @brief Component that moves its entity as a kinematic capsule that collides with the world.
+     * @ingroup scene
+     *
+     * Unlike a kinematic RigidbodyComponent, the character is swept against the world and
+     * slides along walls, climbs steps and follows the ground. Velocity and JumpRequested
+     * are the inputs, written by scripts and applied every frame.
+     */
+    struct CharacterControllerComponent
+    {
+        Ref<CharacterController> m_Controller = nullptr;
+        CharacterControllerConfig cfg;
+
+        glm::vec3 Velocity = {0.0f, 0.0f, 0.0f}; ///< Walk velocity, the vertical part is ignored.
+        float JumpSpeed = 5.0f;                   ///< Upward speed given by a jump.
+        bool JumpRequested = false;               ///< Jumps on the next frame if grounded, then clears.
+
+        /**
+         * @brief Serializes the CharacterControllerComponent.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         */
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Config", cfg), cereal::make_nvp("JumpSpeed", JumpSpeed));
+            if (Archive::is_loading::value)
+            {
+                m_Controller = nullptr;
+            }
+        }
+    };
+
+    /**
+     * @brief Component that centres physics LOD rings on its entity, like the active camera does.
+     * @ingroup scene
+     *
+     * Lets players, AI directors or split-screen views keep full-rate physics around them.
+     */
+    struct PhysicsLodAnchorComponent
+    {
+        float RadiusScale = 1.0f; ///< Multiplies the LOD ring radii around this anchor.
+
+        /**
+         * @brief Serializes the PhysicsLodAnchorComponent.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         */
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("RadiusScale", RadiusScale));
+        }
+    };
+
+    /**
+     * @brief Component that turns a heightmap into terrain chunks streamed around the camera.
+     * @ingroup scene
+     *
+     * The first heightmap pixel sits at the entity position, rotation and scale are ignored.
+     * The chunk colliders and meshes are rebuilt when the heightmap, the settings or the
+     * position change.
+     */
+    struct TerrainComponent
+    {
+        Ref<Terrain> m_Terrain = nullptr;
+        Ref<Texture2D> Heightmap = nullptr; ///< Grayscale heightmap, 16 bit images keep their precision.
+        TerrainConfig cfg;
+
+        /**
+         * @brief Serializes the TerrainComponent.
+         * @tparam Archive The type of the archive.
+         * @param archive The archive to serialize to.
+         */
+        template <class Archive> void save(Archive& archive) const
+        {
+            archive(cereal::make_nvp("Heightmap", Heightmap ? Heightmap->GetUUID() : UUID::null),
+                    cereal::make_nvp("Config", cfg));
+        }
+
+        template <class Archive> void load(Archive& archive)
+        {
+            UUID heightmapUUID;
+            archive(cereal::make_nvp("Heightmap", heightmapUUID), cereal::make_nvp("Config", cfg));
+            Heightmap = ResourceLoader::LoadTexture2D(heightmapUUID);
+            m_Terrain = nullptr;
+        }
+    };
+
    
     enum class ColliderShape
     {
         Box = 0,
         Sphere,
         Capsule,
-        Cylinder
+        Cylinder,
+        ConvexHull
     };
 
     struct ColliderComponent
@@ -427,10 +579,12 @@ namespace Coffee
         glm::vec3 Size = {1.0f, 1.0f, 1.0f}; // Para Box
         float Radius = 0.5f;                 // Para Sphere, Capsule y Cylinder
         float Height = 1.0f;                 // Para Capsule y Cylinder
+        Ref<Mesh> HullMesh = nullptr;        ///< Mesh the ConvexHull shape is cooked from.
 
         bool IsTrigger = false; // Es un trigger
         float Mass = 0.0f;      // Masa del collider
         int MaterialIndex = 0;  // Índice del material
+        int CollisionLayer = 0; ///< Layer of the collider, see PhysicsSettings::CollisionMatrix.
 
         Ref<Collider> m_Collider = nullptr; // Referencia al Collider
 
@@ -446,6 +600,7 @@ namespace Coffee
             CollisionShapeConfig config;
             config.isTrigger = IsTrigger;
             config.mass = Mass;
+            config.layer = CollisionLayer;
 
             switch (Shape)
             {
@@ -467,15 +622,37 @@ namespace Coffee
                 config.radius = Radius;
                 config.height = Height;
                 break;
+            case ColliderShape::ConvexHull:
+                config.type = CollisionShapeType::CONVEX_HULL;
+                config.mesh = HullMesh;
+                config.size = Size;
+                break;
             }
 
-            glm::vec3 position = glm::vec3(transform.GetWorldTransform()[3]) + Offset;
+            const glm::mat4 worldTransform = transform.GetWorldTransform();
+            glm::vec3 position = glm::vec3(worldTransform[3]) + Offset;
             glm::quat rotation = glm::quat(glm::vec3(0.0f));
+
+            // Hulls are cooked in mesh space, the entity scale sizes them like the rendered mesh
             glm::vec3 scale = glm::vec3(1.0f);
+            if (Shape == ColliderShape::ConvexHull)
+                scale = {glm::length(glm::vec3(worldTransform[0])), glm::length(glm::vec3(worldTransform[1])),
+                         glm::length(glm::vec3(worldTransform[2]))};
 
             m_Collider = std::make_shared<Collider>(config, position, rotation, scale);
         }
 
+        /**
+         * @brief Moves the collider to another collision layer.
+         * @param layer Index of the layer in the project's collision matrix.
+         */
+        void SetCollisionLayer(int layer)
+        {
+            CollisionLayer = layer;
+            if (m_Collider)
+                PhysicsEngine::SetCollisionLayer(m_Collider->GetCollisionObject(), layer);
+        }
+
         /**
          * @brief Serializes the ColliderComponent.
          */
@@ -486,6 +663,27 @@ namespace Coffee
                     cereal::make_nvp("Height", Height), cereal::make_nvp("IsTrigger", IsTrigger),
                     cereal::make_nvp("Mass", Mass), cereal::make_nvp("MaterialIndex", MaterialIndex));
 
+            // Scenes saved before convex hulls have no hull mesh
+            try
+            {
+                UUID hullMeshUUID = HullMesh ? HullMesh->GetUUID() : UUID::null;
+                archive(cereal::make_nvp("HullMesh", hullMeshUUID));
+                if (Archive::is_loading::value && hullMeshUUID != UUID::null)
+                    HullMesh = ResourceRegistry::Get<Mesh>(hullMeshUUID);
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
+            // Scenes saved before collider layers put every collider on the default layer
+            try
+            {
+                archive(cereal::make_nvp("CollisionLayer", CollisionLayer));
+            }
+            catch (const cereal::Exception&)
+            {
+            }
+
             if (Archive::is_loading::value)
             {
                 TransformComponent dummyTransform; // Necesario para crear el Collider
@@ -570,6 +768,9 @@ namespace Coffee
         int MaterialIndex = 0;                 // index for the material dropdown
         int MeshIndex = 0;                     // index for the mesh dropdown
 
+        Ref<Collider> m_Collider = nullptr;         ///< Static triangle mesh collider built from the entity mesh.
+        glm::mat4 m_ColliderTransform = glm::mat4(1.0f); ///< World transform the collider was built with.
+
         MeshColliderComponent() = default;
         MeshColliderComponent(const glm::vec3& size, const glm::vec3& offset, bool isTrigger, bool providesContacts,
                               int cookingOptionsIndex = 1, int materialIndex = 0, int meshIndex = 0)
@@ -577,6 +778,46 @@ namespace Coffee
               CookingOptionsIndex(cookingOptionsIndex), MaterialIndex(materialIndex), MeshIndex(meshIndex)
         {
         }
+
+        /**
+         * @brief Rebuilds the collider from a mesh placed with the entity transform.
+         *
+         * The triangle BVH is shared by every collider of the mesh and read from the cache
+         * directory when the mesh was cooked before.
+         * @param transform The transform of the entity.
+         * @param mesh The mesh to collide against, a box of Size is used if it is null.
+         */
+        void UpdateCollider(TransformComponent& transform, const Ref<Mesh>& mesh)
+        {
+            CollisionShapeConfig config;
+            config.type = CollisionShapeType::MESH;
+            config.mesh = mesh;
+            config.size = Size;
+            config.isTrigger = IsTrigger;
+            config.mass = 0.0f;
+
+            glm::vec3 scale;
+            glm::quat rotation;
+            glm::vec3 position;
+            glm::vec3 skew;
+            glm::vec4 perspective;
+            glm::decompose(transform.GetWorldTransform(), scale, rotation, position, skew, perspective);
+
+            m_Collider = nullptr;
+            m_Collider = std::make_shared<Collider>(config, position + Offset, rotation, scale);
+            m_ColliderTransform = transform.GetWorldTransform();
+        }
+
+        /**
+         * @brief Serializes the MeshColliderComponent, the collider is rebuilt once the mesh is loaded.
+         */
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Size", Size), cereal::make_nvp("Offset", Offset),
+                    cereal::make_nvp("IsTrigger", IsTrigger), cereal::make_nvp("ProvidesContacts", ProvidesContacts),
+                    cereal::make_nvp("CookingOptionsIndex", CookingOptionsIndex),
+                    cereal::make_nvp("MaterialIndex", MaterialIndex));
+        }
     };
 
     // joint
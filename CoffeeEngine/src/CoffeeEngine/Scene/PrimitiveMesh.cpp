@@ -1,6 +1,7 @@
 #include "PrimitiveMesh.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
+#include <algorithm>
 #include <cstdint>
 #include <glm/gtc/constants.hpp>
 #include <vector>
@@ -686,4 +687,66 @@ namespace Coffee {
         return capsuleMesh;
     }
 
+    Ref<Mesh> PrimitiveMesh::CreateHeightfield(const float* heights, int width, int length, float spacing)
+    {
+        std::vector<Vertex> data(static_cast<size_t>(width) * length);
+        std::vector<uint32_t> indices;
+        indices.reserve(static_cast<size_t>(width - 1) * (length - 1) * 6);
+
+        const float halfWidth = (width - 1) * spacing * 0.5f;
+        const float halfLength = (length - 1) * spacing * 0.5f;
+        float minHeight = heights[0];
+        float maxHeight = heights[0];
+
+        auto height = [&](int x, int z) {
+            return heights[std::clamp(z, 0, length - 1) * width + std::clamp(x, 0, width - 1)];
+        };
+
+        for (int z = 0; z < length; z++) {
+            for (int x = 0; x < width; x++) {
+                Vertex& vertex = data[z * width + x];
+                const float y = height(x, z);
+
+                vertex.Position = glm::vec3(x * spacing - halfWidth, y, z * spacing - halfLength);
+                vertex.TexCoords = glm::vec2(x / float(width - 1), z / float(length - 1));
+
+                // Central differences, one-sided on the edges
+                const float dx = (height(x + 1, z) - height(x - 1, z)) / (spacing * float(std::min(x + 1, width - 1) - std::max(x - 1, 0)));
+                const float dz = (height(x, z + 1) - height(x, z - 1)) / (spacing * float(std::min(z + 1, length - 1) - std::max(z - 1, 0)));
+                vertex.Normals = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+                vertex.Tangent = glm::normalize(glm::vec3(1.0f, dx, 0.0f));
+                vertex.Bitangent = glm::cross(vertex.Normals, vertex.Tangent);
+
+                minHeight = std::min(minHeight, y);
+                maxHeight = std::max(maxHeight, y);
+            }
+        }
+
+        // Each quad is split along the same diagonal as the collision shape, so the mesh matches what bodies rest on
+        for (int z = 0; z < length - 1; z++) {
+            for (int x = 0; x < width - 1; x++) {
+                const uint32_t i00 = z * width + x;
+                const uint32_t i10 = i00 + 1;
+                const uint32_t i01 = i00 + width;
+                const uint32_t i11 = i01 + 1;
+
+                indices.push_back(i00);
+                indices.push_back(i01);
+                indices.push_back(i10);
+
+                indices.push_back(i10);
+                indices.push_back(i01);
+                indices.push_back(i11);
+            }
+        }
+
+        const Ref<Mesh>& heightfieldMesh = CreateRef<Mesh>(data, indices);
+        heightfieldMesh->SetName("Heightfield");
+
+        AABB heightfieldAABB(glm::vec3(-halfWidth, minHeight, -halfLength), glm::vec3(halfWidth, maxHeight, halfLength));
+        heightfieldMesh->SetAABB(heightfieldAABB);
+
+        return heightfieldMesh;
+    }
+
 } // namespace Coffee
\ No newline at end of file
@@ -122,6 +122,16 @@ namespace Coffee {
          */
         static Ref<Mesh> CreateCapsule(float radius = 0.5f, float height = 2.0f, int radialSegments = 64, int rings = 8);
 
+        /**
+         * Creates a grid mesh following a heightfield, triangulated like btHeightfieldTerrainShape.
+         * @param heights Height of every grid point, row by row along Z.
+         * @param width Number of points along X.
+         * @param length Number of points along Z.
+         * @param spacing Distance between neighbouring points.
+         * @return A reference to the created mesh, centred on the grid in X and Z.
+         */
+        static Ref<Mesh> CreateHeightfield(const float* heights, int width, int length, float spacing = 1.0f);
+
     };
 
     // Explicit specialization declaration
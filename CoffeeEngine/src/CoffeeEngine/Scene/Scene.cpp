@@ -21,6 +21,7 @@
 #include "CoffeeEngine/Physics/PhysicsEngine.h"
 #include "CoffeeEngine/Physics/Collider.h"
 #include "CoffeeEngine/Physics/PhysUtils.h"
+#include "CoffeeEngine/Physics/StaticColliderBaker.h"
 
 #include <cstdint>
 #include <cstdlib>
@@ -35,11 +36,149 @@
 
 namespace Coffee {
 
-    std::vector<entt::entity> Scene::m_RigidbodyEntities; 
+    // Tags the Bullet body with its entity so the motion state can report it when it moves
+    static void OnRigidbodyConstruct(entt::registry& registry, entt::entity entity)
+    {
+        auto& rigidbodyComponent = registry.get<RigidbodyComponent>(entity);
+        if (rigidbodyComponent.m_RigidBody)
+            rigidbodyComponent.m_RigidBody->SetEntity(entity);
+    }
+
+    // Builds mesh colliders once the entity world transform is known and follows the entity when it moves
+    static void UpdateMeshColliders(entt::registry& registry)
+    {
+        ZoneScoped;
+
+        auto view = registry.view<MeshColliderComponent, MeshComponent, TransformComponent>();
+        for (auto entity : view)
+        {
+            auto [meshCollider, meshComponent, transform] =
+                view.get<MeshColliderComponent, MeshComponent, TransformComponent>(entity);
+
+            if (!meshCollider.m_Collider || meshCollider.m_ColliderTransform != transform.GetWorldTransform())
+                meshCollider.UpdateCollider(transform, meshComponent.GetMesh());
+        }
+    }
+
+    // Puts the vehicles on their chassis body and hands them the driver inputs, between steps
+    static void UpdateVehicles(entt::registry& registry)
+    {
+        ZoneScoped;
+
+        auto view = registry.view<VehicleComponent, RigidbodyComponent>();
+        for (auto entity : view)
+        {
+            auto [vehicle, rigidbody] = view.get<VehicleComponent, RigidbodyComponent>(entity);
+
+            if (!rigidbody.m_RigidBody || rigidbody.cfg.type != RigidBodyType::Dynamic)
+            {
+                vehicle.m_Vehicle = nullptr;
+                continue;
+            }
+
+            // A new shape swaps the body inside the same RigidBody, the old vehicle points at the freed one
+            if (!vehicle.m_Vehicle || vehicle.m_Vehicle->GetChassis() != rigidbody.m_RigidBody ||
+                !vehicle.m_Vehicle->IsAttached())
+            {
+                vehicle.m_Vehicle = nullptr;
+                vehicle.m_Vehicle = std::make_shared<Vehicle>(vehicle.cfg, rigidbody.m_RigidBody);
+            }
+
+            vehicle.m_Vehicle->SetControls(vehicle.Throttle, vehicle.Brake, vehicle.Steering);
+        }
+    }
+
+    // Publishes the character poses of the last step and hands the characters their inputs, between steps
+    static void UpdateCharacters(entt::registry& registry)
+    {
+        ZoneScoped;
+
+        auto view = registry.view<CharacterControllerComponent, TransformComponent>();
+        for (auto entity : view)
+        {
+            auto [character, transform] = view.get<CharacterControllerComponent, TransformComponent>(entity);
+
+            if (!character.m_Controller)
+            {
+                character.m_Controller = std::make_shared<CharacterController>(character.cfg, transform.Position);
+                character.m_Controller->SetEntity(entity);
+            }
+            else
+                transform.Position = character.m_Controller->GetPosition();
+
+            character.m_Controller->SetWalkVelocity(character.Velocity);
+
+            if (character.JumpRequested)
+            {
+                if (character.m_Controller->IsGrounded())
+                    character.m_Controller->Jump(character.JumpSpeed);
+                character.JumpRequested = false;
+            }
+        }
+    }
+
+    // Rebuilds the terrains whose heightmap, settings or position changed and streams their chunks, between steps
+    static void UpdateTerrains(entt::registry& registry, const glm::vec3& center)
+    {
+        ZoneScoped;
+
+        auto view = registry.view<TerrainComponent, TransformComponent>();
+        for (auto entity : view)
+        {
+            auto [terrain, transform] = view.get<TerrainComponent, TransformComponent>(entity);
+
+            const glm::vec3 origin = transform.GetWorldTransform()[3];
+            if (!terrain.Heightmap)
+            {
+                terrain.m_Terrain = nullptr;
+                continue;
+            }
+
+            if (!terrain.m_Terrain || terrain.m_Terrain->GetHeightmap() != terrain.Heightmap ||
+                terrain.m_Terrain->GetConfig() != terrain.cfg || terrain.m_Terrain->GetOrigin() != origin)
+            {
+                // The old chunks leave the world before the new ones stream in
+                terrain.m_Terrain = nullptr;
+                terrain.m_Terrain = std::make_shared<Terrain>(terrain.Heightmap, terrain.cfg, origin);
+            }
+
+            terrain.m_Terrain->Stream(center);
+        }
+    }
+
+    // Draws the loaded terrain chunks inside the frustum
+    static void SubmitTerrains(entt::registry& registry, const Frustum& frustum)
+    {
+        auto view = registry.view<TerrainComponent>();
+        for (auto entity : view)
+        {
+            auto& terrain = view.get<TerrainComponent>(entity);
+            if (!terrain.m_Terrain)
+                continue;
+
+            auto materialComponent = registry.try_get<MaterialComponent>(entity);
+            Ref<Material> material = (materialComponent) ? materialComponent->material : nullptr;
+
+            terrain.m_Terrain->Submit(&frustum, material, (uint32_t)entity);
+        }
+    }
 
     Scene::Scene() : m_Octree({glm::vec3(-50.0f), glm::vec3(50.0f)}, 10, 5)
     {
         m_SceneTree = CreateScope<SceneTree>(this);
+
+        m_Registry.on_construct<RigidbodyComponent>().connect<&OnRigidbodyConstruct>();
+    }
+
+    Scene::~Scene()
+    {
+        // Terrain chunks free their shapes with their colliders, which a batch would keep in the world
+        auto terrainView = m_Registry.view<TerrainComponent>();
+        for (auto entity : terrainView)
+            terrainView.get<TerrainComponent>(entity).m_Terrain = nullptr;
+
+        PhysicsEngine::BatchScope physicsBatch;
+        m_Registry.clear();
     }
 
 /*     Scene::Scene(Ref<Scene> other)
@@ -113,6 +252,10 @@ namespace Coffee {
 
             m_Octree.Insert(objectContainer);
         }
+
+        const PhysicsSettings& physicsSettings = PhysicsEngine::GetSettings();
+        if (physicsSettings.StaticBakeEnabled)
+            StaticColliderBaker::Bake(m_Registry, physicsSettings.StaticBakeCellSize);
     }
 
     void Scene::OnUpdateEditor(EditorCamera& camera, float dt)
@@ -120,6 +263,8 @@ namespace Coffee {
         ZoneScoped;
 
         m_SceneTree->Update();
+        UpdateMeshColliders(m_Registry);
+        UpdateTerrains(m_Registry, camera.GetPosition());
 
         Renderer::BeginScene(camera);
 
@@ -144,6 +289,9 @@ namespace Coffee {
             Renderer::Submit(RenderCommand{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity});
         }
 
+        const Frustum cameraFrustum(camera.GetProjection() * camera.GetViewMatrix());
+        SubmitTerrains(m_Registry, cameraFrustum);
+
         //Get all entities with LightComponent and TransformComponent
         auto lightView = m_Registry.view<LightComponent, TransformComponent>();
 
@@ -170,6 +318,8 @@ namespace Coffee {
             }
         }
 
+        PhysicsEngine::DrawDebugWorld(cameraFrustum);
+
         Renderer::EndScene();
     }
 
@@ -182,7 +332,26 @@ namespace Coffee {
         // Physics Update
         {
             ZoneScopedN("Physics Update");
-            PhysicsEngine::Update(dt);
+            // With async stepping the step below overlaps with the rest of the frame and the
+            // scene receives the poses of the previous step
+            PhysicsEngine::WaitForStep();
+            UpdateMeshColliders(m_Registry);
+            UpdateVehicles(m_Registry);
+            UpdateCharacters(m_Registry);
+
+            // Terrain chunks stream around the camera, the last one found like the renderer below
+            glm::vec3 streamCenter(0.0f);
+            auto streamCameraView = m_Registry.view<TransformComponent, CameraComponent>();
+            for (auto entity : streamCameraView)
+                streamCenter = streamCameraView.get<TransformComponent>(entity).GetWorldTransform()[3];
+            UpdateTerrains(m_Registry, streamCenter);
+
+            PhysicsEngine::BuildRigidbodyBatch(m_Registry, m_RigidbodyBatch);
+            PhysicsEngine::ApplyKinematicBodies(m_Registry, m_RigidbodyBatch, dt);
+            PhysicsEngine::CollectLodAnchors(m_Registry);
+            PhysicsEngine::BeginStep(dt);
+            PhysicsEngine::ApplyRigidbodies(m_Registry);
+            PhysicsEngine::DispatchContactEvents();
         }
 
         Camera* camera = nullptr;
@@ -219,12 +388,16 @@ namespace Coffee {
         Frustum frustum = Frustum(camera->GetProjection() /* testProjection */ * glm::inverse(cameraTransform));
         DebugRenderer::DrawFrustum(frustum, glm::vec4(1.0f), 1.0f);
 
+        PhysicsEngine::SubmitDebugLines(frustum);
+
         auto meshes = m_Octree.Query(frustum);
 
         for(auto& mesh : meshes)
         {
             Renderer::Submit(RenderCommand{mesh.transform, mesh.object, mesh.object->GetMaterial(), 0});
         }
+
+        SubmitTerrains(m_Registry, frustum);
         
 /*         // Get all entities with ModelComponent and TransformComponent
         auto view = m_Registry.view<MeshComponent, TransformComponent>();
@@ -270,22 +443,6 @@ namespace Coffee {
 
             scriptComponent.script.OnUpdate();
         }
-        // Get all entities with RigidbodyComponent
-        auto rigidbodyView = m_Registry.view<RigidbodyComponent, TransformComponent>();
-
-        // Clear the vector at the start of each frame
-        m_RigidbodyEntities.clear();
-
-        // Loop through each entity with the specified components
-        for (auto& entity : rigidbodyView)
-        {
-            auto& rigidbodyComponent = rigidbodyView.get<RigidbodyComponent>(entity);
-            auto& transformComponent = rigidbodyView.get<TransformComponent>(entity);
-            
-            m_RigidbodyEntities.push_back(entity); 
-            PhysicsEngine::ApplyRigidbody(rigidbodyComponent, transformComponent, dt);
-            
-        }
         Renderer::EndScene();
     }
 
@@ -301,7 +458,36 @@ namespace Coffee {
 
     void Scene::OnExitRuntime()
     {
+        // Don't let an in-flight step outlive the scene bodies
+        PhysicsEngine::WaitForStep();
+
+        // Vehicles and characters leave the world with the runtime, they are rebuilt on the next play
+        auto vehicleView = m_Registry.view<VehicleComponent>();
+        for (auto entity : vehicleView)
+            vehicleView.get<VehicleComponent>(entity).m_Vehicle = nullptr;
+
+        auto characterView = m_Registry.view<CharacterControllerComponent>();
+        for (auto entity : characterView)
+            characterView.get<CharacterControllerComponent>(entity).m_Controller = nullptr;
+
+        // Projectiles reference the entities that fired them
+        ProjectileSystem::Clear();
+
+        StaticColliderBaker::Restore();
+    }
 
+    // Loads component storages appended to the scene format over time, in the order they were added.
+    // An older scene ends before the first storage it doesn't know, which stops the loading there.
+    template <typename... Components>
+    static void LoadOptionalComponents(entt::snapshot_loader& loader, cereal::JSONInputArchive& archive)
+    {
+        try
+        {
+            (loader.get<Components>(archive), ...);
+        }
+        catch (const cereal::Exception&)
+        {
+        }
     }
 
     Ref<Scene> Scene::Load(const std::filesystem::path& path)
@@ -313,8 +499,11 @@ namespace Coffee {
         std::ifstream sceneFile(path);
         cereal::JSONInputArchive archive(sceneFile);
 
-        entt::snapshot_loader{scene->m_Registry}
-            .get<entt::entity>(archive)
+        // Every body of the scene enters the world in one batch
+        PhysicsEngine::BatchScope physicsBatch;
+
+        entt::snapshot_loader loader{scene->m_Registry};
+        loader.get<entt::entity>(archive)
             .get<TagComponent>(archive)
             .get<TransformComponent>(archive)
             .get<HierarchyComponent>(archive)
@@ -324,7 +513,11 @@ namespace Coffee {
             .get<LightComponent>(archive)
             .get<RigidbodyComponent>(archive)
             .get<ColliderComponent>(archive);
-        
+
+        // Storages added to the format later, scenes saved before one of them end there
+        LoadOptionalComponents<MeshColliderComponent, VehicleComponent, CharacterControllerComponent, TerrainComponent,
+                               PhysicsLodAnchorComponent>(loader, archive);
+
         scene->m_FilePath = path;
 
         auto view = scene->m_Registry.view<entt::entity>();
@@ -359,7 +552,12 @@ namespace Coffee {
             .get<MaterialComponent>(archive)
             .get<LightComponent>(archive)
             .get<RigidbodyComponent>(archive)
-            .get<ColliderComponent>(archive);
+            .get<ColliderComponent>(archive)
+            .get<MeshColliderComponent>(archive)
+            .get<VehicleComponent>(archive)
+            .get<CharacterControllerComponent>(archive)
+            .get<TerrainComponent>(archive)
+            .get<PhysicsLodAnchorComponent>(archive);
         
         scene->m_FilePath = path;
 
@@ -2,6 +2,7 @@
 
 #include "CoffeeEngine/Core/DataStructures/Octree.h"
 #include "CoffeeEngine/Events/Event.h"
+#include "CoffeeEngine/Physics/RigidbodyBatch.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
 #include "CoffeeEngine/Scene/SceneTree.h"
 #include "entt/entity/fwd.hpp"
@@ -33,9 +34,9 @@ namespace Coffee {
         Scene();
 
         /**
-         * @brief Default destructor.
+         * @brief Destructor, removes the physics bodies of the scene in a single batch.
          */
-        ~Scene() = default;
+        ~Scene();
 
         //Scene(Ref<Scene> other);
 
@@ -105,12 +106,11 @@ namespace Coffee {
 
         const std::filesystem::path& GetFilePath() { return m_FilePath; }
 
-        static std::vector<entt::entity> m_RigidbodyEntities; 
-
     private:
         entt::registry m_Registry;
         Scope<SceneTree> m_SceneTree;
         Octree<Ref<Mesh>> m_Octree;
+        RigidbodyBatch m_RigidbodyBatch; ///< Rigidbody entities split by type, rebuilt every runtime tick.
 
         // Temporal: Scenes should be Resources and the Base Resource class already has a path variable.
         std::filesystem::path m_FilePath;
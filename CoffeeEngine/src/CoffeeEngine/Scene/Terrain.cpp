@@ -0,0 +1,332 @@
+#include "Terrain.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Math/Frustum.h"
+#include "CoffeeEngine/Physics/PhysicsArena.h"
+#include "CoffeeEngine/Physics/PhysicsEngine.h"
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
+#include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Scene/PrimitiveMesh.h"
+
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <bullet/btBulletDynamicsCommon.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <glm/gtc/matrix_transform.hpp>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee
+{
+
+    namespace
+    {
+        int GetChannelCount(ImageFormat format)
+        {
+            switch (format)
+            {
+            case ImageFormat::R8:
+            case ImageFormat::R16: return 1;
+            case ImageFormat::RG8: return 2;
+            case ImageFormat::RGB8:
+            case ImageFormat::SRGB8: return 3;
+            case ImageFormat::RGBA8:
+            case ImageFormat::SRGBA8: return 4;
+            default: return 0;
+            }
+        }
+
+        /** @brief Samples of a chunk, a base of ChunkShape so they exist before the shape reads them. */
+        struct ChunkSamples
+        {
+            std::vector<float> Heights;
+        };
+
+        /** @brief Heightfield shape owning the samples it references. */
+        class ChunkShape : private ChunkSamples, public btHeightfieldTerrainShape
+        {
+          public:
+            ChunkShape(std::vector<float> heights, int width, int length, float minHeight, float maxHeight)
+                : ChunkSamples{std::move(heights)},
+                  btHeightfieldTerrainShape(width, length, Heights.data(), minHeight, maxHeight, 1, false)
+            {
+            }
+
+            const std::vector<float>& GetHeights() const { return Heights; }
+        };
+    } // namespace
+
+    Terrain::Terrain(const Ref<Texture2D>& heightmap, const TerrainConfig& config, const glm::vec3& origin)
+        : m_Heightmap(heightmap), m_Config(config), m_Origin(origin)
+    {
+        if (!heightmap)
+            return;
+
+        const std::vector<unsigned char>& data = heightmap->GetData();
+        const ImageFormat format = heightmap->GetImageFormat();
+        const int channels = GetChannelCount(format);
+        const int width = static_cast<int>(heightmap->GetWidth());
+        const int length = static_cast<int>(heightmap->GetHeight());
+
+        m_WideSamples = format == ImageFormat::R16;
+        m_PixelStride = channels * (m_WideSamples ? 2 : 1);
+
+        if (channels == 0 || width < 2 || length < 2 ||
+            data.size() < static_cast<size_t>(width) * length * m_PixelStride)
+        {
+            COFFEE_CORE_WARN("Terrain: Heightmap {0} has no readable pixel data, use an 8 or 16 bit image",
+                             heightmap->GetName());
+            return;
+        }
+
+        // Pixels are read in place, the texture keeps them alive for as long as the terrain holds it
+        m_Pixels = data.data();
+        m_Width = width;
+        m_Length = length;
+
+        m_ChunkQuads = std::max(m_Config.ChunkQuads, 1);
+        m_ChunksX = (m_Width - 2) / m_ChunkQuads + 1;
+        m_ChunksZ = (m_Length - 2) / m_ChunkQuads + 1;
+        m_Stats.TotalChunks = m_ChunksX * m_ChunksZ;
+    }
+
+    Terrain::Terrain(std::vector<uint16_t> samples, int width, int length, const TerrainConfig& config,
+                     const glm::vec3& origin)
+        : m_Samples(std::move(samples)), m_Config(config), m_Origin(origin)
+    {
+        if (width < 2 || length < 2 || m_Samples.size() < static_cast<size_t>(width) * length)
+        {
+            COFFEE_CORE_WARN("Terrain: {0} heights given for a {1}x{2} terrain", m_Samples.size(), width, length);
+            return;
+        }
+
+        m_Pixels = reinterpret_cast<const unsigned char*>(m_Samples.data());
+        m_PixelStride = sizeof(uint16_t);
+        m_WideSamples = true;
+        m_Width = width;
+        m_Length = length;
+
+        m_ChunkQuads = std::max(m_Config.ChunkQuads, 1);
+        m_ChunksX = (m_Width - 2) / m_ChunkQuads + 1;
+        m_ChunksZ = (m_Length - 2) / m_ChunkQuads + 1;
+        m_Stats.TotalChunks = m_ChunksX * m_ChunksZ;
+    }
+
+    Terrain::~Terrain()
+    {
+        for (auto& [key, chunk] : m_Chunks)
+            UnloadChunk(*chunk);
+    }
+
+    float Terrain::GetSample(int x, int z) const
+    {
+        x = std::clamp(x, 0, m_Width - 1);
+        z = std::clamp(z, 0, m_Length - 1);
+
+        const unsigned char* pixel = m_Pixels + (static_cast<size_t>(z) * m_Width + x) * m_PixelStride;
+
+        float value;
+        if (m_WideSamples)
+        {
+            uint16_t sample;
+            std::memcpy(&sample, pixel, sizeof(sample));
+            value = sample / 65535.0f;
+        }
+        else
+        {
+            value = *pixel / 255.0f;
+        }
+
+        return value * m_Config.HeightScale;
+    }
+
+    float Terrain::GetHeight(float x, float z) const
+    {
+        if (!m_Pixels)
+            return m_Origin.y;
+
+        const float u = (x - m_Origin.x) / m_Config.Spacing;
+        const float v = (z - m_Origin.z) / m_Config.Spacing;
+        const int x0 = static_cast<int>(std::floor(u));
+        const int z0 = static_cast<int>(std::floor(v));
+        const float fx = u - x0;
+        const float fz = v - z0;
+
+        const float h00 = GetSample(x0, z0);
+        const float h10 = GetSample(x0 + 1, z0);
+        const float h01 = GetSample(x0, z0 + 1);
+        const float h11 = GetSample(x0 + 1, z0 + 1);
+
+        // Same split as the collision and render triangles, along the (x, z + 1) to (x + 1, z) diagonal
+        const float height = fx + fz <= 1.0f ? h00 + (h10 - h00) * fx + (h01 - h00) * fz
+                                             : h11 + (h01 - h11) * (1.0f - fx) + (h10 - h11) * (1.0f - fz);
+
+        return m_Origin.y + height;
+    }
+
+    float Terrain::GetChunkDistance2(int chunkX, int chunkZ, const glm::vec3& center) const
+    {
+        const float chunkSize = m_ChunkQuads * m_Config.Spacing;
+        const float minX = m_Origin.x + chunkX * chunkSize;
+        const float minZ = m_Origin.z + chunkZ * chunkSize;
+
+        const float dx = center.x - std::clamp(center.x, minX, minX + chunkSize);
+        const float dz = center.z - std::clamp(center.z, minZ, minZ + chunkSize);
+        return dx * dx + dz * dz;
+    }
+
+    void Terrain::Stream(const glm::vec3& center)
+    {
+        if (!m_Pixels)
+            return;
+
+        ZoneScoped;
+
+        const float radius = m_Config.StreamRadius;
+        const float chunkSize = m_ChunkQuads * m_Config.Spacing;
+
+        // Unloads lag a half chunk behind loads so a chunk on the edge doesn't flicker in and out
+        const float unloadRadius = radius + chunkSize * 0.5f;
+        for (auto it = m_Chunks.begin(); it != m_Chunks.end();)
+        {
+            if (GetChunkDistance2(it->second->X, it->second->Z, center) > unloadRadius * unloadRadius)
+            {
+                UnloadChunk(*it->second);
+                it = m_Chunks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        const int minX = std::max(static_cast<int>(std::floor((center.x - m_Origin.x - radius) / chunkSize)), 0);
+        const int maxX = std::min(static_cast<int>(std::floor((center.x - m_Origin.x + radius) / chunkSize)), m_ChunksX - 1);
+        const int minZ = std::max(static_cast<int>(std::floor((center.z - m_Origin.z - radius) / chunkSize)), 0);
+        const int maxZ = std::min(static_cast<int>(std::floor((center.z - m_Origin.z + radius) / chunkSize)), m_ChunksZ - 1);
+
+        std::vector<std::pair<float, uint64_t>> missing;
+        for (int z = minZ; z <= maxZ; ++z)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                const float distance2 = GetChunkDistance2(x, z, center);
+                if (distance2 <= radius * radius && !m_Chunks.contains(GetChunkKey(x, z)))
+                    missing.emplace_back(distance2, GetChunkKey(x, z));
+            }
+        }
+
+        if (!missing.empty())
+        {
+            // Nearest first, the rest are picked up by the next calls
+            const size_t budget = std::min(missing.size(), static_cast<size_t>(std::max(m_Config.ChunkLoadsPerUpdate, 1)));
+            std::partial_sort(missing.begin(), missing.begin() + budget, missing.end());
+
+            PhysicsEngine::BatchScope batch;
+            for (size_t i = 0; i < budget; ++i)
+            {
+                const uint64_t key = missing[i].second;
+                LoadChunk(static_cast<int>(key >> 32), static_cast<int>(key & 0xffffffffu));
+            }
+        }
+
+        m_Stats.LoadedChunks = static_cast<int>(m_Chunks.size());
+        m_Stats.ChunkBytes = 0;
+        for (const auto& [key, chunk] : m_Chunks)
+            m_Stats.ChunkBytes += chunk->Bytes;
+    }
+
+    void Terrain::LoadChunk(int chunkX, int chunkZ)
+    {
+        ZoneScoped;
+
+        const int quads = m_ChunkQuads;
+        const int startX = chunkX * quads;
+        const int startZ = chunkZ * quads;
+        const int width = std::min(quads, m_Width - 1 - startX) + 1;
+        const int length = std::min(quads, m_Length - 1 - startZ) + 1;
+
+        auto chunk = CreateScope<Chunk>();
+        chunk->X = chunkX;
+        chunk->Z = chunkZ;
+
+        // Neighbouring chunks share their edge samples so the seams line up exactly
+        std::vector<float> heights(static_cast<size_t>(width) * length);
+        float minHeight = std::numeric_limits<float>::max();
+        float maxHeight = std::numeric_limits<float>::lowest();
+        for (int z = 0; z < length; ++z)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const float height = GetSample(startX + x, startZ + z);
+                heights[static_cast<size_t>(z) * width + x] = height;
+                minHeight = std::min(minHeight, height);
+                maxHeight = std::max(maxHeight, height);
+            }
+        }
+
+        // A flat chunk still needs some thickness for the shape's bounds
+        if (maxHeight - minHeight < 1e-3f)
+            maxHeight = minHeight + 1e-3f;
+
+        const float spacing = m_Config.Spacing;
+        const glm::vec3 center = m_Origin + glm::vec3((startX + (width - 1) * 0.5f) * spacing, 0.0f,
+                                                      (startZ + (length - 1) * 0.5f) * spacing);
+
+        auto* shape = new ChunkShape(std::move(heights), width, length, minHeight, maxHeight);
+        chunk->Shape = shape;
+        chunk->Shape->setLocalScaling(btVector3(spacing, 1.0f, spacing));
+        chunk->Shape->buildAccelerator();
+
+        // Bullet centres the shape on its height range, the mesh is built around height zero
+        btTransform transform = btTransform::getIdentity();
+        transform.setOrigin(btVector3(center.x, center.y + (minHeight + maxHeight) * 0.5f, center.z));
+
+        chunk->Object = PhysicsArena::CreateCollisionObject();
+        chunk->Object->setCollisionShape(chunk->Shape);
+        chunk->Object->setWorldTransform(transform);
+        chunk->Object->setCollisionFlags(chunk->Object->getCollisionFlags() | btCollisionObject::CF_STATIC_OBJECT);
+        chunk->Object->setFriction(m_Config.Friction);
+        chunk->Object->setUserPointer(&m_Callbacks);
+        PhysicsEngine::AddCollisionObject(chunk->Object, m_Config.CollisionLayer, true);
+
+        const float halfX = (width - 1) * 0.5f * spacing;
+        const float halfZ = (length - 1) * 0.5f * spacing;
+        chunk->Bounds = AABB(glm::vec3(center.x - halfX, center.y + minHeight, center.z - halfZ),
+                             glm::vec3(center.x + halfX, center.y + maxHeight, center.z + halfZ));
+        chunk->Transform = glm::translate(glm::mat4(1.0f), center);
+        chunk->Bytes = shape->GetHeights().size() * sizeof(float);
+
+        if (m_Heightmap)
+        {
+            chunk->ChunkMesh = PrimitiveMesh::CreateHeightfield(shape->GetHeights().data(), width, length, spacing);
+            chunk->Bytes += chunk->ChunkMesh->GetVertices().size() * sizeof(Vertex) +
+                            chunk->ChunkMesh->GetIndices().size() * sizeof(uint32_t);
+        }
+
+        m_Chunks.emplace(GetChunkKey(chunkX, chunkZ), std::move(chunk));
+    }
+
+    void Terrain::UnloadChunk(Chunk& chunk)
+    {
+        // Inside a batch the object stays in the world until it ends, the engine frees the shape with it
+        PhysicsEngine::DestroyCollisionObject(chunk.Object);
+        chunk.Object = nullptr;
+        chunk.Shape = nullptr;
+    }
+
+    void Terrain::Submit(const Frustum* frustum, const Ref<Material>& material, uint32_t entityID) const
+    {
+        for (const auto& [key, chunk] : m_Chunks)
+        {
+            if (!chunk->ChunkMesh || (frustum && !frustum->Contains(chunk->Bounds)))
+                continue;
+
+            Renderer::Submit(RenderCommand{chunk->Transform, chunk->ChunkMesh, material, entityID});
+        }
+    }
+
+} // namespace Coffee
@@ -0,0 +1,184 @@
+/**
+ * @file Terrain.h
+ * @brief Declares the Terrain class, a heightmap split into chunks streamed around a point.
+ */
+
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Math/BoundingBox.h"
+#include "CoffeeEngine/Physics/CollisionCallbacks.h"
+
+#include <cereal/cereal.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class btCollisionObject;
+class btHeightfieldTerrainShape;
+
+namespace Coffee
+{
+
+    class Frustum;
+    class Material;
+    class Mesh;
+    class Texture2D;
+
+    /**
+     * @struct TerrainConfig
+     * @brief Size, chunking and streaming settings of a terrain.
+     */
+    struct TerrainConfig
+    {
+        float Spacing = 1.0f;         ///< Distance between neighbouring heightmap pixels.
+        float HeightScale = 100.0f;   ///< Height of a white heightmap pixel.
+        int ChunkQuads = 64;          ///< Grid cells along each side of a chunk.
+        float StreamRadius = 256.0f;  ///< Chunks closer than this to the streaming point are loaded.
+        int ChunkLoadsPerUpdate = 8;  ///< Most chunks built by one Stream call, the nearest first.
+        int CollisionLayer = 0;       ///< Layer of the chunk colliders.
+        float Friction = 0.8f;        ///< Friction of the chunk colliders.
+
+        bool operator==(const TerrainConfig& other) const = default;
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Spacing", Spacing), cereal::make_nvp("HeightScale", HeightScale),
+                    cereal::make_nvp("ChunkQuads", ChunkQuads), cereal::make_nvp("StreamRadius", StreamRadius),
+                    cereal::make_nvp("ChunkLoadsPerUpdate", ChunkLoadsPerUpdate),
+                    cereal::make_nvp("CollisionLayer", CollisionLayer), cereal::make_nvp("Friction", Friction));
+        }
+    };
+
+    /**
+     * @struct TerrainStats
+     * @brief Chunks of a terrain in memory after the last Stream call.
+     */
+    struct TerrainStats
+    {
+        int LoadedChunks = 0;  ///< Chunks with a collider, and a mesh when rendered.
+        int TotalChunks = 0;  ///< Chunks the heightmap is split into.
+        size_t ChunkBytes = 0; ///< Heights and mesh data held by the loaded chunks.
+    };
+
+    /**
+     * @class Terrain
+     * @brief A heightmap collided with through btHeightfieldTerrainShape chunks and drawn with matching meshes.
+     *
+     * The heightmap is cut into square chunks of ChunkQuads cells sharing their edge samples.
+     * Only chunks within StreamRadius of the streaming point hold a collider and a mesh, so
+     * memory follows the streamed area rather than the heightmap size. A chunk is a single
+     * static object in the broadphase however many cells it covers.
+     *
+     * The terrain follows the position it was created at, rotation and scale are not applied.
+     * The chunk shapes are handed to PhysicsEngine with their colliders, so an unloaded chunk
+     * keeps its shape until the collider has left the world, inside batches included.
+     */
+    class Terrain
+    {
+      public:
+        /**
+         * @brief Creates a terrain from a grayscale heightmap, no chunk is loaded until Stream.
+         * @param heightmap The heightmap, R16 keeps 16 bits of precision, other formats use their first channel.
+         * @param config Size, chunking and streaming settings.
+         * @param origin World position of the first heightmap pixel.
+         */
+        Terrain(const Ref<Texture2D>& heightmap, const TerrainConfig& config, const glm::vec3& origin);
+
+        /**
+         * @brief Creates a collision-only terrain from heights in memory, for tools and servers without a renderer.
+         * @param samples Heights row by row along Z, 65535 is HeightScale.
+         * @param width Samples along X.
+         * @param length Samples along Z.
+         * @param config Size, chunking and streaming settings.
+         * @param origin World position of the first sample.
+         */
+        Terrain(std::vector<uint16_t> samples, int width, int length, const TerrainConfig& config,
+                const glm::vec3& origin);
+
+        ~Terrain();
+
+        Terrain(const Terrain&) = delete;
+        Terrain& operator=(const Terrain&) = delete;
+
+        /**
+         * @brief Loads the chunks around a point and unloads the ones that fell out of range.
+         * @param center World position to stream around, its height is ignored.
+         */
+        void Stream(const glm::vec3& center);
+
+        /**
+         * @brief Submits the meshes of the loaded chunks to the Renderer.
+         * @param frustum Chunks outside it are skipped, null submits every loaded chunk.
+         * @param material Material of the chunks, null uses the default one.
+         * @param entityID Id written to the entity buffer for picking.
+         */
+        void Submit(const Frustum* frustum, const Ref<Material>& material, uint32_t entityID) const;
+
+        /** @brief Gets the height of the heightmap at a world position, interpolated between samples. */
+        float GetHeight(float x, float z) const;
+
+        /** @brief Gets the heightmap the terrain was created from, null for in-memory heights. */
+        const Ref<Texture2D>& GetHeightmap() const { return m_Heightmap; }
+        /** @brief Gets the settings the terrain was created with. */
+        const TerrainConfig& GetConfig() const { return m_Config; }
+        /** @brief Gets the world position of the first sample. */
+        const glm::vec3& GetOrigin() const { return m_Origin; }
+        /** @brief Gets the chunks held after the last Stream call. */
+        const TerrainStats& GetStats() const { return m_Stats; }
+        /** @brief Gets the callbacks run on contacts and projectile hits against any chunk. */
+        CollisionCallbacks& GetCallbacks() { return m_Callbacks; }
+
+      private:
+        /** @brief A loaded chunk. */
+        struct Chunk
+        {
+            int X = 0;                               ///< Chunk column.
+            int Z = 0;                               ///< Chunk row.
+            btHeightfieldTerrainShape* Shape = nullptr; ///< Owns the samples, deleted by PhysicsEngine with the object.
+            btCollisionObject* Object = nullptr;
+            Ref<Mesh> ChunkMesh;                     ///< Render mesh, null without a heightmap texture.
+            glm::mat4 Transform = glm::mat4(1.0f);   ///< World transform of the mesh.
+            AABB Bounds;                             ///< World bounds of the chunk.
+            size_t Bytes = 0;
+        };
+
+        /** @brief Reads the height of a sample, clamped to the heightmap. */
+        float GetSample(int x, int z) const;
+
+        /** @brief Gets the squared horizontal distance from a point to a chunk. */
+        float GetChunkDistance2(int chunkX, int chunkZ, const glm::vec3& center) const;
+
+        /** @brief Builds the collider and mesh of a chunk and adds the collider to the world. */
+        void LoadChunk(int chunkX, int chunkZ);
+
+        /** @brief Destroys the collider of a chunk, its shape goes with it once it has left the world. */
+        void UnloadChunk(Chunk& chunk);
+
+        static uint64_t GetChunkKey(int chunkX, int chunkZ)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+        }
+
+        Ref<Texture2D> m_Heightmap;
+        std::vector<uint16_t> m_Samples; ///< Heights given in memory, empty when read from the heightmap.
+        const unsigned char* m_Pixels = nullptr;
+        int m_PixelStride = 1;           ///< Bytes from one sample to the next.
+        bool m_WideSamples = false;      ///< Whether samples are 16 bits.
+
+        TerrainConfig m_Config;
+        glm::vec3 m_Origin;
+        int m_Width = 0;
+        int m_Length = 0;
+        int m_ChunkQuads = 1;
+        int m_ChunksX = 0;
+        int m_ChunksZ = 0;
+
+        std::unordered_map<uint64_t, Scope<Chunk>> m_Chunks;
+        TerrainStats m_Stats;
+        CollisionCallbacks m_Callbacks; ///< User pointer of every chunk, contacts without one are not dispatched.
+    };
+
+} // namespace Coffee
@@ -4,6 +4,7 @@
 #include "CoffeeEngine/Core/KeyCodes.h"
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Core/MouseCodes.h"
+#include "CoffeeEngine/Physics/PhysicsQueries.h"
 #include "CoffeeEngine/Scene/Components.h"
 #include "CoffeeEngine/Scene/Entity.h"
 
@@ -335,6 +336,100 @@ namespace Coffee {
         # pragma region Bind Timer Functions
         # pragma endregion
 
+        # pragma region Bind Physics Functions
+        sol::table physicsTable = luaState.create_table();
+
+        // A hit reports the id of its entity, nil when the object has none
+        auto entityToLua = [](sol::state_view lua, entt::entity entity) -> sol::object {
+            if (entity == entt::null)
+                return sol::make_object(lua, sol::lua_nil);
+            return sol::make_object(lua, static_cast<uint32_t>(entity));
+        };
+
+        physicsTable.set_function("raycast", [entityToLua](float ox, float oy, float oz, float dx, float dy, float dz, float maxDistance, sol::this_state state) {
+            sol::state_view lua(state);
+            const glm::vec3 origin(ox, oy, oz);
+            const glm::vec3 direction(dx, dy, dz);
+
+            // Normalizing a zero vector gives NaN, such a ray can't hit anything
+            if (glm::dot(direction, direction) < 1e-12f)
+                return std::make_tuple(false, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, entityToLua(lua, entt::null));
+
+            const glm::vec3 normalized = glm::normalize(direction);
+            const btCollisionObject* object = nullptr;
+            float distance = 0.0f;
+            glm::vec3 point(0.0f), normal(0.0f);
+            entt::entity entity = entt::null;
+
+            RayBatch rays;
+            rays.Origins = {&origin, 1};
+            rays.Directions = {&normalized, 1};
+            rays.MaxDistance = maxDistance;
+
+            QueryHits hits;
+            hits.Objects = {&object, 1};
+            hits.Distances = {&distance, 1};
+            hits.Points = {&point, 1};
+            hits.Normals = {&normal, 1};
+            hits.Entities = {&entity, 1};
+            PhysicsQueries::RaycastBatch(rays, hits);
+
+            return std::make_tuple(object != nullptr, distance, point.x, point.y, point.z, normal.x, normal.y, normal.z,
+                                   entityToLua(lua, entity));
+        });
+
+        // Takes flat {x, y, z, ...} arrays of origins and directions and returns one result table per ray
+        physicsTable.set_function("raycast_batch", [entityToLua](sol::table origins, sol::table directions, float maxDistance, sol::this_state state) {
+            const size_t count = std::min(origins.size(), directions.size()) / 3;
+
+            // Rays with a zero direction are left out of the query and reported as misses
+            std::vector<glm::vec3> rayOrigins, rayDirections;
+            std::vector<size_t> rayIndices;
+            rayOrigins.reserve(count);
+            rayDirections.reserve(count);
+            rayIndices.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const glm::vec3 direction(directions.get<float>(i * 3 + 1), directions.get<float>(i * 3 + 2), directions.get<float>(i * 3 + 3));
+                if (glm::dot(direction, direction) < 1e-12f)
+                    continue;
+
+                rayOrigins.emplace_back(origins.get<float>(i * 3 + 1), origins.get<float>(i * 3 + 2), origins.get<float>(i * 3 + 3));
+                rayDirections.push_back(glm::normalize(direction));
+                rayIndices.push_back(i);
+            }
+
+            const size_t rayCount = rayIndices.size();
+            std::vector<const btCollisionObject*> objects(rayCount, nullptr);
+            std::vector<float> distances(rayCount, 0.0f);
+            std::vector<glm::vec3> points(rayCount, glm::vec3(0.0f)), normals(rayCount, glm::vec3(0.0f));
+            std::vector<entt::entity> entities(rayCount, entt::null);
+
+            RayBatch rays;
+            rays.Origins = rayOrigins;
+            rays.Directions = rayDirections;
+            rays.MaxDistance = maxDistance;
+            PhysicsQueries::RaycastBatch(rays, {objects, distances, points, normals, entities});
+
+            sol::state_view lua(state);
+            sol::table results = lua.create_table(static_cast<int>(count), 0);
+            for (size_t i = 0; i < count; ++i)
+                results[i + 1] = lua.create_table_with("hit", false, "distance", 0.0f);
+
+            for (size_t ray = 0; ray < rayCount; ++ray)
+            {
+                results[rayIndices[ray] + 1] = lua.create_table_with(
+                    "hit", objects[ray] != nullptr, "distance", distances[ray],
+                    "x", points[ray].x, "y", points[ray].y, "z", points[ray].z,
+                    "nx", normals[ray].x, "ny", normals[ray].y, "nz", normals[ray].z,
+                    "entity", entityToLua(lua, entities[ray]));
+            }
+            return results;
+        });
+
+        luaState["physics"] = physicsTable;
+        # pragma endregion
+
         #pragma region Bind Entity Functions
 
         luaState.new_usertype<Entity>("Entity",
@@ -345,6 +440,8 @@ namespace Coffee {
                 self.AddComponent<TagComponent>();
             } else if (componentName == "TransformComponent") {
                 self.AddComponent<TransformComponent>();
+            } else if (componentName == "PhysicsLodAnchorComponent") {
+                self.AddComponent<PhysicsLodAnchorComponent>();
             } else {
                 throw std::runtime_error("Unknown component type");
             }
@@ -369,6 +466,8 @@ namespace Coffee {
                 return self.HasComponent<TagComponent>();
             } else if (componentName == "TransformComponent") {
                 return self.HasComponent<TransformComponent>();
+            } else if (componentName == "PhysicsLodAnchorComponent") {
+                return self.HasComponent<PhysicsLodAnchorComponent>();
             } else {
                 throw std::runtime_error("Unknown component type");
             }
@@ -379,12 +478,19 @@ namespace Coffee {
                 self.RemoveComponent<TagComponent>();
             } else if (componentName == "TransformComponent") {
                 self.RemoveComponent<TransformComponent>();
+            } else if (componentName == "PhysicsLodAnchorComponent") {
+                self.RemoveComponent<PhysicsLodAnchorComponent>();
             } else {
                 throw std::runtime_error("Unknown component type");
             }
         },
 
+        "GetPhysicsLodAnchor", [](Entity& self) -> PhysicsLodAnchorComponent& {
+            return self.GetComponent<PhysicsLodAnchorComponent>();
+        },
+
         "SetParent", &Entity::SetParent,
+        "GetID", [](Entity& self) { return static_cast<uint32_t>(self); },
         "IsValid", [](Entity& self) { return static_cast<bool>(self); }
     );
 
@@ -435,6 +541,12 @@ namespace Coffee {
             "angle", &LightComponent::Angle,
             "type", &LightComponent::type
         );
+
+        luaState.new_usertype<PhysicsLodAnchorComponent>("physics_lod_anchor_component",
+            sol::constructors<PhysicsLodAnchorComponent()>(),
+            "radius_scale", &PhysicsLodAnchorComponent::RadiusScale
+        );
+
        /* luaState.new_usertype<RigidbodyComponent>(
             "rigidbody_component",
             sol::constructors<RigidbodyComponent(),
@@ -0,0 +1,1695 @@
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/Physics/CharacterController.h"
+#include "CoffeeEngine/Physics/CharacterSystem.h"
+#include "CoffeeEngine/Physics/PhysicsArena.h"
+#include "CoffeeEngine/Physics/PhysicsEngine.h"
+#include "CoffeeEngine/Physics/PhysicsJoints.h"
+#include "CoffeeEngine/Physics/PhysicsQueries.h"
+#include "CoffeeEngine/Physics/ProjectileSystem.h"
+#include "CoffeeEngine/Physics/RigidBody.h"
+#include "CoffeeEngine/Physics/Vehicle.h"
+#include "CoffeeEngine/Physics/VehicleSystem.h"
+#include "CoffeeEngine/Scene/Terrain.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Coffee;
+
+namespace
+{
+    constexpr int kRayCount = 10000;
+    constexpr int kRayBatches = 100;
+    constexpr int kProjectileLayer = 1;
+    constexpr int kStreamWorldBodies = 20000; ///< Bodies already in the world when sections stream in.
+    constexpr int kStreamSectionBodies = 2000;
+    constexpr int kStreamCycles = 10;
+    constexpr int kSnapshotBodies = 1000;
+    constexpr int kSnapshotTicks = 100; ///< Ticks stepped after the snapshot and again after restoring it.
+    constexpr int kVehicleCount = 200;
+    constexpr int kVehicleCityBodies = 5000; ///< Bodies of the city the vehicles drive through.
+    constexpr int kCharacterCount = 500;
+    constexpr int kPooledProjectiles = 20000;
+    constexpr float kPooledProjectileLifetime = 2.0f;
+    constexpr int kCcdBodies = 5000;
+    constexpr int kCcdFastEvery = 10;      ///< One body in this many is fast enough to tunnel.
+    constexpr float kCcdFastSpeed = 120.0f;
+    constexpr float kCcdSlowSpeed = 2.0f;
+    constexpr int kTerrainSamples = 1025;       ///< Heightmap side, 1 m between samples.
+    constexpr float kTerrainHeightScale = 40.0f;
+    constexpr float kTerrainBoxCell = 4.0f;     ///< Side of the static boxes standing in for the terrain.
+    constexpr int kTerrainSpheres = 1024;
+    constexpr float kTerrainStreamRadius = 128.0f;
+    constexpr float kTerrainOrbitRadius = 60.0f; ///< The streaming point circles the spheres at this distance.
+
+    /**
+     * @enum CcdMode
+     * @brief How the CCD benchmark sweeps its bodies.
+     */
+    enum class CcdMode
+    {
+        Discrete, ///< DISCRETE world, nothing is swept.
+        Always,   ///< CONTINUOUS world with every moving body swept each tick.
+        Adaptive  ///< CONTINUOUS world with the thresholds derived from the shapes.
+    };
+
+    const char* GetCcdModeName(CcdMode mode)
+    {
+        switch (mode)
+        {
+        case CcdMode::Discrete:
+            return "discrete";
+        case CcdMode::Always:
+            return "always";
+        case CcdMode::Adaptive:
+            return "adaptive";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @enum SceneKind
+     * @brief Procedural scenes the benchmark can spawn.
+     */
+    enum class SceneKind
+    {
+        Boxes,   ///< Stacks of dynamic boxes.
+        Spheres, ///< A pile of dynamic spheres.
+        Chains,  ///< Capsule chains joined by point constraints, like ragdoll limbs.
+        City,    ///< A static grid of buildings with boxes raining on it.
+        Projectiles,       ///< Fast spheres crossing a walled arena, all on the projectile layer.
+        LayeredProjectiles ///< The projectile arena with projectile-projectile pairs filtered out.
+    };
+
+    const char* GetSceneName(SceneKind scene)
+    {
+        switch (scene)
+        {
+        case SceneKind::Boxes:
+            return "boxes";
+        case SceneKind::Spheres:
+            return "spheres";
+        case SceneKind::Chains:
+            return "chains";
+        case SceneKind::City:
+            return "city";
+        case SceneKind::Projectiles:
+            return "projectiles";
+        case SceneKind::LayeredProjectiles:
+            return "projectiles-layered";
+        }
+        return "unknown";
+    }
+
+    const char* GetWorldTypeName(PhysicsType type)
+    {
+        switch (type)
+        {
+        case PhysicsType::BASIC:
+            return "basic";
+        case PhysicsType::DISCRETE:
+            return "discrete";
+        case PhysicsType::PARALLEL:
+            return "parallel";
+        case PhysicsType::CONTINUOUS:
+            return "continuous";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @struct BenchmarkOptions
+     * @brief Command line options.
+     */
+    struct BenchmarkOptions
+    {
+        std::vector<SceneKind> Scenes = {SceneKind::Boxes,       SceneKind::Spheres,     SceneKind::Chains,
+                                         SceneKind::City,        SceneKind::Projectiles, SceneKind::LayeredProjectiles};
+        std::vector<int> BodyCounts = {1000, 5000, 20000};
+        std::vector<int> Threads;                   ///< Worker threads to run with, empty sweeps powers of two.
+        PhysicsType Type = PhysicsType::PARALLEL;   ///< World type to benchmark.
+        int TickRate = 60;                          ///< Ticks per simulated second.
+        int WarmupTicks = 60;                       ///< Ticks run before measuring.
+        int Ticks = 600;                            ///< Ticks measured.
+        bool Raycasts = true;                       ///< Whether to run the raycast benchmark.
+        bool Streaming = true;                      ///< Whether to run the section streaming benchmark.
+        bool Snapshot = true;                       ///< Whether to run the snapshot replay check.
+        bool Vehicles = true;                       ///< Whether to run the vehicle benchmark.
+        bool Characters = true;                     ///< Whether to run the character controller benchmark.
+        bool ProjectilePool = true;                 ///< Whether to run the pooled projectile benchmark.
+        bool Ccd = true;                            ///< Whether to run the continuous collision benchmark.
+        bool Terrain = true;                        ///< Whether to run the terrain benchmark.
+        std::string Output = "physics_benchmark.json"; ///< Path of the JSON report.
+    };
+
+    /**
+     * @struct SceneResult
+     * @brief Measurements of one scene run.
+     */
+    struct SceneResult
+    {
+        std::string Scene;
+        std::string WorldType;
+        int Bodies = 0;
+        int Threads = 0;
+        int Ticks = 0;
+
+        double MeanMs = 0.0;
+        double P50Ms = 0.0;
+        double P90Ms = 0.0;
+        double P99Ms = 0.0;
+        double MaxMs = 0.0;
+
+        double MeanPairs = 0.0;     ///< Broadphase overlapping pairs per tick.
+        uint64_t MaxPairs = 0;
+        double MeanManifolds = 0.0; ///< Narrowphase manifolds per tick.
+        uint64_t MaxManifolds = 0;
+
+        double MeanBroadphaseUs = 0.0;  ///< Broadphase wall time per tick.
+        double MeanNarrowphaseUs = 0.0; ///< Narrowphase wall time per tick.
+        double MeanSolverUs = 0.0;      ///< Constraint solver wall time per tick.
+
+        uint64_t BytesInUse = 0;    ///< Bullet memory in use at the end of the run.
+        uint64_t PeakBytes = 0;     ///< Peak Bullet memory during the run.
+        uint64_t ReservedBytes = 0; ///< Memory held by the physics arena.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Scene", Scene), cereal::make_nvp("WorldType", WorldType),
+                    cereal::make_nvp("Bodies", Bodies), cereal::make_nvp("Threads", Threads),
+                    cereal::make_nvp("Ticks", Ticks), cereal::make_nvp("MeanMs", MeanMs),
+                    cereal::make_nvp("P50Ms", P50Ms), cereal::make_nvp("P90Ms", P90Ms),
+                    cereal::make_nvp("P99Ms", P99Ms), cereal::make_nvp("MaxMs", MaxMs),
+                    cereal::make_nvp("MeanPairs", MeanPairs), cereal::make_nvp("MaxPairs", MaxPairs),
+                    cereal::make_nvp("MeanManifolds", MeanManifolds), cereal::make_nvp("MaxManifolds", MaxManifolds),
+                    cereal::make_nvp("MeanBroadphaseUs", MeanBroadphaseUs),
+                    cereal::make_nvp("MeanNarrowphaseUs", MeanNarrowphaseUs),
+                    cereal::make_nvp("MeanSolverUs", MeanSolverUs),
+                    cereal::make_nvp("BytesInUse", BytesInUse), cereal::make_nvp("PeakBytes", PeakBytes),
+                    cereal::make_nvp("ReservedBytes", ReservedBytes));
+        }
+    };
+
+    /**
+     * @struct RaycastResult
+     * @brief Measurements of one raycast run.
+     */
+    struct RaycastResult
+    {
+        int Rays = 0;
+        int Threads = 0;
+        double MsPerBatch = 0.0;
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Rays", Rays), cereal::make_nvp("Threads", Threads),
+                    cereal::make_nvp("MsPerBatch", MsPerBatch));
+        }
+    };
+
+    /**
+     * @struct StreamingResult
+     * @brief Measurements of one streaming run, averaged over the load and unload cycles.
+     */
+    struct StreamingResult
+    {
+        int Bodies = 0;
+        int Threads = 0;
+        bool Batched = false;
+        double LoadMs = 0.0;      ///< Time to add a section.
+        double FirstStepMs = 0.0; ///< Tick right after the section was added.
+        double UnloadMs = 0.0;    ///< Time to remove a section.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Bodies", Bodies), cereal::make_nvp("Threads", Threads),
+                    cereal::make_nvp("Batched", Batched), cereal::make_nvp("LoadMs", LoadMs),
+                    cereal::make_nvp("FirstStepMs", FirstStepMs), cereal::make_nvp("UnloadMs", UnloadMs));
+        }
+    };
+
+    /**
+     * @struct SnapshotResult
+     * @brief Timings of Snapshot and Restore and whether the restored world replayed exactly.
+     */
+    struct SnapshotResult
+    {
+        int Bodies = 0;
+        int Ticks = 0;
+        double SnapshotUs = 0.0;
+        double RestoreUs = 0.0;
+        uint64_t Bytes = 0;      ///< Size of the snapshot records.
+        bool Identical = false;  ///< Whether the replay ended bit for bit where the first run did.
+        int MismatchedBodies = 0;
+        int Events = 0;          ///< Contact events of the first run.
+        int MismatchedEvents = 0; ///< Events of the replay that differ from the first run, or are missing from either.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Bodies", Bodies), cereal::make_nvp("Ticks", Ticks),
+                    cereal::make_nvp("SnapshotUs", SnapshotUs), cereal::make_nvp("RestoreUs", RestoreUs),
+                    cereal::make_nvp("Bytes", Bytes), cereal::make_nvp("Identical", Identical),
+                    cereal::make_nvp("MismatchedBodies", MismatchedBodies), cereal::make_nvp("Events", Events),
+                    cereal::make_nvp("MismatchedEvents", MismatchedEvents));
+        }
+    };
+
+    /**
+     * @struct VehicleResult
+     * @brief Tick time of a city full of driving vehicles.
+     */
+    struct VehicleResult
+    {
+        int Vehicles = 0;
+        bool Batched = false;      ///< Whether the wheels were probed by the VehicleSystem.
+        double MeanMs = 0.0;
+        double MeanWheelsInContact = 0.0;
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Vehicles", Vehicles), cereal::make_nvp("Batched", Batched),
+                    cereal::make_nvp("MeanMs", MeanMs), cereal::make_nvp("MeanWheelsInContact", MeanWheelsInContact));
+        }
+    };
+
+    /**
+     * @struct CharacterResult
+     * @brief Tick time and query counts of characters walking through a city.
+     */
+    struct CharacterResult
+    {
+        int Characters = 0;
+        int Threads = 0;
+        double MeanMs = 0.0;
+        double CandidatesPerCharacter = 0.0;   ///< Objects near each character, per tick.
+        double SweepsPerCharacter = 0.0;       ///< Capsule sweeps per character and tick.
+        double ContactTestsPerCharacter = 0.0; ///< Penetration tests per character and tick.
+        double GroundedRatio = 0.0;            ///< Part of the characters standing on the ground after the run.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Characters", Characters), cereal::make_nvp("Threads", Threads),
+                    cereal::make_nvp("MeanMs", MeanMs), cereal::make_nvp("CandidatesPerCharacter", CandidatesPerCharacter),
+                    cereal::make_nvp("SweepsPerCharacter", SweepsPerCharacter),
+                    cereal::make_nvp("ContactTestsPerCharacter", ContactTestsPerCharacter),
+                    cereal::make_nvp("GroundedRatio", GroundedRatio));
+        }
+    };
+
+    /**
+     * @struct ProjectilePoolResult
+     * @brief Tick time of a full projectile pool fired into a city.
+     */
+    struct ProjectilePoolResult
+    {
+        int Capacity = 0;
+        int Threads = 0;
+        double MeanMs = 0.0;
+        double MeanLive = 0.0;        ///< Live projectiles per tick.
+        double HitsPerTick = 0.0;
+        bool BuffersGrew = false;     ///< Whether the hit or event buffers reallocated while firing.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Capacity", Capacity), cereal::make_nvp("Threads", Threads),
+                    cereal::make_nvp("MeanMs", MeanMs), cereal::make_nvp("MeanLive", MeanLive),
+                    cereal::make_nvp("HitsPerTick", HitsPerTick), cereal::make_nvp("BuffersGrew", BuffersGrew));
+        }
+    };
+
+    /**
+     * @struct CcdResult
+     * @brief Tick time and tunnelling of a few fast bodies among many slow ones.
+     */
+    struct CcdResult
+    {
+        std::string Mode;
+        int Bodies = 0;
+        int FastBodies = 0;
+        double MeanMs = 0.0;
+        int Escaped = 0; ///< Bodies that tunnelled out of the arena.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Mode", Mode), cereal::make_nvp("Bodies", Bodies),
+                    cereal::make_nvp("FastBodies", FastBodies), cereal::make_nvp("MeanMs", MeanMs),
+                    cereal::make_nvp("Escaped", Escaped));
+        }
+    };
+
+    /**
+     * @struct TerrainResult
+     * @brief Tick time and memory of spheres resting on a large terrain, as static boxes or streamed heightfields.
+     */
+    struct TerrainResult
+    {
+        std::string Mode;
+        int StaticProxies = 0;       ///< Static objects standing for the terrain in the broadphase, peak.
+        double MeanMs = 0.0;         ///< Step and streaming time per tick.
+        double MeanChunks = 0.0;     ///< Heightfield chunks loaded per tick.
+        uint64_t PeakChunkBytes = 0; ///< Heights held by the loaded chunks, peak.
+        int FellThrough = 0;         ///< Spheres that ended below the ground.
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Mode", Mode), cereal::make_nvp("StaticProxies", StaticProxies),
+                    cereal::make_nvp("MeanMs", MeanMs), cereal::make_nvp("MeanChunks", MeanChunks),
+                    cereal::make_nvp("PeakChunkBytes", PeakChunkBytes), cereal::make_nvp("FellThrough", FellThrough));
+        }
+    };
+
+    /**
+     * @struct BenchmarkReport
+     * @brief Everything written to the JSON report.
+     */
+    struct BenchmarkReport
+    {
+        std::vector<SceneResult> Scenes;
+        std::vector<RaycastResult> Raycasts;
+        std::vector<StreamingResult> Streaming;
+        std::vector<SnapshotResult> Snapshots;
+        std::vector<VehicleResult> Vehicles;
+        std::vector<CharacterResult> Characters;
+        std::vector<ProjectilePoolResult> ProjectilePool;
+        std::vector<CcdResult> Ccd;
+        std::vector<TerrainResult> Terrain;
+
+        template <class Archive> void serialize(Archive& archive)
+        {
+            archive(cereal::make_nvp("Scenes", Scenes), cereal::make_nvp("Raycasts", Raycasts),
+                    cereal::make_nvp("Streaming", Streaming), cereal::make_nvp("Snapshots", Snapshots),
+                    cereal::make_nvp("Vehicles", Vehicles), cereal::make_nvp("Characters", Characters),
+                    cereal::make_nvp("ProjectilePool", ProjectilePool), cereal::make_nvp("Ccd", Ccd),
+                    cereal::make_nvp("Terrain", Terrain));
+        }
+    };
+
+    /**
+     * @struct SpawnedScene
+     * @brief Bodies and joints owned by a scene, destroyed after the run.
+     */
+    struct SpawnedScene
+    {
+        std::vector<btRigidBody*> Bodies;
+        bool HasJoints = false;
+    };
+
+    btRigidBody* SpawnBody(SpawnedScene& scene, const RigidBodyConfig& config, const btVector3& position)
+    {
+        btTransform transform = btTransform::getIdentity();
+        transform.setOrigin(position);
+        btRigidBody* body = PhysicsEngine::CreateRigidBody(nullptr, config, transform);
+        scene.Bodies.push_back(body);
+        return body;
+    }
+
+    void SpawnGround(SpawnedScene& scene)
+    {
+        RigidBodyConfig groundConfig;
+        groundConfig.type = RigidBodyType::Static;
+        groundConfig.shapeConfig.type = CollisionShapeType::BOX;
+        groundConfig.shapeConfig.size = glm::vec3(2000.0f, 1.0f, 2000.0f);
+        SpawnBody(scene, groundConfig, btVector3(0.0f, -0.5f, 0.0f));
+    }
+
+    int GetGridSide(int count) { return std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))))); }
+
+    void SpawnBoxStacks(SpawnedScene& scene, int bodyCount)
+    {
+        RigidBodyConfig boxConfig;
+        boxConfig.shapeConfig.type = CollisionShapeType::BOX;
+        boxConfig.shapeConfig.size = glm::vec3(1.0f);
+
+        constexpr int stackHeight = 10;
+        const int side = GetGridSide((bodyCount + stackHeight - 1) / stackHeight);
+
+        for (int i = 0; i < bodyCount; ++i)
+        {
+            const int stack = i / stackHeight;
+            const int level = i % stackHeight;
+            SpawnBody(scene, boxConfig,
+                      btVector3((stack % side) * 2.0f, 0.5f + level * 1.01f, (stack / side) * 2.0f));
+        }
+    }
+
+    void SpawnSpherePile(SpawnedScene& scene, int bodyCount)
+    {
+        RigidBodyConfig sphereConfig;
+        sphereConfig.shapeConfig.type = CollisionShapeType::SPHERE;
+        sphereConfig.shapeConfig.radius = 0.5f;
+
+        // Square layers, odd layers shifted so spheres settle into the gaps below
+        const int side = GetGridSide(bodyCount / 20 + 1);
+        const int perLayer = side * side;
+
+        for (int i = 0; i < bodyCount; ++i)
+        {
+            const int layer = i / perLayer;
+            const int slot = i % perLayer;
+            const float offset = (layer % 2) * 0.5f;
+            SpawnBody(scene, sphereConfig,
+                      btVector3((slot % side) * 1.05f + offset, 0.5f + layer * 1.05f, (slot / side) * 1.05f + offset));
+        }
+    }
+
+    void SpawnJointChains(SpawnedScene& scene, int bodyCount)
+    {
+        RigidBodyConfig linkConfig;
+        linkConfig.shapeConfig.type = CollisionShapeType::CAPSULE;
+        linkConfig.shapeConfig.radius = 0.2f;
+        linkConfig.shapeConfig.height = 0.6f;
+
+        constexpr int chainLength = 10;
+        constexpr float linkLength = 1.0f;
+        const int side = GetGridSide((bodyCount + chainLength - 1) / chainLength);
+
+        btRigidBody* previous = nullptr;
+        for (int i = 0; i < bodyCount; ++i)
+        {
+            const int chain = i / chainLength;
+            const int link = i % chainLength;
+
+            // Chains start horizontal and fold onto the ground
+            btRigidBody* body = SpawnBody(
+                scene, linkConfig,
+                btVector3((chain % side) * 3.0f + link * linkLength, 5.0f, (chain / side) * 3.0f));
+
+            if (link > 0)
+            {
+                JointConfig joint;
+                joint.type = JointType::POINT2POINT;
+                joint.bodyA = previous;
+                joint.bodyB = body;
+                joint.pivotInA = btVector3(linkLength * 0.5f, 0.0f, 0.0f);
+                joint.pivotInB = btVector3(-linkLength * 0.5f, 0.0f, 0.0f);
+                PhysicsJoints::createJoint("chain_" + std::to_string(i), joint);
+                scene.HasJoints = true;
+            }
+            previous = body;
+        }
+
+        if (scene.HasJoints)
+            PhysicsJoints::addToWorld(PhysicsEngine::GetWorld());
+    }
+
+    void SpawnCityGrid(SpawnedScene& scene, int bodyCount, const btVector3& origin = btVector3(0.0f, 0.0f, 0.0f))
+    {
+        // Nine static buildings for every dynamic box dropped on the roofs
+        const int buildingCount = bodyCount - bodyCount / 10;
+        const int side = GetGridSide(buildingCount);
+
+        RigidBodyConfig buildingConfig;
+        buildingConfig.type = RigidBodyType::Static;
+        buildingConfig.shapeConfig.type = CollisionShapeType::BOX;
+
+        for (int i = 0; i < buildingCount; ++i)
+        {
+            const int x = i % side;
+            const int z = i / side;
+            const float height = 5.0f + static_cast<float>((x * 7 + z * 13) % 20);
+            buildingConfig.shapeConfig.size = glm::vec3(8.0f, height, 8.0f);
+            SpawnBody(scene, buildingConfig, origin + btVector3(x * 12.0f, height * 0.5f, z * 12.0f));
+        }
+
+        RigidBodyConfig boxConfig;
+        boxConfig.shapeConfig.type = CollisionShapeType::BOX;
+        boxConfig.shapeConfig.size = glm::vec3(1.0f);
+
+        for (int i = 0; i < bodyCount / 10; ++i)
+        {
+            const int building = (i * 7919) % std::max(1, buildingCount);
+            SpawnBody(scene, boxConfig,
+                      origin + btVector3((building % side) * 12.0f, 30.0f + (i % 5) * 2.0f, (building / side) * 12.0f));
+        }
+    }
+
+    void SpawnProjectileArena(SpawnedScene& scene, int bodyCount)
+    {
+        // Density stays constant as the count grows so pair counts scale with the bodies
+        const float extent = std::max(20.0f, std::cbrt(static_cast<float>(bodyCount)) * 4.0f);
+
+        RigidBodyConfig wallConfig;
+        wallConfig.type = RigidBodyType::Static;
+        wallConfig.shapeConfig.type = CollisionShapeType::BOX;
+        wallConfig.restitution = 1.0f;
+
+        wallConfig.shapeConfig.size = glm::vec3(1.0f, extent, extent);
+        SpawnBody(scene, wallConfig, btVector3(-0.5f, extent * 0.5f, extent * 0.5f));
+        SpawnBody(scene, wallConfig, btVector3(extent + 0.5f, extent * 0.5f, extent * 0.5f));
+        wallConfig.shapeConfig.size = glm::vec3(extent, extent, 1.0f);
+        SpawnBody(scene, wallConfig, btVector3(extent * 0.5f, extent * 0.5f, -0.5f));
+        SpawnBody(scene, wallConfig, btVector3(extent * 0.5f, extent * 0.5f, extent + 0.5f));
+        wallConfig.shapeConfig.size = glm::vec3(extent, 1.0f, extent);
+        SpawnBody(scene, wallConfig, btVector3(extent * 0.5f, extent + 0.5f, extent * 0.5f));
+
+        RigidBodyConfig projectileConfig;
+        projectileConfig.shapeConfig.type = CollisionShapeType::SPHERE;
+        projectileConfig.shapeConfig.radius = 0.1f;
+        projectileConfig.shapeConfig.mass = 0.05f;
+        projectileConfig.shapeConfig.layer = kProjectileLayer;
+        projectileConfig.restitution = 1.0f;
+        projectileConfig.LinearDrag = 0.0f;
+
+        // Fixed seed so every run fires the same volley
+        uint32_t seed = 0x9E3779B9u;
+        auto random = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+        };
+
+        for (int i = 0; i < bodyCount; ++i)
+        {
+            const btVector3 position(0.5f + random() * (extent - 1.0f), 0.5f + random() * (extent - 1.0f),
+                                     0.5f + random() * (extent - 1.0f));
+            btRigidBody* body = SpawnBody(scene, projectileConfig, position);
+            body->setGravity(btVector3(0.0f, 0.0f, 0.0f));
+            body->setLinearVelocity(btVector3(random() - 0.5f, random() - 0.5f, random() - 0.5f).normalized() * 30.0f);
+            body->setActivationState(DISABLE_DEACTIVATION);
+        }
+    }
+
+    SpawnedScene SpawnScene(SceneKind kind, int bodyCount)
+    {
+        SpawnedScene scene;
+        scene.Bodies.reserve(bodyCount + 1);
+        SpawnGround(scene);
+
+        switch (kind)
+        {
+        case SceneKind::Boxes:
+            SpawnBoxStacks(scene, bodyCount);
+            break;
+        case SceneKind::Spheres:
+            SpawnSpherePile(scene, bodyCount);
+            break;
+        case SceneKind::Chains:
+            SpawnJointChains(scene, bodyCount);
+            break;
+        case SceneKind::City:
+            SpawnCityGrid(scene, bodyCount);
+            break;
+        case SceneKind::Projectiles:
+        case SceneKind::LayeredProjectiles:
+            SpawnProjectileArena(scene, bodyCount);
+            break;
+        }
+
+        return scene;
+    }
+
+    void DestroyScene(SpawnedScene& scene)
+    {
+        if (scene.HasJoints)
+        {
+            PhysicsJoints::removeFromWorld(PhysicsEngine::GetWorld());
+            PhysicsJoints::Destroy();
+        }
+
+        for (btRigidBody* body : scene.Bodies)
+            PhysicsEngine::DestroyCollisionObject(body);
+        scene.Bodies.clear();
+    }
+
+    /**
+     * @brief Starts the engine with a world of the given type and thread count.
+     * @param layered Whether projectiles skip each other through the collision matrix.
+     */
+    void StartEngine(const BenchmarkOptions& options, int threads, bool layered = false)
+    {
+        PhysicsSettings settings;
+        settings.Type = options.Type;
+        settings.WorkerThreads = threads;
+        settings.TickRate = options.TickRate;
+        settings.CollisionLayerNames[kProjectileLayer] = "Projectile";
+        if (layered)
+            settings.SetLayersCollide(kProjectileLayer, kProjectileLayer, false);
+        PhysicsEngine::ApplySettings(settings);
+
+        PhysicsEngine::Init();
+    }
+
+    double GetPercentile(const std::vector<double>& sorted, double percentile)
+    {
+        const size_t index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    /** @brief Runs one scene for the configured number of ticks and collects its measurements. */
+    SceneResult RunScene(const BenchmarkOptions& options, SceneKind kind, int bodyCount, int threads)
+    {
+        StartEngine(options, threads, kind == SceneKind::LayeredProjectiles);
+
+        SpawnedScene scene = SpawnScene(kind, bodyCount);
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+
+        // BeginStep runs inline without AsyncStep and swaps the stats into the front buffer
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            PhysicsEngine::BeginStep(timeStep);
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+        btOverlappingPairCache* pairCache = world->getBroadphase()->getOverlappingPairCache();
+
+        SceneResult result;
+        result.Scene = GetSceneName(kind);
+        result.WorldType = GetWorldTypeName(options.Type);
+        result.Bodies = bodyCount;
+        result.Threads = threads;
+        result.Ticks = options.Ticks;
+
+        std::vector<double> tickTimes;
+        tickTimes.reserve(options.Ticks);
+        uint64_t totalPairs = 0;
+        uint64_t totalManifolds = 0;
+        double totalBroadphaseUs = 0.0;
+        double totalNarrowphaseUs = 0.0;
+        double totalSolverUs = 0.0;
+
+        for (int i = 0; i < options.Ticks; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            auto end = std::chrono::steady_clock::now();
+            tickTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+            const PhysicsStats& stats = PhysicsEngine::GetStats();
+            totalBroadphaseUs += stats.GetPhaseMicroseconds(PhysicsPhase::Broadphase);
+            totalNarrowphaseUs += stats.GetPhaseMicroseconds(PhysicsPhase::Narrowphase);
+            totalSolverUs += stats.GetPhaseMicroseconds(PhysicsPhase::Solver);
+
+            const uint64_t pairs = pairCache->getNumOverlappingPairs();
+            const uint64_t manifolds = world->getDispatcher()->getNumManifolds();
+            totalPairs += pairs;
+            totalManifolds += manifolds;
+            result.MaxPairs = std::max(result.MaxPairs, pairs);
+            result.MaxManifolds = std::max(result.MaxManifolds, manifolds);
+        }
+
+        const PhysicsArenaStats stats = PhysicsArena::GetStats();
+        result.BytesInUse = stats.BytesInUse;
+        result.PeakBytes = stats.PeakBytes;
+        result.ReservedBytes = stats.ReservedBytes;
+
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        if (!tickTimes.empty())
+        {
+            double total = 0.0;
+            for (double time : tickTimes)
+                total += time;
+
+            std::sort(tickTimes.begin(), tickTimes.end());
+            result.MeanMs = total / static_cast<double>(tickTimes.size());
+            result.P50Ms = GetPercentile(tickTimes, 0.50);
+            result.P90Ms = GetPercentile(tickTimes, 0.90);
+            result.P99Ms = GetPercentile(tickTimes, 0.99);
+            result.MaxMs = tickTimes.back();
+            result.MeanPairs = static_cast<double>(totalPairs) / static_cast<double>(tickTimes.size());
+            result.MeanManifolds = static_cast<double>(totalManifolds) / static_cast<double>(tickTimes.size());
+            result.MeanBroadphaseUs = totalBroadphaseUs / static_cast<double>(tickTimes.size());
+            result.MeanNarrowphaseUs = totalNarrowphaseUs / static_cast<double>(tickTimes.size());
+            result.MeanSolverUs = totalSolverUs / static_cast<double>(tickTimes.size());
+        }
+
+        return result;
+    }
+
+    /** @brief Casts batches of rays through a grid of static buildings and returns the average batch time. */
+    RaycastResult RunRaycasts(const BenchmarkOptions& options, int threads)
+    {
+        StartEngine(options, threads);
+
+        SpawnedScene scene;
+        SpawnGround(scene);
+
+        RigidBodyConfig buildingConfig;
+        buildingConfig.type = RigidBodyType::Static;
+        buildingConfig.shapeConfig.type = CollisionShapeType::BOX;
+
+        constexpr int blockSide = 32;
+        for (int x = 0; x < blockSide; ++x)
+        {
+            for (int z = 0; z < blockSide; ++z)
+            {
+                const float height = 5.0f + static_cast<float>((x * 7 + z * 13) % 20);
+                buildingConfig.shapeConfig.size = glm::vec3(8.0f, height, 8.0f);
+                SpawnBody(scene, buildingConfig, btVector3(x * 12.0f, height * 0.5f, z * 12.0f));
+            }
+        }
+
+        std::vector<glm::vec3> origins(kRayCount), directions(kRayCount);
+        for (int i = 0; i < kRayCount; ++i)
+        {
+            const float angle = static_cast<float>(i) * 0.61803398875f * 6.2831853f;
+            origins[i] = glm::vec3((i % 100) * 3.84f, 1.5f, (i / 100) * 3.84f);
+            directions[i] = glm::normalize(glm::vec3(std::cos(angle), -0.05f, std::sin(angle)));
+        }
+
+        std::vector<const btCollisionObject*> objects(kRayCount);
+        std::vector<float> distances(kRayCount);
+
+        RayBatch rays;
+        rays.Origins = origins;
+        rays.Directions = directions;
+        rays.MaxDistance = 200.0f;
+
+        QueryHits hits;
+        hits.Objects = objects;
+        hits.Distances = distances;
+
+        PhysicsQueries::RaycastBatch(rays, hits);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRayBatches; ++i)
+            PhysicsQueries::RaycastBatch(rays, hits);
+        auto end = std::chrono::steady_clock::now();
+
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        RaycastResult result;
+        result.Rays = kRayCount;
+        result.Threads = threads;
+        result.MsPerBatch = std::chrono::duration<double, std::milli>(end - start).count() / kRayBatches;
+        return result;
+    }
+
+    /**
+     * @brief Streams a city section in and out of a populated world and times the hitches.
+     * @param batched Whether the section is added and removed inside a PhysicsEngine batch.
+     */
+    StreamingResult RunStreaming(const BenchmarkOptions& options, int threads, bool batched)
+    {
+        StartEngine(options, threads);
+
+        SpawnedScene world;
+        SpawnGround(world);
+        SpawnCityGrid(world, kStreamWorldBodies);
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            PhysicsEngine::BeginStep(timeStep);
+
+        // Next to the existing blocks so the section shares the broadphase trees with them
+        const btVector3 sectionOrigin(GetGridSide(kStreamWorldBodies) * 12.0f, 0.0f, 0.0f);
+
+        double loadMs = 0.0;
+        double firstStepMs = 0.0;
+        double unloadMs = 0.0;
+
+        for (int cycle = 0; cycle < kStreamCycles; ++cycle)
+        {
+            SpawnedScene section;
+
+            auto start = std::chrono::steady_clock::now();
+            if (batched)
+                PhysicsEngine::BeginBatch();
+            SpawnCityGrid(section, kStreamSectionBodies, sectionOrigin);
+            if (batched)
+                PhysicsEngine::EndBatch();
+            auto end = std::chrono::steady_clock::now();
+            loadMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            end = std::chrono::steady_clock::now();
+            firstStepMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            for (int i = 0; i < 10; ++i)
+                PhysicsEngine::BeginStep(timeStep);
+
+            start = std::chrono::steady_clock::now();
+            if (batched)
+                PhysicsEngine::BeginBatch();
+            DestroyScene(section);
+            if (batched)
+                PhysicsEngine::EndBatch();
+            end = std::chrono::steady_clock::now();
+            unloadMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            PhysicsEngine::BeginStep(timeStep);
+        }
+
+        DestroyScene(world);
+        PhysicsEngine::Destroy();
+
+        StreamingResult result;
+        result.Bodies = kStreamSectionBodies;
+        result.Threads = threads;
+        result.Batched = batched;
+        result.LoadMs = loadMs / kStreamCycles;
+        result.FirstStepMs = firstStepMs / kStreamCycles;
+        result.UnloadMs = unloadMs / kStreamCycles;
+        return result;
+    }
+
+    /**
+     * @brief Steps a box scene, snapshots it, then restores and steps it twice and compares the two runs.
+     *
+     * The runs are compared on the final state of every body and on the contact events of every
+     * tick, which only match if the restore also reset the contact tracker.
+     *
+     * Both runs start from a restore, the live world before the first restore built its caches
+     * in another order and is not expected to match bit for bit.
+     *
+     * The parallel world is swapped for the discrete one, its narrowphase creates manifolds in
+     * whatever order the worker threads finish and so doesn't replay exactly.
+     */
+    SnapshotResult RunSnapshotCheck(const BenchmarkOptions& options)
+    {
+        BenchmarkOptions worldOptions = options;
+        if (worldOptions.Type == PhysicsType::PARALLEL)
+            worldOptions.Type = PhysicsType::DISCRETE;
+        StartEngine(worldOptions, 1);
+
+        SpawnedScene scene = SpawnScene(SceneKind::Boxes, kSnapshotBodies);
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+
+        // Let the stacks build contacts so the snapshot has warm-starting impulses to carry
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            PhysicsEngine::BeginStep(timeStep);
+
+        PhysicsSnapshot start;
+        PhysicsSnapshot firstRun;
+        PhysicsSnapshot replay;
+
+        auto snapshotStart = std::chrono::steady_clock::now();
+        PhysicsEngine::Snapshot(start);
+        auto snapshotEnd = std::chrono::steady_clock::now();
+
+        std::vector<ContactEvent> firstRunEvents;
+        std::vector<ContactEvent> replayEvents;
+
+        auto stepAndRecord = [timeStep](std::vector<ContactEvent>& events) {
+            for (int i = 0; i < kSnapshotTicks; ++i)
+            {
+                PhysicsEngine::BeginStep(timeStep);
+                PhysicsEngine::WaitForStep();
+                const std::vector<ContactEvent>& tickEvents = PhysicsEngine::GetContactEvents();
+                events.insert(events.end(), tickEvents.begin(), tickEvents.end());
+            }
+        };
+
+        bool restored = PhysicsEngine::Restore(start);
+        stepAndRecord(firstRunEvents);
+        PhysicsEngine::Snapshot(firstRun);
+
+        auto restoreStart = std::chrono::steady_clock::now();
+        restored = PhysicsEngine::Restore(start) && restored;
+        auto restoreEnd = std::chrono::steady_clock::now();
+
+        stepAndRecord(replayEvents);
+        PhysicsEngine::Snapshot(replay);
+
+        SnapshotResult result;
+        result.Bodies = kSnapshotBodies;
+        result.Ticks = kSnapshotTicks;
+        result.SnapshotUs = std::chrono::duration<double, std::micro>(snapshotEnd - snapshotStart).count();
+        result.RestoreUs = std::chrono::duration<double, std::micro>(restoreEnd - restoreStart).count();
+        result.Bytes = start.GetSizeInBytes();
+        result.Events = static_cast<int>(firstRunEvents.size());
+
+        // The objects are the same in both runs, so the events compare by pointer
+        const size_t commonEvents = std::min(firstRunEvents.size(), replayEvents.size());
+        for (size_t i = 0; i < commonEvents; ++i)
+        {
+            const ContactEvent& a = firstRunEvents[i];
+            const ContactEvent& b = replayEvents[i];
+            if (a.ObjectA != b.ObjectA || a.ObjectB != b.ObjectB || a.type != b.type || a.Hit != b.Hit)
+                ++result.MismatchedEvents;
+        }
+        result.MismatchedEvents +=
+            static_cast<int>(std::max(firstRunEvents.size(), replayEvents.size()) - commonEvents);
+
+        if (restored && firstRun.Bodies.size() == replay.Bodies.size())
+        {
+            for (size_t i = 0; i < replay.Bodies.size(); ++i)
+            {
+                if (std::memcmp(&firstRun.Bodies[i], &replay.Bodies[i], sizeof(BodySnapshot)) != 0)
+                    ++result.MismatchedBodies;
+            }
+            result.Identical = result.MismatchedBodies == 0 && result.MismatchedEvents == 0 &&
+                               firstRun.TickCount == replay.TickCount;
+        }
+
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+        return result;
+    }
+
+    /**
+     * @brief Drives vehicles down the streets of a city on one thread and times the ticks.
+     * @param batched Whether the VehicleSystem updates them, otherwise every vehicle casts its own world rays.
+     */
+    VehicleResult RunVehicles(const BenchmarkOptions& options, bool batched)
+    {
+        StartEngine(options, 1);
+
+        SpawnedScene scene;
+        SpawnGround(scene);
+        SpawnCityGrid(scene, kVehicleCityBodies);
+
+        btDynamicsWorld* world = PhysicsEngine::GetWorld();
+        btDefaultVehicleRaycaster raycaster(world);
+        const VehicleConfig config;
+
+        RigidBodyConfig chassisConfig;
+        chassisConfig.shapeConfig.type = CollisionShapeType::BOX;
+        chassisConfig.shapeConfig.size = glm::vec3(2.0f, 1.0f, 4.0f);
+        chassisConfig.shapeConfig.mass = 800.0f;
+
+        // Ten vehicles down each of the first streets along Z, between the building rows
+        std::vector<btRaycastVehicle*> vehicles;
+        for (int i = 0; i < kVehicleCount; ++i)
+        {
+            const btVector3 position((i / 10) * 12.0f + 6.0f, 1.5f, (i % 10) * 24.0f + 6.0f);
+            btRigidBody* chassis = SpawnBody(scene, chassisConfig, position);
+            chassis->setActivationState(DISABLE_DEACTIVATION);
+
+            btRaycastVehicle* vehicle = nullptr;
+            if (batched)
+                vehicle = VehicleSystem::CreateVehicle(chassis, config);
+            else
+            {
+                btRaycastVehicle::btVehicleTuning tuning;
+                tuning.m_suspensionStiffness = config.SuspensionStiffness;
+                tuning.m_suspensionCompression = config.SuspensionCompression;
+                tuning.m_suspensionDamping = config.SuspensionRelaxation;
+                tuning.m_maxSuspensionTravelCm = config.MaxSuspensionTravel * 100.0f;
+                tuning.m_frictionSlip = config.FrictionSlip;
+                tuning.m_maxSuspensionForce = config.MaxSuspensionForce;
+
+                vehicle = new btRaycastVehicle(tuning, chassis, &raycaster);
+                vehicle->setCoordinateSystem(0, 1, 2);
+                for (const WheelConfig& wheel : config.Wheels)
+                {
+                    btWheelInfo& info = vehicle->addWheel(
+                        btVector3(wheel.ConnectionPoint.x, wheel.ConnectionPoint.y, wheel.ConnectionPoint.z),
+                        btVector3(0.0f, -1.0f, 0.0f), btVector3(-1.0f, 0.0f, 0.0f), config.SuspensionRestLength,
+                        wheel.Radius, tuning, wheel.Steered);
+                    info.m_rollInfluence = config.RollInfluence;
+                }
+                world->addVehicle(vehicle);
+            }
+
+            for (int wheel = 0; wheel < vehicle->getNumWheels(); ++wheel)
+            {
+                if (config.Wheels[wheel].Driven)
+                    vehicle->applyEngineForce(config.MaxEngineForce * 0.5f, wheel);
+            }
+            vehicles.push_back(vehicle);
+        }
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            PhysicsEngine::BeginStep(timeStep);
+
+        double totalMs = 0.0;
+        uint64_t wheelsInContact = 0;
+        for (int i = 0; i < options.Ticks; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            auto end = std::chrono::steady_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            for (btRaycastVehicle* vehicle : vehicles)
+            {
+                for (int wheel = 0; wheel < vehicle->getNumWheels(); ++wheel)
+                    wheelsInContact += vehicle->getWheelInfo(wheel).m_raycastInfo.m_isInContact ? 1 : 0;
+            }
+        }
+
+        for (btRaycastVehicle* vehicle : vehicles)
+        {
+            if (batched)
+                VehicleSystem::DestroyVehicle(vehicle);
+            else
+            {
+                world->removeVehicle(vehicle);
+                delete vehicle;
+            }
+        }
+
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        VehicleResult result;
+        result.Vehicles = kVehicleCount;
+        result.Batched = batched;
+        result.MeanMs = totalMs / options.Ticks;
+        result.MeanWheelsInContact = static_cast<double>(wheelsInContact) / options.Ticks;
+        return result;
+    }
+
+    /** @brief Walks characters down the streets of a city, turning at every block, and times the ticks. */
+    CharacterResult RunCharacters(const BenchmarkOptions& options, int threads)
+    {
+        StartEngine(options, threads);
+
+        SpawnedScene scene;
+        SpawnGround(scene);
+        SpawnCityGrid(scene, kVehicleCityBodies);
+
+        std::vector<std::unique_ptr<CharacterController>> characters;
+        std::vector<glm::vec3> velocities;
+        const CharacterControllerConfig config;
+        for (int i = 0; i < kCharacterCount; ++i)
+        {
+            const glm::vec3 position((i % 25) * 12.0f + 6.0f, 1.0f, (i / 25) * 12.0f + 6.0f);
+            characters.push_back(std::make_unique<CharacterController>(config, position));
+            velocities.push_back(i % 2 == 0 ? glm::vec3(4.0f, 0.0f, 1.0f) : glm::vec3(-1.0f, 0.0f, 4.0f));
+        }
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        const int turnTicks = options.TickRate * 3;
+
+        CharacterResult result;
+        result.Characters = kCharacterCount;
+        result.Threads = threads;
+
+        double totalMs = 0.0;
+        uint64_t candidates = 0;
+        uint64_t sweeps = 0;
+        uint64_t contactTests = 0;
+        for (int i = 0; i < options.WarmupTicks + options.Ticks; ++i)
+        {
+            // Swap directions every few seconds so characters keep pressing into walls and corners
+            if (i % turnTicks == 0)
+            {
+                for (size_t c = 0; c < characters.size(); ++c)
+                {
+                    velocities[c] = glm::vec3(-velocities[c].z, 0.0f, velocities[c].x);
+                    characters[c]->SetWalkVelocity(velocities[c]);
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            auto end = std::chrono::steady_clock::now();
+
+            if (i < options.WarmupTicks)
+                continue;
+
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+            const CharacterQueryStats& stats = CharacterSystem::GetTotalStats();
+            candidates += stats.Candidates;
+            sweeps += stats.Sweeps;
+            contactTests += stats.ContactTests;
+        }
+
+        int grounded = 0;
+        for (const auto& character : characters)
+            grounded += character->IsGrounded() ? 1 : 0;
+
+        characters.clear();
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        const double samples = static_cast<double>(options.Ticks) * kCharacterCount;
+        result.MeanMs = totalMs / options.Ticks;
+        result.CandidatesPerCharacter = static_cast<double>(candidates) / samples;
+        result.SweepsPerCharacter = static_cast<double>(sweeps) / samples;
+        result.ContactTestsPerCharacter = static_cast<double>(contactTests) / samples;
+        result.GroundedRatio = static_cast<double>(grounded) / kCharacterCount;
+        return result;
+    }
+
+    /** @brief Keeps the projectile pool full of shots fired into a city and times the ticks. */
+    ProjectilePoolResult RunProjectilePool(const BenchmarkOptions& options, int threads)
+    {
+        StartEngine(options, threads);
+
+        SpawnedScene scene;
+        SpawnGround(scene);
+        SpawnCityGrid(scene, kVehicleCityBodies);
+
+        ProjectileSystem::SetCollisionLayer(kProjectileLayer);
+
+        // Fixed seed so every run fires the same shots
+        uint32_t seed = 0x2545F491u;
+        auto random = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+        };
+
+        // Shots leave from above the city in every direction, some fly over it and expire
+        auto refill = [&]() {
+            for (;;)
+            {
+                const glm::vec3 position(random() * 300.0f, 2.0f + random() * 30.0f, random() * 300.0f);
+                const glm::vec3 velocity((random() - 0.5f) * 400.0f, (random() - 0.7f) * 100.0f,
+                                         (random() - 0.5f) * 400.0f);
+                if (ProjectileSystem::Spawn(position, velocity, kPooledProjectileLifetime) == 0)
+                    break;
+            }
+        };
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        for (int i = 0; i < options.WarmupTicks; ++i)
+        {
+            refill();
+            PhysicsEngine::BeginStep(timeStep);
+        }
+
+        const size_t hitCapacity = PhysicsEngine::GetProjectileHits().capacity();
+
+        double totalMs = 0.0;
+        uint64_t live = 0;
+        uint64_t hits = 0;
+        for (int i = 0; i < options.Ticks; ++i)
+        {
+            refill();
+
+            auto start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            auto end = std::chrono::steady_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            live += ProjectileSystem::GetCount();
+            hits += PhysicsEngine::GetProjectileHits().size();
+        }
+
+        ProjectilePoolResult result;
+        result.Capacity = static_cast<int>(ProjectileSystem::GetCapacity());
+        result.Threads = threads;
+        result.MeanMs = totalMs / options.Ticks;
+        result.MeanLive = static_cast<double>(live) / options.Ticks;
+        result.HitsPerTick = static_cast<double>(hits) / options.Ticks;
+        result.BuffersGrew = PhysicsEngine::GetProjectileHits().capacity() != hitCapacity;
+
+        ProjectileSystem::SetCollisionLayer(0);
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+        return result;
+    }
+
+    /** @brief Fires a few fast spheres among many slow ones in the walled arena and counts the ones that escape. */
+    CcdResult RunCcd(const BenchmarkOptions& options, CcdMode mode)
+    {
+        BenchmarkOptions worldOptions = options;
+        worldOptions.Type = mode == CcdMode::Discrete ? PhysicsType::DISCRETE : PhysicsType::CONTINUOUS;
+        StartEngine(worldOptions, 1);
+
+        SpawnedScene scene;
+        SpawnGround(scene);
+        const size_t firstSphere = scene.Bodies.size() + 5; // The arena walls come first
+        SpawnProjectileArena(scene, kCcdBodies);
+
+        CcdResult result;
+        result.Mode = GetCcdModeName(mode);
+        result.Bodies = kCcdBodies;
+
+        for (size_t i = firstSphere; i < scene.Bodies.size(); ++i)
+        {
+            btRigidBody* body = scene.Bodies[i];
+            const bool fast = (i - firstSphere) % kCcdFastEvery == 0;
+            result.FastBodies += fast ? 1 : 0;
+            body->setLinearVelocity(body->getLinearVelocity().normalized() * (fast ? kCcdFastSpeed : kCcdSlowSpeed));
+
+            // Any motion at all triggers the sweep
+            if (mode == CcdMode::Always)
+                body->setCcdMotionThreshold(1e-4f);
+        }
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            PhysicsEngine::BeginStep(timeStep);
+
+        double totalMs = 0.0;
+        for (int i = 0; i < options.Ticks; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            PhysicsEngine::BeginStep(timeStep);
+            auto end = std::chrono::steady_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        // Same extent as SpawnProjectileArena
+        const float extent = std::max(20.0f, std::cbrt(static_cast<float>(kCcdBodies)) * 4.0f);
+        for (size_t i = firstSphere; i < scene.Bodies.size(); ++i)
+        {
+            const btVector3& position = scene.Bodies[i]->getWorldTransform().getOrigin();
+            const bool inside = position.x() > 0.0f && position.x() < extent && position.y() > 0.0f &&
+                                position.y() < extent && position.z() > 0.0f && position.z() < extent;
+            result.Escaped += inside ? 0 : 1;
+        }
+
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        result.MeanMs = totalMs / options.Ticks;
+        return result;
+    }
+
+    /** @brief Gets the height of the synthetic benchmark terrain, rolling hills between 4 and 36 m. */
+    float GetTerrainHeight(float x, float z)
+    {
+        return 20.0f + 10.0f * std::sin(x * 0.031f) * std::cos(z * 0.027f) + 6.0f * std::sin((x + z) * 0.013f);
+    }
+
+    /**
+     * @brief Drops spheres on a large terrain while the streaming point circles them.
+     * @param heightfield Whether the terrain is made of streamed heightfield chunks rather than static boxes.
+     */
+    TerrainResult RunTerrain(const BenchmarkOptions& options, bool heightfield)
+    {
+        StartEngine(options, 1);
+
+        constexpr float extent = static_cast<float>(kTerrainSamples - 1);
+        const glm::vec3 center(extent * 0.5f, 0.0f, extent * 0.5f);
+
+        TerrainResult result;
+        result.Mode = heightfield ? "heightfield" : "boxes";
+
+        SpawnedScene scene;
+        std::unique_ptr<Terrain> terrain;
+        if (heightfield)
+        {
+            std::vector<uint16_t> samples(static_cast<size_t>(kTerrainSamples) * kTerrainSamples);
+            for (int z = 0; z < kTerrainSamples; ++z)
+            {
+                for (int x = 0; x < kTerrainSamples; ++x)
+                {
+                    const float height = GetTerrainHeight(static_cast<float>(x), static_cast<float>(z));
+                    samples[static_cast<size_t>(z) * kTerrainSamples + x] =
+                        static_cast<uint16_t>(std::lround(height / kTerrainHeightScale * 65535.0f));
+                }
+            }
+
+            TerrainConfig config;
+            config.HeightScale = kTerrainHeightScale;
+            config.StreamRadius = kTerrainStreamRadius;
+            terrain = std::make_unique<Terrain>(std::move(samples), kTerrainSamples, kTerrainSamples, config,
+                                                glm::vec3(0.0f));
+
+            // Fill the streaming radius before the spheres land
+            int loaded = -1;
+            while (loaded != terrain->GetStats().LoadedChunks)
+            {
+                loaded = terrain->GetStats().LoadedChunks;
+                terrain->Stream(center + glm::vec3(kTerrainOrbitRadius, 0.0f, 0.0f));
+            }
+        }
+        else
+        {
+            // One static box per cell, as tall as the terrain at the cell centre
+            RigidBodyConfig boxConfig;
+            boxConfig.type = RigidBodyType::Static;
+            boxConfig.shapeConfig.type = CollisionShapeType::BOX;
+
+            PhysicsEngine::BatchScope batch;
+            const int cells = static_cast<int>(extent / kTerrainBoxCell);
+            for (int z = 0; z < cells; ++z)
+            {
+                for (int x = 0; x < cells; ++x)
+                {
+                    const float cx = (x + 0.5f) * kTerrainBoxCell;
+                    const float cz = (z + 0.5f) * kTerrainBoxCell;
+                    const float height = GetTerrainHeight(cx, cz);
+                    boxConfig.shapeConfig.size = glm::vec3(kTerrainBoxCell, height, kTerrainBoxCell);
+                    SpawnBody(scene, boxConfig, btVector3(cx, height * 0.5f, cz));
+                }
+            }
+            result.StaticProxies = static_cast<int>(scene.Bodies.size());
+        }
+
+        const size_t firstSphere = scene.Bodies.size();
+        {
+            RigidBodyConfig sphereConfig;
+            sphereConfig.shapeConfig.type = CollisionShapeType::SPHERE;
+            sphereConfig.shapeConfig.radius = 0.5f;
+
+            PhysicsEngine::BatchScope batch;
+            const int side = GetGridSide(kTerrainSpheres);
+            for (int i = 0; i < kTerrainSpheres; ++i)
+            {
+                const float x = center.x + (i % side - side * 0.5f) * 2.0f;
+                const float z = center.z + (i / side - side * 0.5f) * 2.0f;
+                SpawnBody(scene, sphereConfig, btVector3(x, GetTerrainHeight(x, z) + 2.0f, z));
+            }
+        }
+
+        const float timeStep = PhysicsEngine::GetSettings().GetFixedTimeStep();
+        auto tick = [&](int index) {
+            // A camera circling the spheres drags chunks in and out behind it
+            if (terrain)
+            {
+                const float angle = index * 0.01f;
+                terrain->Stream(center + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * kTerrainOrbitRadius);
+            }
+            PhysicsEngine::BeginStep(timeStep);
+        };
+
+        for (int i = 0; i < options.WarmupTicks; ++i)
+            tick(i);
+
+        double totalMs = 0.0;
+        uint64_t chunks = 0;
+        for (int i = 0; i < options.Ticks; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            tick(options.WarmupTicks + i);
+            auto end = std::chrono::steady_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+            if (terrain)
+            {
+                const TerrainStats& stats = terrain->GetStats();
+                chunks += stats.LoadedChunks;
+                result.StaticProxies = std::max(result.StaticProxies, stats.LoadedChunks);
+                result.PeakChunkBytes = std::max<uint64_t>(result.PeakChunkBytes, stats.ChunkBytes);
+            }
+        }
+
+        // Boxes are as tall as the terrain at their centre, allow for the slope across half a cell
+        for (size_t i = firstSphere; i < scene.Bodies.size(); ++i)
+        {
+            const btVector3& position = scene.Bodies[i]->getWorldTransform().getOrigin();
+            result.FellThrough += position.y() < GetTerrainHeight(position.x(), position.z()) - 2.0f ? 1 : 0;
+        }
+
+        terrain.reset();
+        DestroyScene(scene);
+        PhysicsEngine::Destroy();
+
+        result.MeanMs = totalMs / options.Ticks;
+        result.MeanChunks = static_cast<double>(chunks) / options.Ticks;
+        return result;
+    }
+
+    std::vector<int> ParseIntList(const char* text)
+    {
+        std::vector<int> values;
+        std::string list(text);
+        size_t begin = 0;
+        while (begin <= list.size())
+        {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos)
+                end = list.size();
+            if (end > begin)
+                values.push_back(std::max(1, std::atoi(list.substr(begin, end - begin).c_str())));
+            begin = end + 1;
+        }
+        return values;
+    }
+
+    void PrintUsage()
+    {
+        std::printf("Usage: PhysicsBenchmark [options]\n"
+                    "  --scenes boxes,spheres,chains,city  Scenes to run (default: all)\n"
+                    "           projectiles,projectiles-layered\n"
+                    "  --bodies 1000,5000                  Body counts per scene\n"
+                    "  --threads 1,2,4                     Worker threads (default: powers of two up to the core count)\n"
+                    "  --type basic|discrete|parallel|continuous\n"
+                    "  --ticks N                           Measured ticks per run\n"
+                    "  --warmup N                          Ticks run before measuring\n"
+                    "  --tick-rate N                       Ticks per simulated second\n"
+                    "  --no-raycasts                       Skip the raycast benchmark\n"
+                    "  --no-streaming                      Skip the section streaming benchmark\n"
+                    "  --no-snapshot                       Skip the snapshot replay check\n"
+                    "  --no-vehicles                       Skip the vehicle benchmark\n"
+                    "  --no-characters                     Skip the character controller benchmark\n"
+                    "  --no-projectile-pool                Skip the pooled projectile benchmark\n"
+                    "  --no-ccd                            Skip the continuous collision benchmark\n"
+                    "  --no-terrain                        Skip the terrain benchmark\n"
+                    "  --output path.json                  Report path\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            auto consume = [&]() {
+                ++i;
+                return value;
+            };
+
+            if (std::strcmp(arg, "--no-raycasts") == 0)
+                options.Raycasts = false;
+            else if (std::strcmp(arg, "--no-streaming") == 0)
+                options.Streaming = false;
+            else if (std::strcmp(arg, "--no-snapshot") == 0)
+                options.Snapshot = false;
+            else if (std::strcmp(arg, "--no-vehicles") == 0)
+                options.Vehicles = false;
+            else if (std::strcmp(arg, "--no-characters") == 0)
+                options.Characters = false;
+            else if (std::strcmp(arg, "--no-projectile-pool") == 0)
+                options.ProjectilePool = false;
+            else if (std::strcmp(arg, "--no-ccd") == 0)
+                options.Ccd = false;
+            else if (std::strcmp(arg, "--no-terrain") == 0)
+                options.Terrain = false;
+            else if (!value)
+                return false;
+            else if (std::strcmp(arg, "--scenes") == 0)
+            {
+                options.Scenes.clear();
+                const std::string scenes = consume();
+                const SceneKind kinds[] = {SceneKind::Boxes,       SceneKind::Spheres, SceneKind::Chains,
+                                           SceneKind::City,        SceneKind::Projectiles,
+                                           SceneKind::LayeredProjectiles};
+
+                // Whole comma separated names, "projectiles" is a prefix of "projectiles-layered"
+                size_t begin = 0;
+                while (begin <= scenes.size())
+                {
+                    size_t end = scenes.find(',', begin);
+                    if (end == std::string::npos)
+                        end = scenes.size();
+                    const std::string name = scenes.substr(begin, end - begin);
+                    for (SceneKind kind : kinds)
+                    {
+                        if (name == GetSceneName(kind))
+                            options.Scenes.push_back(kind);
+                    }
+                    begin = end + 1;
+                }
+            }
+            else if (std::strcmp(arg, "--bodies") == 0)
+                options.BodyCounts = ParseIntList(consume());
+            else if (std::strcmp(arg, "--threads") == 0)
+                options.Threads = ParseIntList(consume());
+            else if (std::strcmp(arg, "--type") == 0)
+            {
+                const std::string type = consume();
+                const PhysicsType types[] = {PhysicsType::BASIC, PhysicsType::DISCRETE, PhysicsType::PARALLEL,
+                                             PhysicsType::CONTINUOUS};
+                for (PhysicsType candidate : types)
+                {
+                    if (type == GetWorldTypeName(candidate))
+                        options.Type = candidate;
+                }
+            }
+            else if (std::strcmp(arg, "--ticks") == 0)
+                options.Ticks = std::max(1, std::atoi(consume()));
+            else if (std::strcmp(arg, "--warmup") == 0)
+                options.WarmupTicks = std::max(0, std::atoi(consume()));
+            else if (std::strcmp(arg, "--tick-rate") == 0)
+                options.TickRate = std::max(1, std::atoi(consume()));
+            else if (std::strcmp(arg, "--output") == 0)
+                options.Output = consume();
+            else
+                return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    Log::Init();
+    // Keep per-step engine logging out of the measurements
+    Log::GetCoreLogger()->set_level(spdlog::level::warn);
+
+    // Only the parallel world uses worker threads, the others run once
+    if (options.Type != PhysicsType::PARALLEL)
+        options.Threads = {1};
+    else if (options.Threads.empty())
+    {
+        const int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+            options.Threads.push_back(threads);
+    }
+
+    BenchmarkReport report;
+
+    std::printf("%20s %8s %8s %9s %9s %9s %9s %10s %10s %10s\n", "scene", "bodies", "threads", "mean ms", "p50 ms",
+                "p99 ms", "max ms", "pairs", "narrow us", "peak KB");
+
+    for (SceneKind scene : options.Scenes)
+    {
+        for (int bodyCount : options.BodyCounts)
+        {
+            for (int threads : options.Threads)
+            {
+                SceneResult result = RunScene(options, scene, bodyCount, threads);
+                std::printf("%20s %8d %8d %9.3f %9.3f %9.3f %9.3f %10.0f %10.1f %10llu\n", result.Scene.c_str(),
+                            result.Bodies, result.Threads, result.MeanMs, result.P50Ms, result.P99Ms, result.MaxMs,
+                            result.MeanPairs, result.MeanNarrowphaseUs,
+                            static_cast<unsigned long long>(result.PeakBytes / 1024));
+                report.Scenes.push_back(std::move(result));
+            }
+        }
+    }
+
+    if (options.Raycasts)
+    {
+        std::printf("\n%8s %8s %12s\n", "rays", "threads", "ms/batch");
+
+        for (int threads : options.Threads)
+        {
+            RaycastResult result = RunRaycasts(options, threads);
+            std::printf("%8d %8d %12.3f\n", result.Rays, result.Threads, result.MsPerBatch);
+            report.Raycasts.push_back(result);
+        }
+    }
+
+    if (options.Streaming)
+    {
+        std::printf("\n%8s %8s %8s %10s %12s %10s\n", "bodies", "threads", "batched", "load ms", "1st step ms",
+                    "unload ms");
+
+        for (int threads : options.Threads)
+        {
+            for (bool batched : {false, true})
+            {
+                StreamingResult result = RunStreaming(options, threads, batched);
+                std::printf("%8d %8d %8s %10.3f %12.3f %10.3f\n", result.Bodies, result.Threads,
+                            result.Batched ? "yes" : "no", result.LoadMs, result.FirstStepMs, result.UnloadMs);
+                report.Streaming.push_back(result);
+            }
+        }
+    }
+
+    if (options.Vehicles)
+    {
+        std::printf("\n%8s %8s %10s %10s\n", "vehicles", "batched", "mean ms", "contacts");
+
+        for (bool batched : {false, true})
+        {
+            VehicleResult result = RunVehicles(options, batched);
+            std::printf("%8d %8s %10.3f %10.1f\n", result.Vehicles, result.Batched ? "yes" : "no", result.MeanMs,
+                        result.MeanWheelsInContact);
+            report.Vehicles.push_back(result);
+        }
+    }
+
+    if (options.Characters)
+    {
+        std::printf("\n%10s %8s %10s %11s %8s %13s %9s\n", "characters", "threads", "mean ms", "candidates",
+                    "sweeps", "contact tests", "grounded");
+
+        // Characters are stepped on the physics thread in one pass, worker threads only help the rest of the step
+        for (int threads : options.Threads)
+        {
+            CharacterResult result = RunCharacters(options, threads);
+            std::printf("%10d %8d %10.3f %11.1f %8.2f %13.2f %8.0f%%\n", result.Characters, result.Threads,
+                        result.MeanMs, result.CandidatesPerCharacter, result.SweepsPerCharacter,
+                        result.ContactTestsPerCharacter, result.GroundedRatio * 100.0);
+            report.Characters.push_back(result);
+        }
+    }
+
+    if (options.ProjectilePool)
+    {
+        std::printf("\n%8s %8s %10s %8s %10s %8s\n", "capacity", "threads", "mean ms", "live", "hits/tick",
+                    "buffers");
+
+        for (int threads : options.Threads)
+        {
+            ProjectilePoolResult result = RunProjectilePool(options, threads);
+            std::printf("%8d %8d %10.3f %8.0f %10.1f %8s\n", result.Capacity, result.Threads, result.MeanMs,
+                        result.MeanLive, result.HitsPerTick, result.BuffersGrew ? "GREW" : "fixed");
+            report.ProjectilePool.push_back(result);
+        }
+    }
+
+    if (options.Ccd)
+    {
+        std::printf("\n%8s %8s %8s %10s %8s\n", "ccd", "bodies", "fast", "mean ms", "escaped");
+
+        // Neither world type uses worker threads, so every mode runs on one
+        for (CcdMode mode : {CcdMode::Discrete, CcdMode::Always, CcdMode::Adaptive})
+        {
+            CcdResult result = RunCcd(options, mode);
+            std::printf("%8s %8d %8d %10.3f %8d\n", result.Mode.c_str(), result.Bodies, result.FastBodies,
+                        result.MeanMs, result.Escaped);
+            report.Ccd.push_back(result);
+        }
+    }
+
+    if (options.Terrain)
+    {
+        std::printf("\n%12s %8s %10s %8s %10s %8s\n", "terrain", "proxies", "mean ms", "chunks", "chunk KB",
+                    "fell");
+
+        // Both run on one thread, the difference is in the broadphase and the static proxies held
+        for (bool heightfield : {false, true})
+        {
+            TerrainResult result = RunTerrain(options, heightfield);
+            std::printf("%12s %8d %10.3f %8.1f %10llu %8d\n", result.Mode.c_str(), result.StaticProxies,
+                        result.MeanMs, result.MeanChunks, static_cast<unsigned long long>(result.PeakChunkBytes / 1024),
+                        result.FellThrough);
+            report.Terrain.push_back(result);
+        }
+    }
+
+    bool replayMatched = true;
+    if (options.Snapshot)
+    {
+        SnapshotResult result = RunSnapshotCheck(options);
+        std::printf("\n%8s %8s %12s %12s %10s %10s\n", "bodies", "ticks", "snapshot us", "restore us", "bytes",
+                    "replay");
+        std::printf("%8d %8d %12.1f %12.1f %10llu %10s\n", result.Bodies, result.Ticks, result.SnapshotUs,
+                    result.RestoreUs, static_cast<unsigned long long>(result.Bytes),
+                    result.Identical ? "identical" : "DIVERGED");
+        if (!result.Identical)
+            std::printf("%d bodies and %d of %d contact events differ after replaying the snapshot\n",
+                        result.MismatchedBodies, result.MismatchedEvents, result.Events);
+
+        replayMatched = result.Identical;
+        report.Snapshots.push_back(result);
+    }
+
+    std::ofstream file(options.Output);
+    if (!file)
+    {
+        std::fprintf(stderr, "Could not open %s for writing\n", options.Output.c_str());
+        return 1;
+    }
+
+    {
+        cereal::JSONOutputArchive archive(file);
+        archive(cereal::make_nvp("PhysicsBenchmark", report));
+    }
+
+    std::printf("\nReport written to %s\n", options.Output.c_str());
+
+    // A diverged replay fails the run so scripts can use the benchmark as a determinism check
+    return replayMatched ? 0 : 2;
+}